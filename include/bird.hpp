@@ -3,45 +3,54 @@
 ///
 /// @details    This file contains the definition of the Bird class, the Boid class and the Predator class; the last two
 /// publicly inherit from Bird. A Bird object represents a bird flying in a two-dimensional space. Each bird is
-/// characterized by two point::Point objects, representing its position and its velocity.
+/// characterized by two point::BasicPoint<T> objects, representing its position and its velocity.
+/// The three classes are the double precision instances of the BasicBird, BasicBoid and BasicPredator class
+/// templates, which are also instantiated for float, see point::BasicPoint.
+/// There are no virtual functions: a bird is just its position and velocity, 32 bytes in double precision, and can be
+/// copied as plain memory.
 #ifndef BIRD_HPP
 #define BIRD_HPP
 
+#include <cassert>
 #include <memory>
 #include <vector>
 
 #include "../include/point.hpp"
+#include "../include/storage.hpp"
 
 namespace bird {
 
-/// @brief The Bird class represents a bird in the simulation.
-class Bird {
+/// @brief The BasicBird class template represents a bird in the simulation.
+/// @details The coefficients and distances are given in double precision and converted to T.
+/// @tparam T Is the type of the components of the position and velocity.
+template <typename T>
+class BasicBird {
  protected:
-  point::Point position_;
-  point::Point velocity_;
+  point::BasicPoint<T> position_;
+  point::BasicPoint<T> velocity_;
 
  public:
   /// @brief Default constructor of Bird class.
-  Bird() = default;
+  BasicBird() = default;
 
   /// @brief Parametric constructor of Bird class.
-  /// @details Initializes the position and the velocity of the bird with given point::Point objects.
+  /// @details Initializes the position and the velocity of the bird with given point::BasicPoint<T> objects.
   /// @param position Is the position of the bird.
   /// @param velocity Is the velocity of the bird.
-  Bird(point::Point const &position, point::Point const &velocity);
+  BasicBird(point::BasicPoint<T> const &position, point::BasicPoint<T> const &velocity);
 
   /// @brief Gets the position of the bird.
   /// @return The position of the bird.
-  [[nodiscard]] point::Point getPosition() const;
+  [[nodiscard]] point::BasicPoint<T> getPosition() const;
 
   /// @brief Gets the velocity of the bird.
   /// @return The velocity of the bird.
-  [[nodiscard]] point::Point getVelocity() const;
+  [[nodiscard]] point::BasicPoint<T> getVelocity() const;
 
   /// @brief Sets the position and the velocity of the bird.
   /// @param position Is the position of the bird.
   /// @param velocity Is the velocity of the bird.
-  void setBird(point::Point position, point::Point velocity);
+  void setBird(point::BasicPoint<T> position, point::BasicPoint<T> velocity);
 
   /// @brief Updates the velocity of the bird in order to keep it into the border.
   /// @details Whenever the bird is inside the margin, his velocity is corrected in order to bring it away from
@@ -49,7 +58,17 @@ class Bird {
   /// @param margin Identifies the region the rule is applied in.
   /// @param turn_factor Identifies the increment applied to the components of the velocity.
   /// @return The velocity of the bird with the needed correction.
-  [[nodiscard]] point::Point border(double margin, double turn_factor) const;
+  [[nodiscard]] point::BasicPoint<T> border(double margin, double turn_factor) const;
+
+  /// @brief Updates the velocity of the bird in order to keep it into a world of the given size.
+  /// @details Same rule as the overload above, for a world spanning [graphic_par::stats_width, width] x [0, height]
+  /// instead of the window.
+  /// @param margin Identifies the region the rule is applied in.
+  /// @param turn_factor Identifies the increment applied to the components of the velocity.
+  /// @param width Is the right edge of the world.
+  /// @param height Is the bottom edge of the world.
+  /// @return The velocity of the bird with the needed correction.
+  [[nodiscard]] point::BasicPoint<T> border(double margin, double turn_factor, double width, double height) const;
 
   /// @brief Evaluates the correction to the velocity of the bird, in order to keep it separated from other birds.
   /// @details Whenever a bird sees other birds near it, an additional component of velocity is evaluated in order to
@@ -59,41 +78,64 @@ class Bird {
   /// @param ds Identifies the region where it is possible to find neighbours.
   /// @param near Identifies the bird's neighbours.
   /// @return The correction to the velocity.
-  [[nodiscard]] point::Point separation(double s, double ds, const std::vector<std::shared_ptr<Bird>> &near) const;
-
-  /// @brief Pure virtual function to apply friction to a bird's velocity.
-  virtual void friction(double, point::Point &) = 0;
+  [[nodiscard]] point::BasicPoint<T> separation(double s, double ds,
+                                                const std::vector<std::shared_ptr<BasicBird<T>>> &near) const;
 
-  /// @brief Pure virtual function to apply a boost to a bird's velocity.
-  virtual void boost(double, point::Point &) = 0;
+  /// @brief Evaluates the correction to the velocity of the bird, in order to keep it separated from other birds.
+  /// @details Same as the overload above, with the neighbours given as indices into a storage::BasicBirdArrays object.
+  /// @param s Factor which modules the correction.
+  /// @param ds Identifies the region where it is possible to find neighbours.
+  /// @param near Are the indices of the bird's neighbours.
+  /// @param birds Is the storage the indices refer to.
+  /// @return The correction to the velocity.
+  [[nodiscard]] point::BasicPoint<T> separation(double s, double ds, const std::vector<size_t> &near,
+                                                const storage::BasicBirdArrays<T> &birds) const;
+
+  /// @brief Updates a velocity by imposing a maximum speed.
+  /// @details If the speed exceeds the maximum allowed, its module is normalized, leaving the direction unchanged.
+  /// Boids and predators only differ in the maximum, Parameters::b_max_speed or Parameters::p_max_speed, so the rule
+  /// is shared and resolved at compile time.
+  /// @param max_speed Is the maximum speed of the bird.
+  /// @param velocity Is the velocity to update.
+  static void friction(double max_speed, point::BasicPoint<T> &velocity);
 
-  ///@brief Virtual destructor.
-  virtual ~Bird() = default;
+  /// @brief Updates a velocity by imposing a minimum speed.
+  /// @details If the speed is below the minimum allowed, its module is normalized, leaving the direction unchanged.
+  /// @param min_speed Is the minimum speed of the bird.
+  /// @param velocity Is the velocity to update.
+  static void boost(double min_speed, point::BasicPoint<T> &velocity);
 };
 
-class Boid final : public Bird {
+// the speed limits are applied to every bird at every step: they are defined here to be inlined
+template <typename T>
+void BasicBird<T>::friction(const double max_speed, point::BasicPoint<T> &velocity) {
+  assert(max_speed > 0);
+  assert(velocity.module() != 0);
+  if (velocity.module() > max_speed) {
+    velocity = max_speed * (velocity / velocity.module());
+  }
+}
+
+template <typename T>
+void BasicBird<T>::boost(const double min_speed, point::BasicPoint<T> &velocity) {
+  assert(min_speed > 0);
+  assert(velocity.module() != 0);
+  if (velocity.module() < min_speed) {
+    velocity = min_speed * (velocity / velocity.module());
+  }
+}
+
+/// @brief The BasicBoid class template represents a boid, see BasicBird.
+template <typename T>
+class BasicBoid final : public BasicBird<T> {
  public:
   ///@brief Default constructor.
-  Boid();
+  BasicBoid();
 
   /// @brief Constructs a new Boid object, with given position and velocity.
   /// @param pos Is the position of the boid.
   /// @param vel Is the velocity of the boid.
-  Boid(point::Point const &pos, point::Point const &vel);
-
-  /// @brief Updates the speed of the Boid object by imposing a maximum speed.
-  /// @details If the speed of the boid exceeds the maximum allowed, its module is normalized, leaving the
-  /// direction unchanged.
-  /// @param b_max_speed Is the maximum speed for the boids.
-  /// @param velocity Is the velocity to update.
-  void friction(double b_max_speed, point::Point &velocity) override;
-
-  /// @brief Updates the speed of the Boid object by imposing a minimum speed.
-  /// @details If the speed of the Boid object exceeds the minimum allowed, its module would be normalized, leaving the
-  /// direction unchanged.
-  /// @param b_min_speed Is the minimum speed for Boid objects.
-  /// @param velocity Is the velocity to update.
-  void boost(double b_min_speed, point::Point &velocity) override;
+  BasicBoid(point::BasicPoint<T> const &pos, point::BasicPoint<T> const &vel);
 
   /// @brief Evaluate the correction to the velocity of the Boid object, in order to keep it aligned with the
   /// neighbours.
@@ -103,7 +145,18 @@ class Boid final : public Bird {
   /// @param a Factor which modules the correction.
   /// @param near_boids Identifies the boid's neighbours.
   /// @return The correction to the velocity.
-  [[nodiscard]] point::Point alignment(double a, const std::vector<std::shared_ptr<Bird>> &near_boids) const;
+  [[nodiscard]] point::BasicPoint<T> alignment(double a,
+                                               const std::vector<std::shared_ptr<BasicBird<T>>> &near_boids) const;
+
+  /// @brief Evaluate the correction to the velocity of the Boid object, in order to keep it aligned with the
+  /// neighbours.
+  /// @details Same as the overload above, with the neighbours given as indices into a storage::BasicBirdArrays object.
+  /// @param a Factor which modules the correction.
+  /// @param near_boids Are the indices of the boid's neighbours.
+  /// @param boids Is the storage the indices refer to.
+  /// @return The correction to the velocity.
+  [[nodiscard]] point::BasicPoint<T> alignment(double a, const std::vector<size_t> &near_boids,
+                                               const storage::BasicBirdArrays<T> &boids) const;
 
   /// @brief Evaluate the correction to the velocity of the Boid object, in order to keep a more cohesive unit of Boid
   /// objects.
@@ -113,7 +166,18 @@ class Boid final : public Bird {
   /// @param c Factor which modules the correction.
   /// @param near_boids Identifies the boids neighbours.
   /// @return  The correction to the velocity.
-  [[nodiscard]] point::Point cohesion(double c, const std::vector<std::shared_ptr<Bird>> &near_boids) const;
+  [[nodiscard]] point::BasicPoint<T> cohesion(double c,
+                                              const std::vector<std::shared_ptr<BasicBird<T>>> &near_boids) const;
+
+  /// @brief Evaluate the correction to the velocity of the Boid object, in order to keep a more cohesive unit of Boid
+  /// objects.
+  /// @details Same as the overload above, with the neighbours given as indices into a storage::BasicBirdArrays object.
+  /// @param c Factor which modules the correction.
+  /// @param near_boids Are the indices of the boid's neighbours.
+  /// @param boids Is the storage the indices refer to.
+  /// @return  The correction to the velocity.
+  [[nodiscard]] point::BasicPoint<T> cohesion(double c, const std::vector<size_t> &near_boids,
+                                              const storage::BasicBirdArrays<T> &boids) const;
 
   /// @brief Evaluate the correction to the velocity of the Boid object, in order to keep it separated from Predator
   /// objects.
@@ -123,32 +187,31 @@ class Boid final : public Bird {
   /// @param r Factor which modules the repulsion.
   /// @param near_predators Identifies predators near the boid.
   /// @return The correction to the velocity.
-  [[nodiscard]] point::Point repel(double r, const std::vector<std::shared_ptr<Bird>> &near_predators) const;
+  [[nodiscard]] point::BasicPoint<T> repel(double r,
+                                           const std::vector<std::shared_ptr<BasicBird<T>>> &near_predators) const;
+
+  /// @brief Evaluate the correction to the velocity of the Boid object, in order to keep it separated from Predator
+  /// objects.
+  /// @details Same as the overload above, with the predators given as indices into a storage::BasicBirdArrays object.
+  /// @param r Factor which modules the repulsion.
+  /// @param near_predators Are the indices of the predators near the boid.
+  /// @param predators Is the storage the indices refer to.
+  /// @return The correction to the velocity.
+  [[nodiscard]] point::BasicPoint<T> repel(double r, const std::vector<size_t> &near_predators,
+                                           const storage::BasicBirdArrays<T> &predators) const;
 };
 
-class Predator final : public Bird {
+/// @brief The BasicPredator class template represents a predator, see BasicBird.
+template <typename T>
+class BasicPredator final : public BasicBird<T> {
  public:
   ///@brief Default constructor.
-  Predator();
+  BasicPredator();
 
   /// @brief Construct a new Predator object, with given position and velocity.
   /// @param pos Is the position of the Predator object.
   /// @param vel Is the velocity of the Predator object.
-  Predator(point::Point const &pos, point::Point const &vel);
-
-  /// @brief Updates the speed of the Predator object by imposing a maximum speed.
-  /// @details If the speed of the predator exceeds the maximum allowed, its module is normalized, leaving the
-  /// direction unchanged.
-  /// @param p_max_speed Is the maximum speed for Predator objects.
-  /// @param velocity Is the velocity to update.
-  void friction(double p_max_speed, point::Point &velocity) override;
-
-  /// @brief Updates the speed of the Predator object by imposing a minimum speed.
-  /// @details If the speed of the predator exceeds the minimum allowed, its module would be normalized, leaving
-  /// the direction unchanged.
-  /// @param p_min_speed Is the minimum speed for Predator objects.
-  /// @param velocity Is the velocity to update.
-  void boost(double p_min_speed, point::Point &velocity) override;
+  BasicPredator(point::BasicPoint<T> const &pos, point::BasicPoint<T> const &vel);
 
   /// @brief Evaluate the correction to the velocity of the Predator object, in order to chase the near Boid objects.
   /// @details Whenever a predator sees boids near it, an additional component of velocity is evaluated so
@@ -157,7 +220,26 @@ class Predator final : public Bird {
   /// @param ch Factor which modules the correction.
   /// @param near_boids Identifies the boids near the predator.
   /// @return The correction to the velocity.
-  [[nodiscard]] point::Point chase(double ch, const std::vector<std::shared_ptr<Bird>> &near_boids) const;
+  [[nodiscard]] point::BasicPoint<T> chase(double ch,
+                                           const std::vector<std::shared_ptr<BasicBird<T>>> &near_boids) const;
+
+  /// @brief Evaluate the correction to the velocity of the Predator object, in order to chase the near Boid objects.
+  /// @details Same as the overload above, with the boids given as indices into a storage::BasicBirdArrays object.
+  /// @param ch Factor which modules the correction.
+  /// @param near_boids Are the indices of the boids near the predator.
+  /// @param boids Is the storage the indices refer to.
+  /// @return The correction to the velocity.
+  [[nodiscard]] point::BasicPoint<T> chase(double ch, const std::vector<size_t> &near_boids,
+                                           const storage::BasicBirdArrays<T> &boids) const;
 };
+
+/// @brief The Bird class represents a bird in the simulation, in double precision.
+using Bird = BasicBird<double>;
+
+/// @brief The Boid class represents a boid, in double precision.
+using Boid = BasicBoid<double>;
+
+/// @brief The Predator class represents a predator, in double precision.
+using Predator = BasicPredator<double>;
 }  // namespace bird
 #endif
\ No newline at end of file
@@ -0,0 +1,72 @@
+/// @file       ../include/buffer.hpp
+/// @brief      Defines the TripleBuffer class template.
+///
+/// @details    This file contains the definition of the TripleBuffer class template.
+///             A TripleBuffer hands values from one producer thread to one consumer thread without locks: the
+///             producer always has a slot to write to, and the consumer always reads the latest complete value.
+#ifndef BUFFER_HPP
+#define BUFFER_HPP
+
+#include <array>
+#include <atomic>
+
+namespace buffer {
+
+/// @brief The TripleBuffer class template passes values of type T from a single producer to a single consumer.
+/// @details Of the three slots, one is owned by the producer, one by the consumer and one, the middle one, is
+/// exchanged atomically between them: publish() swaps the producer's slot with the middle one, update() swaps the
+/// consumer's slot with the middle one if it holds a value that has not been read yet. Neither side ever waits for the
+/// other; values published while the consumer is busy are overwritten by newer ones.
+template <typename T>
+class TripleBuffer {
+ private:
+  /// @brief Is set in middle_ when the middle slot holds a value the consumer has not taken yet.
+  static constexpr unsigned fresh_ = 4;
+
+  std::array<T, 3> slots_;
+
+  /// @brief Is the index of the middle slot, with fresh_ set if it holds a value not taken yet.
+  std::atomic<unsigned> middle_;
+
+  /// @brief Is the index of the slot of the producer, only accessed by the producer.
+  unsigned back_;
+
+  /// @brief Is the index of the slot of the consumer, only accessed by the consumer.
+  unsigned front_;
+
+ public:
+  /// @brief Constructs a TripleBuffer object, with default-constructed slots and no published value.
+  TripleBuffer() : slots_{}, middle_{1}, back_{0}, front_{2} {}
+
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  /// @brief Gets the slot the producer writes the next value to.
+  /// @details Called by the producer only. The slot holds a value published some time ago, which can be overwritten
+  /// in place to reuse its storage.
+  /// @return The slot of the producer.
+  T& back() { return slots_[back_]; }
+
+  /// @brief Publishes the value written to back(), which becomes the latest value.
+  /// @details Called by the producer only; back() then refers to another slot.
+  void publish() { back_ = middle_.exchange(back_ | fresh_, std::memory_order_acq_rel) & ~fresh_; }
+
+  /// @brief Takes the latest published value, if it has not been taken yet.
+  /// @details Called by the consumer only.
+  /// @return true if front() now refers to a value that was not taken before.
+  bool update() {
+    if ((middle_.load(std::memory_order_relaxed) & fresh_) == 0) {
+      return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & ~fresh_;
+    return true;
+  }
+
+  /// @brief Gets the value taken by the last call to update().
+  /// @details Called by the consumer only. The value stays valid and unchanged until the next call to update().
+  /// @return The slot of the consumer.
+  const T& front() const { return slots_[front_]; }
+};
+}  // namespace buffer
+
+#endif
@@ -0,0 +1,120 @@
+/// @file       ../include/config.hpp
+/// @brief      Defines the Config struct and the functions filling it.
+///
+/// @details    This file contains the definition of the Config struct, which collects the settings of a run, and of
+///             the functions reading them from the command line and from key=value files.
+///             Every setting has a key, e.g. boids or margin, given either as "--key value" on the command line or as
+///             a "key = value" line of a file loaded by "--config FILE"; later settings override earlier ones.
+#ifndef CONFIG_HPP
+#define CONFIG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include "../include/flock.hpp"
+#include "../include/statistics.hpp"
+
+namespace config {
+
+/// @brief The Config struct collects the settings of a run.
+/// @details The settings left empty are asked for interactively by the programs that can, or take their defaults.
+struct Config {
+  ///@brief Are the numbers of bird::Boid and bird::Predator objects.
+  std::optional<size_t> n_boids;
+  std::optional<size_t> n_predators;
+
+  ///@brief Are the separation, alignment and cohesion coefficients; if one is set, the others take their defaults.
+  std::optional<double> s;
+  std::optional<double> a;
+  std::optional<double> c;
+
+  ///@brief Are the constants of the rules, and the size of the window.
+  flock::Parameters parameters;
+
+  ///@brief Is the seed of the generated birds; empty for a seed taken from the clock.
+  std::optional<std::uint64_t> seed;
+
+  flock::Distribution distribution;
+
+  ///@brief Is the field-of-view test of the neighbour queries, see flock::Flock::setFieldOfView().
+  flock::FieldOfView field_of_view;
+
+  ///@brief Is the number of threads of the simulation.
+  size_t threads;
+
+  ///@brief Is the skin of the candidate lists of the neighbour queries, 0 for none, see flock::Flock::setSkin().
+  double skin;
+
+  ///@brief Is the number of steps between two sorts of the birds along the Z curve, 0 for none, see
+  /// flock::Flock::setReorder().
+  size_t reorder_every;
+
+  ///@brief Is the number of steps per second of the interactive simulation, 0 for as many as possible.
+  double steps_per_second;
+
+  ///@brief States whether the birds should be drawn on the GPU, if it can.
+  bool prefer_gpu;
+
+  ///@brief Is the mode of the statistics; empty to choose it from the number of boids.
+  std::optional<statistics::Mode> stats_mode;
+
+  ///@brief Constructs a Config object with every number unset and the defaults of the other settings.
+  Config();
+
+  ///@brief States whether any of s, a and c is set.
+  [[nodiscard]] bool hasFlightParams() const;
+};
+
+/// @brief Parses a non-negative integer.
+/// @details Throws std::domain_error, naming the key, if the value is not a whole integer in the range of size_t,
+/// a leading minus sign included.
+/// @param key Is the name of the setting or option, for the error message.
+/// @param value Is the text to parse.
+/// @return The parsed integer.
+size_t toSize(const std::string& key, const std::string& value);
+
+/// @brief Parses a finite number.
+/// @details Throws std::domain_error, naming the key, if the value is not a whole number or is not finite.
+/// @param key Is the name of the setting or option, for the error message.
+/// @param value Is the text to parse.
+/// @return The parsed number.
+double toDouble(const std::string& key, const std::string& value);
+
+/// @brief Applies a setting.
+/// @details Throws std::domain_error if the key is unknown or the value is not valid for it. Angles are in degrees.
+/// Dashes and underscores are interchangeable in keys.
+/// @param config Is the configuration to change.
+/// @param name Is the key of the setting, e.g. "boids" or "boid_sight_angle".
+/// @param value Is the value of the setting, as text.
+void set(Config& config, const std::string& name, const std::string& value);
+
+/// @brief Applies the settings of a stream of "key = value" lines.
+/// @details Empty lines and text following '#' are ignored. Throws std::domain_error, naming the line, if a line is
+/// not a valid setting.
+/// @param config Is the configuration to change.
+/// @param in Is the stream to read.
+void load(Config& config, std::istream& in);
+
+/// @brief Applies the settings of a file of "key = value" lines, see load(Config&, std::istream&).
+/// @details Throws std::runtime_error if the file cannot be opened.
+/// @param config Is the configuration to change.
+/// @param path Is the path of the file.
+void loadFile(Config& config, const std::string& path);
+
+/// @brief Applies the settings of a command line, in order: "--config FILE" loads a file, "--key value" applies a
+/// setting.
+/// @details Throws std::domain_error if an argument is not a setting or lacks its value.
+/// @param config Is the configuration to change.
+/// @param argc Is the number of arguments, the program name included.
+/// @param argv Are the arguments, the program name included.
+void parseArguments(Config& config, int argc, const char* const argv[]);
+
+/// @brief Writes the keys of the settings, with their meaning and defaults.
+/// @param out Is the stream to write to.
+void printKeys(std::ostream& out);
+}  // namespace config
+
+#endif
@@ -10,25 +10,168 @@
 
 #include <SFML/Graphics/VertexArray.hpp>
 #include <cmath>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "../include/bird.hpp"
+#include "../include/grid.hpp"
+#include "../include/pool.hpp"
+#include "../include/profiler.hpp"
 #include "../include/statistics.hpp"
+#include "../include/storage.hpp"
 
 namespace flock {
 
-/// @brief The Flock class represents a group of birds, composed of bird::Boid objects and bird::Predator objects.
-class Flock {
+/// @brief Identifies the test deciding whether a bird lies inside the field of view of another one.
+enum class FieldOfView {
+  ///@brief Compares the angles of the velocity and of the offset from the other bird to this one, evaluated with
+  /// atan2: the test of the first versions, whose field of view lies mostly behind the bird.
+  Angle,
+
+  ///@brief Checks that the offset towards the other bird lies inside the cone around the velocity, with dot
+  /// products and squared distances only: the field of view lies ahead of the bird.
+  Cone
+};
+
+/// @brief Identifies how the rules of a bird are evaluated from its neighbours.
+enum class Kernel {
+  ///@brief Collects the indices of the neighbours first, then every rule of bird::BasicBoid and bird::BasicPredator
+  /// walks them again.
+  Composed,
+
+  ///@brief Accumulates the sums of all the rules during the neighbour queries themselves, in one pass over the
+  /// candidates of the spatial index and without any list of neighbours.
+  Fused
+};
+
+/// @brief Identifies how generateBirds() places the birds in the area right of the statistics panel.
+enum class Distribution {
+  ///@brief Uniformly over the area.
+  Uniform,
+
+  ///@brief In a few tight gaussian clusters, whose centres are drawn from the seed.
+  Clustered,
+
+  ///@brief Uniformly over a ring around the centre of the area.
+  Ring,
+
+  ///@brief In one wide gaussian blob at the centre of the area.
+  Gaussian
+};
+
+/// @brief Identifies what happens to the birds at the edges of the world.
+enum class Boundary {
+  ///@brief The border rule turns the birds back within Parameters::margin of the edges.
+  Walls,
+
+  ///@brief The world is a torus: a bird leaving it through an edge comes back through the opposite one, and the
+  /// offsets and distances between birds are those between their closest images.
+  Torus
+};
+
+/// @brief The Parameters struct collects the constants of the rules of a Flock, see Flock::setParameters().
+struct Parameters {
+  ///@brief Is the radius of the circle where the nearby bird::Boid objects and bird::Predator objects can be located.
+  double d;
+
+  ///@brief Is the radius of the circle where the separation rule for bird::Boid objects is effective.
+  double b_ds;
+
+  ///@brief Is the radius of the circle where the separation rule for bird::Predator objects is effective.
+  double p_ds;
+
+  ///@brief Are the half-widths of the fields of view of bird::Boid and bird::Predator objects, in radians.
+  double b_sight_angle;
+  double p_sight_angle;
+
+  ///@brief Is the distance from the border of the world within which the border rule applies.
+  double margin;
+
+  ///@brief Is the increment that is applied to the velocity of a bird flying too close to the border of the world.
+  double turn_factor;
+
+  double b_max_speed;
+  double p_max_speed;
+  double b_min_speed;
+  double p_min_speed;
+
+  ///@brief Is the time step, the position advancing by dt times the velocity at each step.
+  double dt;
+
+  ///@brief Are the right and the bottom edge of the world, whose left edge is graphic_par::stats_width and whose top
+  /// edge is 0.
+  double width;
+  double height;
+
+  ///@brief Is the behaviour of the edges of the world; margin and turn_factor are unused by Boundary::Torus.
+  Boundary boundary;
+
+  ///@brief Constructs a Parameters object with the default values: d = 75, b_ds = 20, p_ds = 37.5, sight angles of
+  /// 2/3 pi and pi/2, margin = 100, turn_factor = 2.5, speeds in [7, 12] for bird::Boid objects and in [5, 8] for
+  /// bird::Predator objects, dt = graphic_par::dt, the size of the window and Boundary::Walls.
+  Parameters();
+};
+
+/// @brief The BasicNeighbours struct template is the scratch storage of the neighbour queries of one thread.
+/// @details The vectors are cleared and refilled by every query, so after a few steps their capacity covers the
+/// largest neighbourhood and the queries stop allocating.
+/// @tparam T Is the type of the components of the positions and velocities of the birds.
+template <typename T>
+struct BasicNeighbours {
+  ///@brief Are the indices of the near bird::Boid objects.
+  std::vector<size_t> boids;
+
+  ///@brief Are the indices of the near bird::Predator objects.
+  std::vector<size_t> predators;
+
+  ///@brief Are the closest images of the near bird::Boid objects and bird::Predator objects, used by Kernel::Composed
+  /// in a world of Boundary::Torus.
+  storage::BasicBirdArrays<T> boid_images;
+  storage::BasicBirdArrays<T> predator_images;
+};
+/// @brief The Neighbours struct is the scratch storage of the neighbour queries of one thread, in double precision.
+using Neighbours = BasicNeighbours<double>;
+
+/// @brief The BasicFlock class template represents a group of birds, composed of bird::Boid objects and
+/// bird::Predator objects.
+/// @details It is instantiated for float and double only, in flock.cpp. The constants of the rules are kept in double
+/// precision and converted to T where the birds are updated; the statistics are accumulated in double precision.
+/// @tparam T Is the type of the components of the positions and velocities of the birds.
+template <typename T>
+class BasicFlock {
  private:
   size_t n_boids_;
   size_t n_predators_;
 
-  std::vector<std::shared_ptr<bird::Boid>> b_flock_;
-  std::vector<std::shared_ptr<bird::Predator>> p_flock_;
+  /// @brief Is the state of the bird::Boid objects in the flock, which the simulation runs on.
+  storage::BasicBirdArrays<T> b_arrays_;
 
-  static constexpr double b_sight_angle_ = 2. / 3 * M_PI;
-  static constexpr double p_sight_angle_ = 0.5 * M_PI;
+  /// @brief Is the state of the bird::Predator objects in the flock, which the simulation runs on.
+  storage::BasicBirdArrays<T> p_arrays_;
+
+  /// @brief Is the object view of b_arrays_, materialized and refreshed on demand by syncViews().
+  mutable std::vector<std::shared_ptr<bird::BasicBoid<T>>> b_flock_;
+
+  /// @brief Is the object view of p_arrays_, materialized and refreshed on demand by syncViews().
+  mutable std::vector<std::shared_ptr<bird::BasicPredator<T>>> p_flock_;
+
+  /// @brief Are the constants of the rules.
+  Parameters params_;
+
+  /// @brief Are the cosines of the sight angles of params_, used by FieldOfView::Cone.
+  double b_cos_sight_;
+  double p_cos_sight_;
+
+  /// @brief Is the field-of-view test used by the neighbour queries.
+  FieldOfView fov_;
+
+  /// @brief Is the evaluation of the rules used by evolve() and updateBird().
+  Kernel kernel_;
+
+  /// @brief Is the margin the candidate lists add to Parameters::d; 0 when the neighbour queries search the grids.
+  double skin_;
 
   /// @brief Is the parameter which modules the separation of the bird::Boid and bird::Predator objects in the flock.
   double s_;
@@ -45,27 +188,198 @@ class Flock {
   /// @brief Is the parameter which modules the chase coefficient for bird::Predator objects in the flock.
   double ch_;
 
-  /// @brief Is the radius of the circle where the nearby bird::Boid objects and bird::Predator objects can be located.
-  static constexpr double d_ = 75.;
+  /// @brief Is the number of birds generated from each random stream by generateBirds().
+  static constexpr size_t generation_chunk = 4096;
+
+  /// @brief Is the number of clusters of Distribution::Clustered.
+  static constexpr size_t n_clusters = 8;
 
-  /// @brief Is the radius of the circle where the separation rule for bird::Boid objects is effective.
-  static constexpr double b_ds_ = 20.;
+  /// @brief Is the spatial index over the positions of the bird::Boid objects, with cells of side params_.d.
+  grid::Grid b_grid_;
 
-  /// @brief Is the radius of the circle where the separation rule for bird::Predator objects is effective.
-  static constexpr double p_ds_ = d_ * 0.5;
+  /// @brief Is the spatial index over the positions of the bird::Predator objects, with cells of side params_.d.
+  grid::Grid p_grid_;
 
-  /// @brief Is the increment that is applied to the velocity when a bird::Boid object or a bird::Predator object flies
-  /// too close to the border of the window.
-  static constexpr double turn_factor_ = 2.5;
+  /// @brief The CandidateList struct lists, for each bird of a kind, the birds of a kind within Parameters::d + skin_.
+  struct CandidateList {
+    ///@brief Is the start of the row of each bird in indices, followed by the end of the last row.
+    std::vector<size_t> starts;
 
-  /// @brief Is the distance from the border of the window within which the border rule applies.
-  static constexpr double margin_ = 100.;
+    ///@brief Are the listed birds, row after row.
+    std::vector<size_t> indices;
+  };
 
-  double b_max_speed_;
-  double p_max_speed_;
+  /// @brief Are the candidate lists of the bird::Boid objects, among the bird::Boid and bird::Predator objects.
+  CandidateList b_near_boids_;
+  CandidateList b_near_predators_;
 
-  double b_min_speed_;
-  double p_min_speed_;
+  /// @brief Are the candidate lists of the bird::Predator objects, among the bird::Boid and bird::Predator objects.
+  CandidateList p_near_boids_;
+  CandidateList p_near_predators_;
+
+  /// @brief Are the birds as they were when the candidate lists were last built.
+  storage::BasicBirdArrays<T> b_listed_;
+  storage::BasicBirdArrays<T> p_listed_;
+
+  /// @brief States whether the candidate lists were built with the current Parameters::d and skin_.
+  bool lists_valid_;
+
+  /// @brief Is the number of times the candidate lists were built since the last call to setSkin().
+  size_t list_builds_;
+
+  /// @brief Is the number of steps between two reorderings of the birds along the Z curve, 0 for none.
+  size_t reorder_every_;
+
+  /// @brief Is the number of steps taken since the last call to setReorder().
+  size_t steps_;
+
+  /// @brief Are the ids of the bird::Boid objects stored at each index of b_arrays_.
+  std::vector<size_t> b_ids_;
+
+  /// @brief Are the ids of the bird::Predator objects stored at each index of p_arrays_.
+  std::vector<size_t> p_ids_;
+
+  /// @brief Are the scratch storage of reorder().
+  std::vector<size_t> order_;
+  storage::BasicBirdArrays<T> reordered_;
+
+  /// @brief Are the rows of the candidate list being built, gathered by each worker of pool_.
+  std::vector<std::vector<size_t>> list_buffers_;
+
+  /// @brief Are the worker and the offset in its buffer of each row of the candidate list being built.
+  std::vector<std::array<size_t, 2>> list_rows_;
+
+  /// @brief Is the pool running the parallel loops of evolve(); when empty, evolve() runs on the calling thread.
+  std::shared_ptr<pool::ThreadPool> pool_;
+
+  /// @brief Is the profiler the phases of evolve() and statistics() are recorded in, not owned; nullptr if unset.
+  profiler::Profiler* profiler_;
+
+  /// @brief Is the scratch storage of the neighbour queries of each worker of pool_.
+  std::vector<BasicNeighbours<T>> scratch_;
+
+  /// @brief Are the updated positions and velocities of the bird::Boid objects, reused by every call to evolve().
+  std::vector<std::array<point::BasicPoint<T>, 2>> b_next_;
+
+  /// @brief Are the updated positions and velocities of the bird::Predator objects, reused by every call to evolve().
+  std::vector<std::array<point::BasicPoint<T>, 2>> p_next_;
+
+  /// @brief Executes a task over the range [0, n), on pool_ if set, serially otherwise.
+  /// @param n Is the size of the range.
+  /// @param task Is called as task(begin, end, worker) for each chunk [begin, end) of the range.
+  void parallelFor(size_t n, const std::function<void(size_t, size_t, size_t)>& task) const;
+
+  /// @brief Evaluates the new position and velocity of a bird in the flock, without touching any triangle.
+  /// @details Applies the rules listed in updateBird().
+  /// @param i Is the index of a bird::Boid object in b_arrays_ or a bird::Predator object in p_arrays_.
+  /// @param is_boid States whether the current object is a bird::Boid object or a bird::Predator object.
+  /// @param near Is the scratch storage for the neighbour queries.
+  /// @return The array containing, respectively, the updated position and velocity of the bird.
+  [[nodiscard]] std::array<point::BasicPoint<T>, 2> advanceBird(size_t i, bool is_boid,
+                                                                BasicNeighbours<T>& near) const;
+
+  /// @brief Evaluates the new position and velocity of a bird in the flock with Kernel::Fused.
+  /// @details Same rules as advanceBird(), from the sums gathered while the cells of b_grid_ and p_grid_ are visited.
+  /// @param i Is the index of a bird::Boid object in b_arrays_ or a bird::Predator object in p_arrays_.
+  /// @param is_boid States whether the current object is a bird::Boid object or a bird::Predator object.
+  /// @return The array containing, respectively, the updated position and velocity of the bird.
+  [[nodiscard]] std::array<point::BasicPoint<T>, 2> advanceBirdFused(size_t i, bool is_boid) const;
+
+  /// @brief Advances the flock by one step, without touching any triangle.
+  void step();
+
+  /// @brief Rebuilds b_grid_ and p_grid_ from the current positions of the birds, and the candidate lists if needed.
+  /// @details In a world of Boundary::Torus the birds are first wrapped into it, see wrapPositions().
+  void buildIndex();
+
+  /// @brief Moves every bird outside a world of Boundary::Torus to its image inside it.
+  void wrapPositions();
+
+  /// @brief Replaces the neighbours of a bird by their closest images, for the rules of Kernel::Composed.
+  /// @param position Is the position of the bird.
+  /// @param near Are the indices of the neighbours in birds, replaced by their indices in images.
+  /// @param birds Are the birds of the kind of the neighbours.
+  /// @param images Is filled with the positions of the closest images of the neighbours, and their velocities.
+  void gatherImages(const point::BasicPoint<T>& position, std::vector<size_t>& near,
+                    const storage::BasicBirdArrays<T>& birds, storage::BasicBirdArrays<T>& images) const;
+
+  /// @brief Brings b_flock_ and p_flock_ up to date with b_arrays_ and p_arrays_.
+  /// @details The bird objects are created the first time they are needed, then only their position and velocity are
+  /// overwritten, so the shared pointers handed out stay valid.
+  void syncViews() const;
+
+  /// @brief Numbers the birds in the order they are stored, as ids.
+  void resetIds();
+
+  /// @brief Sorts the birds of a kind along the Z curve through their positions, see morton::order().
+  /// @param birds Are the birds to sort.
+  /// @param ids Are the ids of the birds, permuted with them.
+  void reorder(storage::BasicBirdArrays<T>& birds, std::vector<size_t>& ids);
+
+  /// @brief Rebuilds the candidate lists if skin_ is positive and some bird has moved more than skin_ / 2 since they
+  /// were last built, or if they are not valid.
+  void refreshLists();
+
+  /// @brief Builds one candidate list from the grid of the listed birds, whose cells have side Parameters::d + skin_.
+  /// @param is_boid States whether the list is of the bird::Boid objects or of the bird::Predator objects.
+  /// @param of_boids States whether the listed birds are bird::Boid objects or bird::Predator objects.
+  /// @param list Is the list to build.
+  void buildList(bool is_boid, bool of_boids, CandidateList& list);
+
+  /// @brief Calls visit(j) for each bird of a kind that may be closer than Parameters::d to a bird.
+  /// @details Goes through the candidate list of the bird if skin_ is positive, through the cells of the grid around
+  /// it otherwise. The bird itself may be visited.
+  /// @param i Is the index of the bird in b_arrays_ or in p_arrays_.
+  /// @param is_boid States whether the bird is a bird::Boid object or a bird::Predator object.
+  /// @param of_boids States whether the visited birds are bird::Boid objects or bird::Predator objects.
+  /// @param visit Is a callable object invoked with the index of each candidate.
+  template <typename Visitor>
+  void forEachCandidate(size_t i, bool is_boid, bool of_boids, Visitor&& visit) const;
+
+  /// @brief The Sight struct is the field of view of the current bird, prepared once per neighbour query.
+  struct Sight {
+    FieldOfView fov;
+    T x;
+    T y;
+    T vx;
+    T vy;
+
+    /// @brief Is the radius of the neighbourhood, Parameters::d.
+    T d;
+
+    /// @brief Are the sides of the world if it is a torus, zeros otherwise, see getPeriods().
+    T period_x;
+    T period_y;
+
+    /// @brief Is the half-width of the field of view.
+    double sight_angle;
+
+    /// @brief Is the angle of the velocity as given by point::BasicPoint<T>::angle(), used by FieldOfView::Angle only.
+    double beta;
+
+    /// @brief Is the signed square of cos(sight_angle) times the squared speed, used by FieldOfView::Cone only.
+    T cos2_speed2;
+
+    /// @brief Prepares the field of view of a bird.
+    /// @param flock Is the flock, whose field-of-view test, radius and sight angles are used.
+    /// @param position Is the position of the bird.
+    /// @param velocity Is the velocity of the bird.
+    /// @param is_boid States whether the bird is a bird::Boid object or a bird::Predator object.
+    Sight(const BasicFlock& flock, const point::BasicPoint<T>& position, const point::BasicPoint<T>& velocity,
+          bool is_boid);
+
+    /// @brief Evaluates the offset towards another bird, or towards its closest image in a world of Boundary::Torus.
+    /// @param other_x Is the x component of the position of the other bird.
+    /// @param other_y Is the y component of the position of the other bird.
+    /// @return The components of the offset.
+    [[nodiscard]] std::array<T, 2> offset(T other_x, T other_y) const;
+
+    /// @brief States whether a bird is inside the field of view.
+    /// @param ox Is the x component of the offset towards the other bird, see offset().
+    /// @param oy Is the y component of the offset towards the other bird.
+    /// @return True if the other bird is closer than Parameters::d and inside the field of view.
+    [[nodiscard]] bool sees(T ox, T oy) const;
+  };
 
  public:
   /// @brief Constructs a new Flock object.
@@ -77,21 +391,19 @@ class Flock {
   /// - c_ = 0.004
   /// - r_ = 0.6
   /// - ch_ = 0.008
-  /// - b_max_speed_ = 12.
-  /// - p_max_speed_ = 8.
-  /// - b_min_speed_ = 7.
-  /// - p_min_speed_ = 5.
-  Flock(size_t nBoids, size_t nPredators);
+  /// - params_ to the default Parameters
+  BasicFlock(size_t nBoids, size_t nPredators);
 
   /// @brief Constructs a new Flock object.
-  /// @param boids Vector of std::shared_ptr<bird::Boid> objects.
-  /// @param predators Vector of std::shared_ptr<bird::Predator> objects.
+  /// @param boids Vector of std::shared_ptr<bird::BasicBoid<T>> objects.
+  /// @param predators Vector of std::shared_ptr<bird::BasicPredator<T>> objects.
   /// @param bMaxSpeed Maximum value of speed for bird::Boid objects.
   /// @param pMaxSpeed Maximum value of speed for bird::Predator objects.
   /// @param bMinSpeed Minimum value of speed for bird::Boid objects.
   /// @param pMinSpeed Minimum value of speed for bird::Predator objects.
-  /// @details Initializes b_flock_, p_flock_, b_max_speed_, p_max_speed_, b_min_speed_, p_min_speed_ with the
-  /// given parameters and sets:
+  /// @details Copies the state of the given birds into b_arrays_ and p_arrays_, keeps the given shared pointers as
+  /// b_flock_ and p_flock_, initializes the speeds of params_ with the given parameters, the other members of params_
+  /// with their defaults, and sets:
   /// - n_boids_ with the size of the parameter boids
   /// - n_predators_ with the size of the parameter predators
   /// - s_ = 0.1
@@ -99,9 +411,9 @@ class Flock {
   /// - c_ = 0.004
   /// - r_ = 0.6
   /// - ch_ = 0.008
-  Flock(const std::vector<std::shared_ptr<bird::Boid>>& boids,
-        const std::vector<std::shared_ptr<bird::Predator>>& predators, double bMaxSpeed, double pMaxSpeed,
-        double bMinSpeed, double pMinSpeed);
+  BasicFlock(const std::vector<std::shared_ptr<bird::BasicBoid<T>>>& boids,
+             const std::vector<std::shared_ptr<bird::BasicPredator<T>>>& predators, double bMaxSpeed,
+             double pMaxSpeed, double bMinSpeed, double pMinSpeed);
 
   /// @brief Gets the number of bird::Boid objects in the flock.
   /// @return The number of bird::Boid objects.
@@ -116,19 +428,31 @@ class Flock {
   [[nodiscard]] size_t getFlockSize() const;
 
   /// @brief Gets the vector of shared pointers to the bird::Boid objects in the flock.
-  /// @return The vector of std::shared_ptr<bird::Boid> objects.
-  [[nodiscard]] std::vector<std::shared_ptr<bird::Boid>> getBoidFlock() const;
+  /// @details The objects are refreshed from b_arrays_ on every call, which costs a pass over the flock: the
+  /// simulation itself only uses getBoidArrays().
+  /// @return The vector of std::shared_ptr<bird::BasicBoid<T>> objects.
+  [[nodiscard]] std::vector<std::shared_ptr<bird::BasicBoid<T>>> getBoidFlock() const;
 
   /// @brief Gets the vector of shared pointers to the bird::Predator objects in the flock.
-  /// @return The vector of std::shared_ptr<bird::Predator> objects.
-  [[nodiscard]] std::vector<std::shared_ptr<bird::Predator>> getPredatorFlock() const;
+  /// @details The objects are refreshed from p_arrays_ on every call, which costs a pass over the flock: the
+  /// simulation itself only uses getPredatorArrays().
+  /// @return The vector of std::shared_ptr<bird::BasicPredator<T>> objects.
+  [[nodiscard]] std::vector<std::shared_ptr<bird::BasicPredator<T>>> getPredatorFlock() const;
+
+  /// @brief Gets the state of the bird::Boid objects in the flock.
+  /// @return A reference to b_arrays_.
+  [[nodiscard]] const storage::BasicBirdArrays<T>& getBoidArrays() const;
+
+  /// @brief Gets the state of the bird::Predator objects in the flock.
+  /// @return A reference to p_arrays_.
+  [[nodiscard]] const storage::BasicBirdArrays<T>& getPredatorArrays() const;
 
-  /// @brief Gets the turn factor for the border rule.
-  /// @return The turn factor.
+  /// @brief Gets the default turn factor for the border rule.
+  /// @return The turn factor of the default Parameters.
   [[nodiscard]] static double getTurnFactor();
 
-  /// @brief Gets the margin for the border rule.
-  /// @return The margin.
+  /// @brief Gets the default margin for the border rule.
+  /// @return The margin of the default Parameters.
   [[nodiscard]] static double getMargin();
 
   /// @brief Returns an array containing the flight parameters of the flock.
@@ -138,39 +462,193 @@ class Flock {
   /// @return The array containing the values of the parameters s_, a_, c_, r_, ch_.
   [[nodiscard]] std::array<double, 5> getFlightParams() const;
 
-  /// @brief Returns an array containing the values of the parameters d_, b_ds_, p_ds_.
-  /// @details Returns an array containing the parameters d_, b_ds_, p_ds_ in the stated order.
+  /// @brief Returns an array containing the default values of the parameters d, b_ds, p_ds.
+  /// @details Returns an array containing the parameters d, b_ds, p_ds of the default Parameters in the stated order.
   /// The first one represents the radius of the circle within which the nearby bird::Boid objects and bird::Predator
   /// objects can be found, the second and the third one represent the radius of the circle within which the separation
   /// rule is applied, respectively for bird::Boid and bird::Predator objects.
-  /// @return The array containing the values of the parameters d_, b_ds_, p_ds_.
+  /// @return The array containing the default values of the parameters d, b_ds, p_ds.
   [[nodiscard]] static std::array<double, 3> getDistancesParams();
 
+  /// @brief Sets the constants of the rules.
+  /// @details Throws std::domain_error, leaving the flock unchanged, if a distance, the margin, the turn factor, dt or
+  /// a speed is not strictly positive, if a separation radius exceeds d, if a sight angle is not in (0, pi], if a
+  /// minimum speed exceeds the maximum one, if the world is not wider and taller than twice the margin, or, for
+  /// Boundary::Torus, than twice d, so that a bird sees at most one image of another. The spatial index is rebuilt,
+  /// since its cells have side d, and periodic for Boundary::Torus, into whose world the birds are wrapped.
+  /// @param params Are the constants.
+  void setParameters(const Parameters& params);
+
+  /// @brief Gets the constants of the rules.
+  /// @return The constants.
+  [[nodiscard]] const Parameters& getParameters() const;
+
+  /// @brief Gets the sides of the world if it is a torus.
+  /// @details They are the periods of statistics::Options for birds copied out of the flock, see statistics().
+  /// @return The width and the height of the world for Boundary::Torus, zeros for Boundary::Walls.
+  [[nodiscard]] std::array<T, 2> getPeriods() const;
+
+  /// @brief Sets the number of threads evolve() runs on.
+  /// @details With more than one thread, a persistent pool::ThreadPool is started and the updates of the birds are
+  /// split among its workers. The result is bit-identical to the serial one, since every bird is updated from the
+  /// state of the previous step only and writes its own triangle.
+  /// @param n_threads Is the number of threads; 0 and 1 both mean serial execution.
+  void setThreads(size_t n_threads);
+
+  /// @brief Gets the number of threads evolve() runs on.
+  /// @return The number of threads, 1 for serial execution.
+  [[nodiscard]] size_t getThreads() const;
+
+  /// @brief Sets the profiler the phases of evolve() and statistics() are timed into.
+  /// @param profiler Is the profiler, which must outlive its use by the flock; nullptr disables the timing.
+  void setProfiler(profiler::Profiler* profiler);
+
+  /// @brief Sets the field-of-view test used by the neighbour queries.
+  /// @details FieldOfView::Angle, the default, keeps the former test on the difference of the atan2 angles. It
+  /// measures the offset from the other bird to the current one, so that its field of view points behind the bird,
+  /// and it accepts every negative difference, so that it is not symmetric around the velocity. FieldOfView::Cone
+  /// accepts a bird when the angle between the velocity of the current bird and the offset towards the other bird is
+  /// smaller than the sight angle: the field of view points ahead, and the flock behaves differently.
+  /// @param fov Is the field-of-view test.
+  void setFieldOfView(FieldOfView fov);
+
+  /// @brief Gets the field-of-view test used by the neighbour queries.
+  /// @return The field-of-view test.
+  [[nodiscard]] FieldOfView getFieldOfView() const;
+
+  /// @brief Sets the evaluation of the rules used by evolve() and updateBird().
+  /// @details Kernel::Fused, the default, visits the neighbours of each bird once; Kernel::Composed calls the rules of
+  /// bird::BasicBoid and bird::BasicPredator one by one. The velocities agree up to the rounding of the sums, which
+  /// are taken in another order.
+  /// @param kernel Is the evaluation of the rules.
+  void setKernel(Kernel kernel);
+
+  /// @brief Gets the evaluation of the rules used by evolve() and updateBird().
+  /// @return The evaluation of the rules.
+  [[nodiscard]] Kernel getKernel() const;
+
+  /// @brief Sets the skin of the candidate lists the neighbour queries go through.
+  /// @details With a positive skin, the birds within Parameters::d + skin of each bird are listed, and the queries
+  /// only test those until some bird has moved more than skin / 2 since the lists were built: two birds cannot have
+  /// come closer than Parameters::d without being listed. The lists are then rebuilt with the spatial index. With 0,
+  /// the default, the cells of the spatial index are searched at every query. The neighbours found are the same
+  /// either way. Throws std::domain_error if the skin is negative.
+  /// @param skin Is the skin, in pixels.
+  void setSkin(double skin);
+
+  /// @brief Gets the skin of the candidate lists.
+  /// @return The skin, 0 if the candidate lists are not used.
+  [[nodiscard]] double getSkin() const;
+
+  /// @brief Gets how many times the candidate lists were built since the last call to setSkin().
+  /// @return The number of builds.
+  [[nodiscard]] size_t getListBuilds() const;
+
+  /// @brief Sets how often the birds are sorted in memory along the Z curve through their positions.
+  /// @details Birds close in the world are then mostly close in getBoidArrays() and getPredatorArrays(), so the
+  /// neighbour queries read memory that is mostly in cache. The birds are moved, each of a kind keeping its id, see
+  /// getBoidIds(): the indices of the arrays, of the triangles and of getBoidFlock() and getPredatorFlock() follow
+  /// the storage, the ids follow the birds. save() writes the birds in the order of their ids.
+  /// @param every Is the number of steps between two sorts, 0, the default, for none.
+  void setReorder(size_t every);
+
+  /// @brief Gets how often the birds are sorted in memory.
+  /// @return The number of steps between two sorts, 0 for none.
+  [[nodiscard]] size_t getReorder() const;
+
+  /// @brief Gets the ids of the bird::Boid objects.
+  /// @details The ids number the birds in the order they were generated or loaded, and are kept by each bird when the
+  /// birds are sorted in memory, see setReorder().
+  /// @return The id of the bird::Boid object at each index of getBoidArrays().
+  [[nodiscard]] const std::vector<size_t>& getBoidIds() const;
+
+  /// @brief Gets the ids of the bird::Predator objects, see getBoidIds().
+  /// @return The id of the bird::Predator object at each index of getPredatorArrays().
+  [[nodiscard]] const std::vector<size_t>& getPredatorIds() const;
+
   /// @brief Sets the flight parameters s_, a_, c_ and r_ of the flock with the values streamed from input.
   /// @param in Is the input stream.
   /// @param out Is the output stream.
   void setFlightParams(std::istream& in, std::ostream& out);
 
-  /// @brief Generates bird::Boid and bird::Predator objects to fill the flock.
-  /// @details bird::Boid and bird::Predator objects are generated with random positions and velocities, then the
-  /// b_flock_ vector and the p_flock_ vector are filled with the shared pointers to these objects.
+  /// @brief Sets the flight parameters s_, a_, c_ of the flock, and r_ = 6 s_, ch_ = 2 c_.
+  /// @param s Is the separation coefficient, in the range [0, 1].
+  /// @param a Is the alignment coefficient, in the range [0, 1].
+  /// @param c Is the cohesion coefficient, in the range [0, 1].
+  void setFlightParams(double s, double a, double c);
+
+  /// @brief Saves the state of the flock to a snapshot file.
+  /// @details Writes the number of birds, the flight parameters, the field-of-view test, the speed limits, the
+  /// boundary, the width and the height of the world and the positions and velocities of every bird in the order of
+  /// their ids, see snapshot::write(). Throws std::runtime_error if the file cannot be written.
+  /// @param path Is the path of the file.
+  void save(const std::string& path) const;
+
+  /// @brief Restores the state of the flock from a snapshot file written by save().
+  /// @details The file is mapped into memory and the arrays are copied in bulk, see snapshot::MappedSnapshot. The
+  /// boundary and the size of the world are those of the file, the other Parameters those of the flock. Throws
+  /// std::runtime_error if the file is not a valid snapshot of the current version, if its flight parameters or speed
+  /// limits are out of range (NaN included), if its world is not valid with the other Parameters of the flock, see
+  /// setParameters(), if a position or a velocity is not finite or a velocity is zero, in the precision of the flock,
+  /// or if the birds of its toroidal world lie outside of it; in all cases the flock is left unchanged.
+  /// @param path Is the path of the file.
+  void load(const std::string& path);
+
+  /// @brief Generates bird::Boid and bird::Predator objects to fill the flock, from a seed taken from the clock.
+  /// @details See generateBirds(std::uint64_t).
   void generateBirds();
 
+  /// @brief Generates bird::Boid and bird::Predator objects uniformly over the area, see
+  /// generateBirds(std::uint64_t, Distribution).
+  /// @param seed Is the seed of the draws.
+  void generateBirds(std::uint64_t seed);
+
+  /// @brief Generates bird::Boid and bird::Predator objects to fill the flock.
+  /// @details bird::Boid and bird::Predator objects are generated with random positions and velocities, which are
+  /// stored in b_arrays_ and p_arrays_. The draws are made by rng::Xoshiro256, one stream per chunk of
+  /// generation_chunk birds, and the chunks are filled in parallel: the same seed gives the same birds with any
+  /// number of threads. Positions are clamped to the area; the velocities are uniform for every distribution.
+  /// @param seed Is the seed of the draws.
+  /// @param distribution Is the placement of the birds.
+  void generateBirds(std::uint64_t seed, Distribution distribution);
+
   /// @brief Finds bird::Boid objects near a bird::Boid object or a bird::Predator object.
+  /// @details Only the cells of b_grid_ around the current object are searched, or its candidate list, see
+  /// setSkin(); the result is the same, and in the same order, as a scan over the whole of b_arrays_.
   /// @param i Is the index identifying the position of the shared pointer to the current object
   /// either in the b_flock_ vector or in the p_flock_ vector.
   /// @param is_boid Is a boolean constant which states whether the current object is a bird::Boid object or a
   /// bird::Predator object.
-  /// @return The vector containing the pointers to the bird::Boid objects near the current bird.
-  [[nodiscard]] std::vector<std::shared_ptr<bird::Bird>> findNearBoids(size_t i, bool is_boid) const;
+  /// @return The vector containing the pointers to the bird::Boid objects near the current bird, refreshed as by
+  /// getBoidFlock().
+  [[nodiscard]] std::vector<std::shared_ptr<bird::BasicBird<T>>> findNearBoids(size_t i, bool is_boid) const;
 
-  //// @brief Finds bird::Boid objects near a bird::Boid object or a bird::Predator object.
+  //// @brief Finds bird::Predator objects near a bird::Boid object or a bird::Predator object.
+  /// @details Only the cells of p_grid_ around the current object are searched, or its candidate list, see
+  /// setSkin(); the result is the same, and in the same order, as a scan over the whole of p_arrays_.
   /// @param i Is the index identifying the position of the shared pointer to the current object
   /// either in the b_flock_ vector or in the p_flock_ vector.
   /// @param is_boid Is a boolean constant which states whether the current object is a bird::Boid object or a
   /// bird::Predator object.
-  /// @return The vector containing the pointers to the bird::Predator objects near the current bird.
-  [[nodiscard]] std::vector<std::shared_ptr<bird::Bird>> findNearPredators(size_t i, bool is_boid) const;
+  /// @return The vector containing the pointers to the bird::Predator objects near the current bird, refreshed as by
+  /// getPredatorFlock().
+  [[nodiscard]] std::vector<std::shared_ptr<bird::BasicBird<T>>> findNearPredators(size_t i, bool is_boid) const;
+
+  /// @brief Finds the indices of the bird::Boid objects near a bird::Boid object or a bird::Predator object.
+  /// @details Same search as the overload above, without materializing the objects: the indices into getBoidArrays()
+  /// are written into a caller-provided vector, whose capacity is reused.
+  /// @param i Is the index of the current object either in getBoidArrays() or in getPredatorArrays().
+  /// @param is_boid States whether the current object is a bird::Boid object or a bird::Predator object.
+  /// @param near Is cleared and filled with the indices of the near bird::Boid objects, in increasing order.
+  void findNearBoids(size_t i, bool is_boid, std::vector<size_t>& near) const;
+
+  /// @brief Finds the indices of the bird::Predator objects near a bird::Boid object or a bird::Predator object.
+  /// @details Same search as the overload above, without materializing the objects: the indices into
+  /// getPredatorArrays() are written into a caller-provided vector, whose capacity is reused.
+  /// @param i Is the index of the current object either in getBoidArrays() or in getPredatorArrays().
+  /// @param is_boid States whether the current object is a bird::Boid object or a bird::Predator object.
+  /// @param near Is cleared and filled with the indices of the near bird::Predator objects, in increasing order.
+  void findNearPredators(size_t i, bool is_boid, std::vector<size_t>& near) const;
 
   /// @brief Evaluates the new position and velocity of a bird in the flock.
   /// @details Evaluates a new velocity for a bird::Boid object or a bird::Predator object, taking into account the
@@ -183,21 +661,38 @@ class Flock {
   ///  - cohesion (only for bird::Boid objects)
   ///  - repel (only for bird::Boid objects)
   ///  - chase (only for bird::Predator objects)
-  ///  Then evaluates the new position by multiplying the new velocity by graphic_par::dt. Eventually updates the
+  ///  Then evaluates the new position by multiplying the new velocity by Parameters::dt. Eventually updates the
   ///  position and orientation of the triangle associated with the bird::Boid or bird::Predator object.
   /// @param triangles Is the array containing the triangle associated with the bird.
-  /// @param i Is the index identifying the position of a bird::Boid object in the b_flock_ vector or a bird::Predator
-  /// object in the p_flock_ vector.
+  /// @param i Is the index identifying the position of a bird::Boid object in b_arrays_ or a bird::Predator object
+  /// in p_arrays_.
   /// @param is_boid Is a boolean constant which states whether the current object is a bird::Boid object or a
   /// bird::Predator object.
   /// @return The array containing, respectively, the updated position and velocity of the bird.
-  std::array<point::Point, 2> updateBird(sf::VertexArray& triangles, size_t i, bool is_boid) const;
+  std::array<point::BasicPoint<T>, 2> updateBird(sf::VertexArray& triangles, size_t i, bool is_boid) const;
+
+  /// @brief Evaluates the new position and velocity of a bird in the flock, using caller-provided scratch storage.
+  /// @details Same as the overload above; the neighbour queries write into near instead of allocating, so that
+  /// concurrent calls only need distinct Neighbours objects.
+  /// @param triangles Is the array containing the triangle associated with the bird.
+  /// @param i Is the index identifying the position of a bird::Boid object in b_arrays_ or a bird::Predator object
+  /// in p_arrays_.
+  /// @param is_boid States whether the current object is a bird::Boid object or a bird::Predator object.
+  /// @param near Is the scratch storage for the neighbour queries.
+  /// @return The array containing, respectively, the updated position and velocity of the bird.
+  std::array<point::BasicPoint<T>, 2> updateBird(sf::VertexArray& triangles, size_t i, bool is_boid,
+                                                 BasicNeighbours<T>& near) const;
 
   /// @brief Updates the position and the orientation of the triangles associated with the birds in the flock.
-  /// @details Updates the velocity and position of each bird::Boid and bird::Predator object in the flock. Then the
-  /// position and the orientation of the associated triangles are updated.
+  /// @details Updates the velocity and position of each bird::Boid and bird::Predator object in the flock and rebuilds
+  /// the spatial index from the new positions. Then the position and the orientation of the associated triangles are
+  /// updated in one pass, see triangles::rotateTriangles().
   /// @param triangles Array of triangles associated with each bird in the flock.
-  void evolve(sf::VertexArray& triangles) const;
+  void evolve(sf::VertexArray& triangles);
+
+  /// @brief Updates the velocity and position of each bird::Boid and bird::Predator object in the flock.
+  /// @details Same as the overload above, for runs without graphics: no triangle is evaluated.
+  void evolve();
 
   /// @brief Evaluates the relevant statistical quantities for the bird::Boid objects in the flock.
   /// @details It computes:
@@ -205,8 +700,18 @@ class Flock {
   /// - standard deviation of the distance between each boid
   /// - mean speed of the boids
   /// - standard deviation of the speed of the boids
+  /// All the couples of boids are taken into account, on the threads set by setThreads. In a world of
+  /// Boundary::Torus the distances are those between the closest images of the boids.
   ///@return A statistics::Statistics object.
   [[nodiscard]] statistics::Statistics statistics() const;
+
+  /// @brief Evaluates the relevant statistical quantities for the bird::Boid objects in the flock.
+  /// @details Same as the overload above, in the evaluation mode selected by options.
+  ///@param options Selects the evaluation mode, see statistics::evaluate.
+  ///@return A statistics::Statistics object.
+  [[nodiscard]] statistics::Statistics statistics(const statistics::Options& options) const;
 };
+/// @brief The Flock class represents a group of birds, in double precision.
+using Flock = BasicFlock<double>;
 }  // namespace flock
 #endif
\ No newline at end of file
@@ -31,7 +31,8 @@ inline constexpr double min_vel_x = -max_vel_x;
 /// bird::Predator object.
 inline constexpr double min_vel_y = -max_vel_y;
 
-///@brief Is an array containing the vertexes needed to draw the statistics' rectangle from sf::TriangleStrip.
+///@brief Is an array containing the vertexes needed to draw the statistics' rectangle of a window of the default height
+/// from sf::TriangleStrip; overlay::StatsOverlay spans the height of the configured window instead.
 inline std::array<sf::Vertex, 4> stats_rectangle = {
     sf::Vertex(sf::Vector2f(0., 0.)), sf::Vertex(sf::Vector2f(0., window_height)),
     sf::Vertex(sf::Vector2f(stats_width, 0.)), sf::Vertex(sf::Vector2f(stats_width, window_height))};
@@ -0,0 +1,152 @@
+/// @file       ../include/grid.hpp
+/// @brief      Defines the Grid class.
+///
+/// @details    This file contains the definition of the Grid class.
+///             A Grid object is a uniform spatial index over the positions of a group of birds: the plane is divided
+///             into square cells and every bird is filed under the cell containing its position, so that the birds
+///             within a given distance from a point can be found by visiting only the neighbouring cells. A grid can
+///             also be periodic, covering a toroidal world whose opposite edges are adjacent.
+#ifndef GRID_HPP
+#define GRID_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "../include/point.hpp"
+
+namespace grid {
+
+/// @brief The Grid class is a uniform-grid spatial index with a fixed cell size.
+class Grid {
+ private:
+  double cell_size_;
+
+  /// @brief Is the lower-left corner of the bounding box of the indexed positions.
+  double x0_;
+  double y0_;
+
+  size_t columns_;
+  size_t rows_;
+
+  /// @brief States whether the grid wraps around, see buildPeriodic().
+  bool periodic_;
+
+  /// @brief Are the sides of the world covered by a periodic grid.
+  double width_;
+  double height_;
+
+  /// @brief Is the offset in indices_ of the first bird of each cell; the last element is the number of birds.
+  std::vector<size_t> cell_start_;
+
+  /// @brief Are the indices of the birds, sorted by cell and in increasing order within each cell.
+  std::vector<size_t> indices_;
+
+  /// @brief Are the cell of each bird and the insertion cursor of each cell, kept to reuse their capacity.
+  std::vector<size_t> cell_of_;
+  std::vector<size_t> cursor_;
+
+  /// @brief Upper bound on the number of cells, relative to the number of indexed birds.
+  static constexpr size_t max_cells_per_bird_ = 4;
+
+  /// @brief Evaluates the column of the cell containing a given abscissa.
+  /// @details Abscissae outside the grid are clamped to the first or last column, or wrapped if the grid is
+  /// periodic.
+  /// @param x Is the abscissa.
+  /// @return The column index.
+  [[nodiscard]] size_t column(double x) const;
+
+  /// @brief Evaluates the row of the cell containing a given ordinate.
+  /// @details Ordinates outside the grid are clamped to the first or last row, or wrapped if the grid is periodic.
+  /// @param y Is the ordinate.
+  /// @return The row index.
+  [[nodiscard]] size_t row(double y) const;
+
+  /// @brief Sorts the indices of the birds by cell, once columns_ and rows_ are set.
+  template <typename T>
+  void fill(const std::vector<T>& x, const std::vector<T>& y);
+
+  /// @brief Visits every bird filed in the cells around a cell of a periodic grid, each cell once.
+  template <typename Visitor>
+  void forEachPeriodicCandidate(size_t c, size_t r, Visitor&& visit) const {
+    // with fewer than three rows or columns the cells around wrap onto each other
+    const size_t n_rows = rows_ < 3 ? rows_ : 3;
+    const size_t n_columns = columns_ < 3 ? columns_ : 3;
+    for (size_t dr = 0; dr < n_rows; ++dr) {
+      const size_t k = (r + rows_ - 1 + dr) % rows_;
+      for (size_t dc = 0; dc < n_columns; ++dc) {
+        const size_t cell = k * columns_ + (c + columns_ - 1 + dc) % columns_;
+        for (size_t n = cell_start_[cell]; n < cell_start_[cell + 1]; ++n) {
+          visit(indices_[n]);
+        }
+      }
+    }
+  }
+
+ public:
+  /// @brief Constructs an empty Grid object.
+  /// @param cell_size Is the side of the square cells, which must be at least the largest query radius.
+  explicit Grid(double cell_size);
+
+  /// @brief Files the given positions into the cells of the grid.
+  /// @details The grid is fitted to the bounding box of the positions, and the indices of the birds are sorted by
+  /// cell with a counting sort. Any previous content is discarded.
+  /// @tparam T Is the type of the components, float or double; double for braced lists.
+  /// @param x Are the x components of the positions of the birds; the i-th position is filed under index i.
+  /// @param y Are the y components of the positions of the birds.
+  template <typename T = double>
+  void build(const std::vector<T>& x, const std::vector<T>& y);
+
+  /// @brief Files the given positions into the cells of a periodic grid over a toroidal world.
+  /// @details The world [x0, x0 + width) x [y0, y0 + height) is divided into as many cells of side at least the cell
+  /// size as fit, and the cells of the last row and column are adjacent to those of the first ones: positions outside
+  /// the world are filed under their image inside it. The indices of the birds are sorted by cell as by build().
+  /// @tparam T Is the type of the components, float or double; double for braced lists.
+  /// @param x Are the x components of the positions of the birds; the i-th position is filed under index i.
+  /// @param y Are the y components of the positions of the birds.
+  /// @param x0 Is the left edge of the world.
+  /// @param y0 Is the top edge of the world.
+  /// @param width Is the width of the world.
+  /// @param height Is the height of the world.
+  template <typename T = double>
+  void buildPeriodic(const std::vector<T>& x, const std::vector<T>& y, double x0, double y0, double width,
+                     double height);
+
+  /// @brief Gets the number of indexed birds.
+  /// @return The number of birds.
+  [[nodiscard]] size_t size() const;
+
+  /// @brief Visits every bird filed in the cell containing a point and in the eight cells around it.
+  /// @details Every bird closer to the point than the cell size is visited, together with some farther ones; the
+  /// caller is responsible for the exact distance test. Birds are visited cell by cell, so the order of the indices is
+  /// not increasing. In a periodic grid the cells around the point wrap across the edges of the world.
+  /// @param p Is the point around which birds are searched.
+  /// @param visit Is a callable object invoked with the index of each bird.
+  template <typename T, typename Visitor>
+  void forEachCandidate(const point::BasicPoint<T>& p, Visitor&& visit) const {
+    if (indices_.empty()) {
+      return;
+    }
+    const size_t c = column(p.getX());
+    const size_t r = row(p.getY());
+    if (periodic_) {
+      forEachPeriodicCandidate(c, r, visit);
+      return;
+    }
+
+    const size_t r_end = r + 1 < rows_ ? r + 1 : r;
+    const size_t c_begin = c > 0 ? c - 1 : c;
+    const size_t c_end = c + 1 < columns_ ? c + 1 : c;
+
+    for (size_t k = r > 0 ? r - 1 : r; k <= r_end; ++k) {
+      // cells of the same row are contiguous, so the three of them form a single run of indices_
+      const size_t begin = cell_start_[k * columns_ + c_begin];
+      const size_t end = cell_start_[k * columns_ + c_end + 1];
+      for (size_t n = begin; n < end; ++n) {
+        visit(indices_[n]);
+      }
+    }
+  }
+};
+}  // namespace grid
+
+#endif
@@ -0,0 +1,33 @@
+/// @file       ../include/morton.hpp
+/// @brief      Defines the functions ordering points along the Z curve.
+///
+/// @details    This file contains the functions evaluating the Morton code of a point, which interleaves the bits of
+///             its two coordinates, and the permutation sorting a set of points by their codes. Points close in the
+///             plane are mostly close along the curve, so birds stored in this order are mostly close in memory too.
+#ifndef MORTON_HPP
+#define MORTON_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace morton {
+
+/// @brief Interleaves the bits of two coordinates.
+/// @param x Is the first coordinate, whose bits go to the even positions of the code.
+/// @param y Is the second coordinate, whose bits go to the odd positions of the code.
+/// @return The Morton code of (x, y).
+std::uint32_t encode(std::uint16_t x, std::uint16_t y);
+
+/// @brief Evaluates the permutation sorting points by their Morton code.
+/// @details The coordinates are first mapped onto a 65536 x 65536 lattice over the bounding box of the points. The
+/// codes are sorted by a least-significant-digit radix sort, which is stable: points with the same code keep their
+/// order.
+/// @param x Are the first coordinates of the points.
+/// @param y Are the second coordinates of the points.
+/// @param permutation Is filled with the indices of the points along the curve, its capacity reused.
+template <typename T>
+void order(const std::vector<T>& x, const std::vector<T>& y, std::vector<size_t>& permutation);
+}  // namespace morton
+
+#endif
@@ -0,0 +1,63 @@
+/// @file       ../include/overlay.hpp
+/// @brief      Defines the StatsOverlay class.
+///
+/// @details    This file contains the definition of the StatsOverlay class.
+///             A StatsOverlay object is the statistics panel drawn on the left side of the window: it owns the
+///             background rectangle, the font and the texts, so that they are created once for the whole simulation.
+#ifndef OVERLAY_HPP
+#define OVERLAY_HPP
+
+#include <SFML/Graphics.hpp>
+#include <string>
+
+#include "../include/statistics.hpp"
+
+namespace overlay {
+
+/// @brief Formats the statistics shown by the overlay.
+/// @param stats Is the statistics::Statistics object to format.
+/// @return The text of the panel.
+std::string formatStatistics(const statistics::Statistics& stats);
+
+/// @brief The StatsOverlay class represents the statistics panel of the window.
+class StatsOverlay final : public sf::Drawable {
+ private:
+  sf::VertexBuffer background_;
+
+  /// @brief Is the font of text_; it must outlive text_, which only keeps a pointer to it, and it caches the
+  /// rasterized glyphs across frames.
+  sf::Font font_;
+
+  sf::Text text_;
+
+  /// @brief Is the text of the frame profile, in smaller characters below text_.
+  sf::Text profile_text_;
+
+  /// @brief Draws the background rectangle and the text.
+  /// @param target Is the render target to draw to.
+  /// @param states Are the render states to use.
+  void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+ public:
+  /// @brief Constructs a StatsOverlay object, loading the font from file.
+  /// @details Throws std::runtime_error if the font cannot be loaded.
+  /// @param font_path Is the path of the font file.
+  /// @param height Is the height of the window, flock::Parameters::height, which the panel spans.
+  StatsOverlay(const std::string& font_path, float height);
+
+  StatsOverlay(const StatsOverlay&) = delete;
+  StatsOverlay& operator=(const StatsOverlay&) = delete;
+
+  /// @brief Regenerates the text of the panel.
+  /// @details Meant to be called only when the statistics change, since setting the string of a sf::Text rebuilds
+  /// its geometry.
+  /// @param stats Are the statistics to show.
+  void update(const statistics::Statistics& stats);
+
+  /// @brief Regenerates the text of the frame profile, e.g. profiler::Profiler::report().
+  /// @param profile Is the text to show.
+  void updateProfile(const std::string& profile);
+};
+}  // namespace overlay
+
+#endif
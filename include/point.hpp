@@ -1,88 +1,106 @@
 /// @file       ../include/point.hpp
-/// @brief      Defines the Point class.
+/// @brief      Defines the BasicPoint class template and the Point class.
 ///
-/// @details    This file contains the definition of the Point class.
-///             The Point class represents a vector in a two-dimensional space.
+/// @details    This file contains the definition of the BasicPoint class template and of its double precision
+///             instance, the Point class. A BasicPoint object represents a vector in a two-dimensional space, whose
+///             components are of a floating point type: float halves the memory a flock streams through at each step,
+///             double is kept as the reference.
 #ifndef POINT_HPP
 #define POINT_HPP
 
 #include <SFML/Graphics.hpp>
 
 namespace point {
-/// @brief The Point class represents a vector in 2D.
-class Point {
+/// @brief The BasicPoint class template represents a vector in 2D.
+/// @details It is instantiated for float and double only, in point.cpp.
+/// @tparam T Is the type of the components.
+template <typename T>
+class BasicPoint {
  private:
-  double x_;
-  double y_;
+  T x_;
+  T y_;
 
  public:
-  /// @brief Constructs a new Point object and sets the vector to (0., 0.) as default.
-  Point();
+  /// @brief Is the type of the components.
+  using value_type = T;
 
-  /// @brief Constructs a new Point object, with the two coordinates.
+  /// @brief Constructs a new BasicPoint object and sets the vector to (0., 0.) as default.
+  BasicPoint();
+
+  /// @brief Constructs a new BasicPoint object, with the two coordinates.
   /// @param x Is the x component of the vector.
   /// @param y Is the y component of the vector.
-  Point(double x, double y);
+  BasicPoint(T x, T y);
 
   /// @brief Gets the x coordinate.
   /// @return The x component of the vector.
-  [[nodiscard]] double getX() const;
+  [[nodiscard]] T getX() const;
 
   /// @brief Gets the y coordinate.
   /// @return The y component of the vector.
-  [[nodiscard]] double getY() const;
+  [[nodiscard]] T getY() const;
 
   ///@brief Evaluates the distance of the vector from the origin.
   ///@return The distance from the origin.
-  [[nodiscard]] double module() const;
+  [[nodiscard]] T module() const;
 
-  ///@brief Evaluates the distance between two Point objects.
-  ///@param p Is the Point we want to find the distance from.
+  ///@brief Evaluates the distance between two BasicPoint objects.
+  ///@param p Is the BasicPoint we want to find the distance from.
   ///@return The module of the two vector difference.
-  [[nodiscard]] double distance(const Point& p) const;
+  [[nodiscard]] T distance(const BasicPoint& p) const;
 
   ///@brief Evaluates the angle between the vector and the vertical axis.
   ///@return An angle in radiant, in the range [0, 2pi].
   [[nodiscard]] float angle() const;
 
-  ///@brief Evaluates the vector sum between itself and another Point object.
-  ///@param a Is another Point object.
+  ///@brief Evaluates the vector sum between itself and another BasicPoint object.
+  ///@param a Is another BasicPoint object.
   ///@return Itself.
-  Point& operator+=(const Point& a);
+  BasicPoint& operator+=(const BasicPoint& a);
 
-  ///@brief Converts a Point object into a sf::Vertex object.
+  ///@brief Converts a BasicPoint object into a sf::Vertex object.
   ///@return The corresponding sf::Vertex object.
   sf::Vertex operator()() const;
 };
 
-///@brief Evaluates the vector sum between two Point objects.
+/// @brief The Point class represents a vector in 2D, in double precision.
+using Point = BasicPoint<double>;
+
+///@brief Evaluates the vector sum between two BasicPoint objects.
 ///@param a First addend.
 ///@param b Second addend.
 ///@return The vector sum.
-Point operator+(const Point& a, const Point& b);
+template <typename T>
+BasicPoint<T> operator+(const BasicPoint<T>& a, const BasicPoint<T>& b);
 
-///@brief Evaluates the vector difference between two Point objects.
+///@brief Evaluates the vector difference between two BasicPoint objects.
 ///@param a Is the subtrahend.
 ///@param b Is the minuend.
 ///@return The vector difference.
-Point operator-(const Point& a, const Point& b);
+template <typename T>
+BasicPoint<T> operator-(const BasicPoint<T>& a, const BasicPoint<T>& b);
 
-///@brief Evaluates the multiplication by a scalar of a Point object.
+///@brief Evaluates the multiplication by a scalar of a BasicPoint object.
+///@details The scalar is first converted to the type of the components.
 ///@param scalar Is the scalar that we want to multiply for.
-///@param a Is a Point object.
-///@return The vector whose components are the components of the Point object multiplied by the scalar.
-Point operator*(double scalar, const Point& a);
+///@param a Is a BasicPoint object.
+///@return The vector whose components are the components of the BasicPoint object multiplied by the scalar.
+template <typename T>
+BasicPoint<T> operator*(double scalar, const BasicPoint<T>& a);
 
-///@brief Evaluates the division by a scalar of Point object.
+///@brief Evaluates the division by a scalar of BasicPoint object.
+///@details The scalar is first converted to the type of the components.
 ///@param scalar Is the scalar that we want to divide for.
-///@param a Is a Point object.
-///@return The vector whose components are the components of the Point object divided by the scalar.
-Point operator/(const Point& a, double scalar);
+///@param a Is a BasicPoint object.
+///@return The vector whose components are the components of the BasicPoint object divided by the scalar.
+template <typename T>
+BasicPoint<T> operator/(const BasicPoint<T>& a, double scalar);
 
-///@brief Compares two Point objects.
+///@brief Compares two BasicPoint objects.
 ///@param a Is the first term of the comparison.
 ///@param b Is the second term of the comparison
 ///@return The result of the comparison.
-bool operator==(const Point& a, const Point& b);
+template <typename T>
+bool operator==(const BasicPoint<T>& a, const BasicPoint<T>& b);
 }  // namespace point
-#endif
\ No newline at end of file
+#endif
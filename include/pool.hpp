@@ -0,0 +1,83 @@
+/// @file       ../include/pool.hpp
+/// @brief      Defines the ThreadPool class.
+///
+/// @details    This file contains the definition of the ThreadPool class.
+///             A ThreadPool object keeps a fixed set of worker threads alive for its whole lifetime, and splits loops
+///             over an index range among them, so that no thread is created while the simulation runs.
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pool {
+
+/// @brief The ThreadPool class represents a persistent group of worker threads executing parallel loops.
+class ThreadPool {
+ private:
+  std::vector<std::thread> workers_;
+
+  /// @brief Serializes the loops submitted from different threads.
+  std::mutex submit_mutex_;
+
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+
+  /// @brief Is incremented every time a loop is submitted, and wakes the workers up.
+  size_t generation_;
+
+  /// @brief Is the number of workers which have not finished the current loop yet.
+  size_t running_;
+
+  bool stop_;
+
+  /// @brief Is the loop being executed, valid while running_ is not zero.
+  const std::function<void(size_t, size_t, size_t)>* task_;
+  size_t n_;
+  size_t grain_;
+
+  /// @brief Is the first index not yet claimed by a worker.
+  std::atomic<size_t> next_;
+
+  /// @brief Claims chunks of the current loop and executes them until the range is exhausted.
+  /// @param worker Is the index of the calling worker.
+  void work(size_t worker);
+
+  /// @brief Is the body of each worker thread.
+  /// @param worker Is the index of the worker.
+  void loop(size_t worker);
+
+ public:
+  /// @brief Constructs a ThreadPool object and starts its workers.
+  /// @details The thread calling parallelFor() takes part in the loop as worker 0, so n_threads - 1 threads are
+  /// started.
+  /// @param n_threads Is the number of workers, at least 1.
+  explicit ThreadPool(size_t n_threads);
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /// @brief Stops and joins the workers.
+  ~ThreadPool();
+
+  /// @brief Gets the number of workers, including the calling thread.
+  /// @return The number of workers.
+  [[nodiscard]] size_t size() const;
+
+  /// @brief Executes a task over the range [0, n), split into contiguous chunks, and waits for its completion.
+  /// @details Each chunk is executed by exactly one worker; which worker executes which chunk is not deterministic,
+  /// so the task must not depend on it except for selecting per-worker scratch storage. The task must not call
+  /// parallelFor() on the same pool.
+  /// @param n Is the size of the range.
+  /// @param task Is called as task(begin, end, worker) for each chunk [begin, end), worker being in [0, size()).
+  void parallelFor(size_t n, const std::function<void(size_t, size_t, size_t)>& task);
+};
+}  // namespace pool
+
+#endif
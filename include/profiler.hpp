@@ -0,0 +1,136 @@
+/// @file       ../include/profiler.hpp
+/// @brief      Defines the Profiler class and the ScopedTimer class.
+///
+/// @details    This file contains the definition of the Profiler class and of the ScopedTimer class.
+///             A Profiler object keeps, for each phase of a frame, the durations of the last frames, from which the
+///             percentiles shown in the statistics panel are evaluated. A ScopedTimer object records in a Profiler the
+///             time elapsed between its construction and its destruction.
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace profiler {
+
+/// @brief Identifies a timed phase of a frame.
+enum class Phase {
+  ///@brief Is the polling of the window events.
+  Events,
+
+  ///@brief Is a whole step of the simulation, flock::Flock::evolve.
+  Evolve,
+
+  ///@brief Is the update of the birds within a step: neighbour queries and flight rules.
+  Rules,
+
+  ///@brief Is the commit of the new state and the rebuild of the spatial index within a step.
+  Index,
+
+  ///@brief Is the update of the triangles, or of the points drawn on the GPU, after a step.
+  Triangles,
+
+  ///@brief Is the evaluation of the statistics.
+  Statistics,
+
+  ///@brief Is the regeneration of the text of the statistics panel.
+  Overlay,
+
+  ///@brief Is the drawing and the display of the frame.
+  Draw
+};
+
+///@brief Is the number of values of Phase.
+inline constexpr size_t n_phases = 8;
+
+///@brief Returns the name of a phase, as written in reports.
+///@param phase Is the phase.
+///@return A null-terminated string.
+const char* phaseName(Phase phase);
+
+/// @brief The Summary struct collects the timings of a phase, in milliseconds.
+/// @details The percentiles refer to the last samples kept by the Profiler, count, mean and max to the whole run.
+struct Summary {
+  size_t count;
+  double mean;
+  double max;
+  double p50;
+  double p95;
+  double p99;
+};
+
+/// @brief The Profiler class collects the durations of the phases of each frame.
+/// @details Recording is thread safe, so that phases timed on different threads can share a Profiler.
+class Profiler {
+ private:
+  /// @brief Are the samples of one phase.
+  struct Series {
+    ///@brief Is the ring buffer of the last samples.
+    std::vector<double> window;
+
+    ///@brief Is the slot of window the next sample is written to.
+    size_t next;
+
+    size_t count;
+    double total;
+    double max;
+  };
+
+  size_t window_size_;
+  std::array<Series, n_phases> series_;
+  mutable std::mutex mutex_;
+
+ public:
+  /// @brief Constructs a Profiler object.
+  /// @param window_size Is the number of samples per phase the percentiles are evaluated on, at least 1.
+  explicit Profiler(size_t window_size);
+
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  /// @brief Records a duration.
+  /// @param phase Is the phase the duration refers to.
+  /// @param milliseconds Is the duration.
+  void record(Phase phase, double milliseconds);
+
+  /// @brief Evaluates the timings of a phase.
+  /// @param phase Is the phase.
+  /// @return A Summary object, every value '0' if no duration has been recorded.
+  [[nodiscard]] Summary summary(Phase phase) const;
+
+  /// @brief Formats p50, p95 and p99 of the recorded phases, one phase per line, for the statistics panel.
+  /// @return The text of the report.
+  [[nodiscard]] std::string report() const;
+
+  /// @brief Writes the timings of every phase as CSV.
+  /// @param out Is the output stream.
+  void dump(std::ostream& out) const;
+};
+
+/// @brief The ScopedTimer class times its own lifetime.
+class ScopedTimer {
+ private:
+  Profiler* profiler_;
+  Phase phase_;
+  std::chrono::steady_clock::time_point start_;
+
+ public:
+  /// @brief Constructs a ScopedTimer object, starting the time measurement.
+  /// @param profiler Is the Profiler the duration is recorded in on destruction; if nullptr nothing is measured.
+  /// @param phase Is the timed phase.
+  ScopedTimer(Profiler* profiler, Phase phase);
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  /// @brief Destructs the ScopedTimer object, recording the elapsed time.
+  ~ScopedTimer();
+};
+}  // namespace profiler
+
+#endif
@@ -0,0 +1,230 @@
+/// @file       ../include/recorder.hpp
+/// @brief      Defines the Recorder class and the Reader class.
+///
+/// @details    This file contains the definition of the Recorder class and of the Reader class.
+///             A Recorder object appends the positions and velocities of the birds, every few steps, to a trajectory
+///             file, which grows by chunks mapped into memory and is written by a thread of its own. A Reader object
+///             maps a trajectory file and decodes any of its frames.
+///             A trajectory file is a Header followed by frames of frame_bytes bytes each: the step, as a 64 bit
+///             integer, then x, y, vx, vy of the bird::Boid objects and of the bird::Predator objects, encoded as
+///             selected by Encoding.
+#ifndef RECORDER_HPP
+#define RECORDER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/storage.hpp"
+
+namespace recorder {
+
+///@brief Identifies a trajectory file.
+inline constexpr char magic[8] = {'B', 'O', 'I', 'D', 'T', 'R', 'A', 'J'};
+
+///@brief Is the version of the format written by Recorder; files of other versions are rejected by Reader.
+inline constexpr std::uint32_t version = 1;
+
+/// @brief Identifies how positions and velocities are stored.
+enum class Encoding : std::uint32_t {
+  ///@brief IEEE single precision.
+  Float32,
+
+  ///@brief IEEE half precision: 11 significant bits, e.g. steps of 1 pixel between 1024 and 2048 pixels.
+  Float16,
+
+  ///@brief 16 bit integers spanning [min_position, max_position] and [-max_speed, max_speed], values outside are
+  /// clamped.
+  Int16
+};
+
+/// @brief The Options struct collects the settings of a Recorder.
+struct Options {
+  Encoding encoding;
+
+  ///@brief Is the interval, in steps, between two recorded frames.
+  size_t every;
+
+  ///@brief Is the range of the positions encoded by Encoding::Int16, in pixels.
+  double min_position;
+  double max_position;
+
+  ///@brief Is the largest speed encoded by Encoding::Int16.
+  double max_speed;
+
+  ///@brief Is the number of frames the file grows by at a time.
+  size_t chunk_frames;
+
+  ///@brief Constructs an Options object: Encoding::Float32, every step, positions in [-1000, 3000], speeds up to 20,
+  /// chunks of 64 frames.
+  Options();
+};
+
+/// @brief The Header struct is the beginning of a trajectory file.
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t encoding;
+  std::uint64_t n_boids;
+  std::uint64_t n_predators;
+  std::uint64_t every;
+
+  ///@brief Is the size of a frame, a multiple of 8.
+  std::uint64_t frame_bytes;
+
+  ///@brief Is the number of complete frames, updated after each frame is written.
+  std::uint64_t n_frames;
+
+  double min_position;
+  double max_position;
+  double max_speed;
+};
+
+/// @brief The Recorder class writes a trajectory file.
+/// @details record() only copies the state of the birds into a queue of a few frames; encoding and writing happen on
+/// the thread of the Recorder. If the queue is full, record() waits for a frame to be written, so no frame is lost.
+class Recorder {
+ private:
+  /// @brief Is a frame waiting to be written.
+  struct Pending {
+    size_t step;
+    storage::BirdArrays boids;
+    storage::BirdArrays predators;
+  };
+
+  Options options_;
+  int fd_;
+  size_t frame_bytes_;
+
+  /// @brief Is the mapping of the header of the file.
+  Header* header_;
+
+  /// @brief Is the mapping of the current chunk; base_ is the start of the mapping, chunk_ its first frame.
+  void* base_;
+  size_t base_length_;
+  unsigned char* chunk_;
+  size_t chunk_first_;
+
+  std::deque<Pending> ready_;
+  std::vector<Pending> spare_;
+  std::mutex mutex_;
+  std::condition_variable written_;
+  std::condition_variable queued_;
+  bool stop_;
+  bool failed_;
+
+  /// @brief Is the writer thread, started last, once every other member is constructed.
+  std::thread writer_;
+
+  /// @brief Writes the frames of the queue until stop_ is set and the queue is empty.
+  void loop();
+
+  /// @brief Encodes a frame into the file, growing it by a chunk if needed.
+  /// @return false if the file could not be grown.
+  bool write(const Pending& frame);
+
+  /// @brief Queues a frame, see record(); the ids are nullptr for birds stored in the order of their ids.
+  template <typename T>
+  void enqueue(size_t step, const storage::BasicBirdArrays<T>& boids, const storage::BasicBirdArrays<T>& predators,
+               const std::vector<size_t>* boid_ids, const std::vector<size_t>* predator_ids);
+
+ public:
+  /// @brief Constructs a Recorder object, creating the file and starting the writer thread.
+  /// @details Throws std::runtime_error if the file cannot be created.
+  /// @param path Is the path of the file, overwritten if it exists.
+  /// @param n_boids Is the number of bird::Boid objects of every frame.
+  /// @param n_predators Is the number of bird::Predator objects of every frame.
+  /// @param options Are the settings of the recording.
+  Recorder(const std::string& path, size_t n_boids, size_t n_predators, const Options& options);
+
+  Recorder(const Recorder&) = delete;
+  Recorder& operator=(const Recorder&) = delete;
+
+  /// @brief Destructs the Recorder object, writing the frames still queued and trimming the file to its frames.
+  ~Recorder();
+
+  /// @brief Queues a frame, if step is a multiple of Options::every.
+  /// @details Called by one thread at a time, e.g. the simulation thread. Throws std::runtime_error if the file could
+  /// not be grown for a previous frame.
+  /// @tparam T Is the type of the components of the birds, float or double; frames are encoded as set by
+  /// Options::encoding either way.
+  /// @param step Is the step of the state.
+  /// @param boids Are the positions and velocities of the bird::Boid objects.
+  /// @param predators Are the positions and velocities of the bird::Predator objects.
+  template <typename T>
+  void record(size_t step, const storage::BasicBirdArrays<T>& boids, const storage::BasicBirdArrays<T>& predators);
+
+  /// @brief Queues a frame of birds stored out of the order of their ids, if step is a multiple of Options::every.
+  /// @details Same as the overload above, the bird at index k being written at index ids[k] of the frame, so that
+  /// each bird keeps its place in the file when a flock sorts its birds in memory, see flock::Flock::setReorder().
+  /// @tparam T Is the type of the components of the birds.
+  /// @param step Is the step of the state.
+  /// @param boids Are the positions and velocities of the bird::Boid objects.
+  /// @param predators Are the positions and velocities of the bird::Predator objects.
+  /// @param boid_ids Are the ids of the bird::Boid objects, a permutation of their indices.
+  /// @param predator_ids Are the ids of the bird::Predator objects, a permutation of their indices.
+  template <typename T>
+  void record(size_t step, const storage::BasicBirdArrays<T>& boids, const storage::BasicBirdArrays<T>& predators,
+              const std::vector<size_t>& boid_ids, const std::vector<size_t>& predator_ids);
+};
+
+/// @brief The Reader class maps a trajectory file into memory, read-only, for random access to its frames.
+class Reader {
+ private:
+  void* data_;
+  size_t size_;
+
+  /// @brief Gets the address of a frame.
+  [[nodiscard]] const unsigned char* frameData(size_t t) const;
+
+ public:
+  /// @brief Constructs a Reader object, mapping a file.
+  /// @details Throws std::runtime_error if the file cannot be mapped or is not a trajectory of the current version.
+  /// @param path Is the path of the file.
+  explicit Reader(const std::string& path);
+
+  Reader(const Reader&) = delete;
+  Reader& operator=(const Reader&) = delete;
+
+  /// @brief Destructs the Reader object, unmapping the file.
+  ~Reader();
+
+  /// @brief Gets the header of the file.
+  /// @return The header.
+  [[nodiscard]] const Header& header() const;
+
+  /// @brief Gets the number of frames of the file.
+  /// @return The number of frames.
+  [[nodiscard]] size_t frames() const;
+
+  /// @brief Gets the step a frame was recorded at.
+  /// @details Throws std::out_of_range if t is not less than frames().
+  /// @param t Is the index of the frame.
+  /// @return The step.
+  [[nodiscard]] size_t step(size_t t) const;
+
+  /// @brief Decodes a frame.
+  /// @details Throws std::out_of_range if t is not less than frames().
+  /// @param t Is the index of the frame.
+  /// @param boids Is resized and overwritten with the positions and velocities of the bird::Boid objects.
+  /// @param predators Is resized and overwritten with the positions and velocities of the bird::Predator objects.
+  void frame(size_t t, storage::BirdArrays& boids, storage::BirdArrays& predators) const;
+};
+
+///@brief Converts a float to IEEE half precision, rounding to nearest even.
+///@param value Is the value to convert.
+///@return The bits of the half precision value.
+std::uint16_t toHalf(float value);
+
+///@brief Converts an IEEE half precision value to float, exactly.
+///@param bits Are the bits of the half precision value.
+///@return The value.
+float fromHalf(std::uint16_t bits);
+}  // namespace recorder
+
+#endif
@@ -0,0 +1,88 @@
+/// @file       ../include/renderer.hpp
+/// @brief      Defines the BirdRenderer class.
+///
+/// @details    This file contains the definition of the BirdRenderer class.
+///             A BirdRenderer object draws the birds of the flock, either as triangles rotated on the CPU or as one
+///             point per bird, expanded into a rotated triangle by a geometry shader on the GPU.
+#ifndef RENDERER_HPP
+#define RENDERER_HPP
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+#include "../include/flock.hpp"
+#include "../include/storage.hpp"
+
+namespace renderer {
+
+/// @brief Identifies how the birds are drawn.
+enum class Path {
+  ///@brief Three vertices per bird, rotated on the CPU by triangles::rotateTriangles().
+  Cpu,
+
+  ///@brief One vertex per bird, streamed to a sf::VertexBuffer and expanded into a triangle by a sf::Shader.
+  Gpu
+};
+
+///@brief Writes one sf::Vertex per bird, bird::Boid objects first, for the GPU path.
+///@details The position of the vertex is the position of the bird, the color is the color of its species and the
+/// texture coordinates are the sine and the cosine of the angle of its velocity, as in triangles::rotateTriangles().
+///@param boids Are the positions and velocities of the bird::Boid objects.
+///@param predators Are the positions and velocities of the bird::Predator objects.
+///@param points Is resized to the number of birds and overwritten.
+void packBirds(const storage::BirdArrays& boids, const storage::BirdArrays& predators, std::vector<sf::Vertex>& points);
+
+/// @brief The BirdRenderer class draws the birds of a flock.
+class BirdRenderer final : public sf::Drawable {
+ private:
+  Path path_;
+
+  /// @brief Are the triangles of the CPU path.
+  sf::VertexArray triangles_;
+
+  /// @brief Is the buffer of the GPU path, one point per bird, refilled each frame.
+  sf::VertexBuffer points_;
+
+  /// @brief Is the CPU copy of points_, reused by every call to update().
+  std::vector<sf::Vertex> staging_;
+
+  /// @brief Is the shader expanding each point into the triangle of triangles::relative_position, the one of a boid
+  /// for the first flock::Flock::getBoidsNum() points, the one of a predator for the others.
+  sf::Shader shader_;
+
+  /// @brief Draws the birds.
+  /// @param target Is the render target to draw to.
+  /// @param states Are the render states to use.
+  void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+ public:
+  /// @brief Constructs a BirdRenderer object for the given flock.
+  /// @details The GPU path is chosen only if it is requested and vertex buffers and geometry shaders are available
+  /// and work; otherwise the CPU path is used. The GPU path requires an active OpenGL context, e.g. an open window.
+  /// @param flock Is the flock, whose number of birds must not change afterwards.
+  /// @param prefer_gpu States whether the GPU path should be tried.
+  BirdRenderer(const flock::Flock& flock, bool prefer_gpu);
+
+  BirdRenderer(const BirdRenderer&) = delete;
+  BirdRenderer& operator=(const BirdRenderer&) = delete;
+
+  /// @brief Gets the path the birds are drawn with.
+  /// @return Path::Gpu or Path::Cpu.
+  [[nodiscard]] Path getPath() const;
+
+  /// @brief Gets the triangles of the CPU path.
+  /// @return The triangles, empty on the GPU path.
+  [[nodiscard]] const sf::VertexArray& getTriangles() const;
+
+  /// @brief Refreshes what is drawn from the current state of the flock.
+  /// @param flock Is the flock the BirdRenderer was constructed with.
+  void update(const flock::Flock& flock);
+
+  /// @brief Refreshes what is drawn from a state of the flock, e.g. a simulation::Frame.
+  /// @param boids Are the positions and velocities of the bird::Boid objects, as many as in the flock.
+  /// @param predators Are the positions and velocities of the bird::Predator objects, as many as in the flock.
+  void update(const storage::BirdArrays& boids, const storage::BirdArrays& predators);
+};
+}  // namespace renderer
+
+#endif
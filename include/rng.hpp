@@ -0,0 +1,105 @@
+/// @file       ../include/rng.hpp
+/// @brief      Defines the Xoshiro256 class and the seeding functions.
+///
+/// @details    This file contains the definition of the Xoshiro256 class, a xoshiro256** generator, and of the
+///             splitmix64 function, which expands a seed into its state.
+///             Every draw is computed here from integer operations and IEEE arithmetic, without the distributions of
+///             the standard library, whose algorithms differ between implementations: a seed gives the same birds, bit
+///             for bit, with any compiler and on any platform.
+#ifndef RNG_HPP
+#define RNG_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+namespace rng {
+
+/// @brief Advances a splitmix64 state and returns its next output.
+/// @param state Is the state, incremented by the golden ratio.
+/// @return A 64 bit value, a bijective mix of the new state.
+inline std::uint64_t splitmix64(std::uint64_t& state) {
+  state += 0x9e3779b97f4a7c15u;
+  std::uint64_t z{state};
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+  return z ^ (z >> 31);
+}
+
+/// @brief The Xoshiro256 class is the xoshiro256** generator of Blackman and Vigna.
+/// @details It satisfies the UniformRandomBitGenerator requirements, so it can drive the algorithms of the standard
+/// library, but uniform() and below() should be used for draws that must be reproducible.
+class Xoshiro256 {
+ private:
+  std::array<std::uint64_t, 4> s_;
+
+  static std::uint64_t rotl(const std::uint64_t x, const int k) { return (x << k) | (x >> (64 - k)); }
+
+ public:
+  using result_type = std::uint64_t;
+
+  /// @brief Constructs a Xoshiro256 object, expanding a seed into its state by splitmix64().
+  /// @param seed Is the seed; every value, 0 included, is valid.
+  explicit Xoshiro256(std::uint64_t seed) : s_{} {
+    for (std::uint64_t& word : s_) {
+      word = splitmix64(seed);
+    }
+  }
+
+  /// @brief Constructs the generator of one of the streams of a seed.
+  /// @details Streams of the same seed are independent in practice: their states are hashed from the seed and the
+  /// index, so that e.g. each chunk of a parallel loop draws from its own stream, whichever thread runs it.
+  /// @param seed Is the seed shared by the streams.
+  /// @param stream Is the index of the stream.
+  Xoshiro256(std::uint64_t seed, const std::uint64_t stream) : Xoshiro256(splitmix64(seed) ^ stream) {}
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  /// @brief Draws 64 random bits.
+  /// @return The next output of the generator.
+  result_type operator()() {
+    const std::uint64_t result{rotl(s_[1] * 5, 7) * 9};
+    const std::uint64_t t{s_[1] << 17};
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = rotl(s_[3], 45);
+    return result;
+  }
+
+  /// @brief Draws a double uniformly distributed in [0, 1), from the 53 highest bits of the next output.
+  /// @return The value.
+  double uniform() { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; }
+
+  /// @brief Draws a double uniformly distributed in [lower, upper).
+  /// @param lower Is the lower boundary.
+  /// @param upper Is the upper boundary.
+  /// @return The value.
+  double uniform(const double lower, const double upper) { return lower + (upper - lower) * uniform(); }
+
+  /// @brief Draws an integer uniformly distributed in [0, n), without bias.
+  /// @param n Is the number of possible values, strictly positive.
+  /// @return The value.
+  std::uint64_t below(const std::uint64_t n) {
+    // the outputs below 2^64 mod n are rejected, leaving a multiple of n equally likely outputs
+    const std::uint64_t threshold{(0 - n) % n};
+    std::uint64_t r{(*this)()};
+    while (r < threshold) {
+      r = (*this)();
+    }
+    return r % n;
+  }
+};
+
+/// @brief Gets a seed from the clock, for runs that need not be reproduced.
+/// @return The seed, which should be reported so that the run can be repeated.
+inline std::uint64_t clockSeed() {
+  return static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+}
+}  // namespace rng
+
+#endif
@@ -0,0 +1,73 @@
+/// @file       ../include/simulation.hpp
+/// @brief      Defines the Simulation class.
+///
+/// @details    This file contains the definition of the Simulation class.
+///             A Simulation object advances a flock on a thread of its own, at a fixed rate, and publishes each new
+///             state of the birds as a Frame, which the render thread reads without ever blocking the simulation.
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+#include "../include/buffer.hpp"
+#include "../include/flock.hpp"
+#include "../include/storage.hpp"
+
+namespace simulation {
+
+/// @brief The Frame struct is a complete state of the birds of the flock.
+struct Frame {
+  ///@brief Are the positions and velocities of the bird::Boid objects.
+  storage::BirdArrays boids;
+
+  ///@brief Are the positions and velocities of the bird::Predator objects.
+  storage::BirdArrays predators;
+
+  ///@brief Is the number of steps the flock has been advanced by.
+  size_t step{0};
+};
+
+/// @brief The Simulation class advances a flock on its own thread.
+class Simulation {
+ private:
+  flock::Flock& flock_;
+
+  /// @brief Is the number of steps per second, 0 for as many as possible.
+  double rate_;
+
+  buffer::TripleBuffer<Frame> frames_;
+  std::atomic<bool> running_;
+
+  /// @brief Is the simulation thread, started last, once every other member is constructed.
+  std::thread thread_;
+
+  /// @brief Advances the flock and publishes its states until running_ is cleared.
+  void run();
+
+ public:
+  /// @brief Constructs a Simulation object, publishing the current state of the flock and starting the thread.
+  /// @param flock Is the flock to advance; until the Simulation object is destructed, no other thread may access it.
+  /// @param rate Is the number of steps per second, 0 for as many as possible.
+  Simulation(flock::Flock& flock, double rate);
+
+  Simulation(const Simulation&) = delete;
+  Simulation& operator=(const Simulation&) = delete;
+
+  /// @brief Destructs the Simulation object, stopping the thread after the current step.
+  ~Simulation();
+
+  /// @brief Takes the latest published frame, if it has not been taken yet.
+  /// @details Called by the render thread only.
+  /// @return true if frame() now refers to a new frame.
+  bool update();
+
+  /// @brief Gets the frame taken by the last call to update().
+  /// @details Called by the render thread only; the frame stays unchanged until the next call to update().
+  /// @return The frame.
+  [[nodiscard]] const Frame& frame() const;
+};
+}  // namespace simulation
+
+#endif
@@ -0,0 +1,105 @@
+/// @file       ../include/snapshot.hpp
+/// @brief      Defines the binary snapshot format of a flock.
+///
+/// @details    This file contains the definition of the Header struct, of the write function and of the
+///             MappedSnapshot class.
+///             A snapshot is a Header followed by the arrays x, y, vx, vy of the bird::Boid objects and then of the
+///             bird::Predator objects, all as native doubles, so that a mapped file can be read in place.
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "../include/storage.hpp"
+
+namespace snapshot {
+
+///@brief Identifies a snapshot file.
+inline constexpr char magic[8] = {'B', 'O', 'I', 'D', 'S', 'N', 'A', 'P'};
+
+///@brief Is the version of the format written by write(); files of other versions are rejected.
+/// @details Version 1 did not record the boundary and the size of the world, so that its files cannot be restored
+/// faithfully into a flock of other Parameters.
+inline constexpr std::uint32_t version = 2;
+
+/// @brief The Header struct is the beginning of a snapshot file.
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+
+  ///@brief Is the field-of-view test, as the value of flock::FieldOfView.
+  std::uint32_t field_of_view;
+
+  std::uint64_t n_boids;
+  std::uint64_t n_predators;
+
+  ///@brief Are the separation, alignment and cohesion coefficients.
+  double s;
+  double a;
+  double c;
+
+  double b_max_speed;
+  double p_max_speed;
+  double b_min_speed;
+  double p_min_speed;
+
+  ///@brief Is the boundary of the world, as the value of flock::Boundary.
+  std::uint32_t boundary;
+  std::uint32_t reserved;
+
+  ///@brief Are flock::Parameters::width and flock::Parameters::height.
+  double width;
+  double height;
+};
+
+/// @brief Writes a snapshot file.
+/// @details Throws std::runtime_error if the file cannot be written. magic, version, n_boids and n_predators of header
+/// are overwritten.
+/// @param path Is the path of the file.
+/// @param header Is the header, holding the parameters of the flock.
+/// @param boids Are the positions and velocities of the bird::Boid objects.
+/// @param predators Are the positions and velocities of the bird::Predator objects.
+void write(const std::string& path, Header header, const storage::BirdArrays& boids,
+           const storage::BirdArrays& predators);
+
+/// @brief The MappedSnapshot class maps a snapshot file into memory, read-only.
+/// @details The arrays are read in place from the mapping, without copies: a state of millions of birds is available
+/// as soon as its pages are touched.
+class MappedSnapshot {
+ private:
+  void* data_;
+  size_t size_;
+
+  /// @brief Gets the address of the k-th double following the header.
+  [[nodiscard]] const double* array(size_t k) const;
+
+ public:
+  /// @brief Constructs a MappedSnapshot object, mapping a file.
+  /// @details Throws std::runtime_error if the file cannot be mapped or is not a snapshot of the current version.
+  /// @param path Is the path of the file.
+  explicit MappedSnapshot(const std::string& path);
+
+  MappedSnapshot(const MappedSnapshot&) = delete;
+  MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+  /// @brief Destructs the MappedSnapshot object, unmapping the file.
+  ~MappedSnapshot();
+
+  /// @brief Gets the header of the file.
+  /// @return The header.
+  [[nodiscard]] const Header& header() const;
+
+  /// @brief Gets the arrays of the bird::Boid objects.
+  /// @return Pointers to x, y, vx and vy, of header().n_boids elements each.
+  [[nodiscard]] std::array<const double*, 4> boids() const;
+
+  /// @brief Gets the arrays of the bird::Predator objects.
+  /// @return Pointers to x, y, vx and vy, of header().n_predators elements each.
+  [[nodiscard]] std::array<const double*, 4> predators() const;
+};
+}  // namespace snapshot
+
+#endif
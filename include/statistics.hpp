@@ -3,9 +3,17 @@
 ///
 /// @details    This file contains the definition of Statistics struct.
 ///             A Statistics object contains all the relevant information for a statistical analysis of the flock.
+///             The file also defines the engine evaluating it, which offers an exact mode and a random-pair sampling
+///             mode for large flocks.
 #ifndef STATISTICS_HPP
 #define STATISTICS_HPP
 
+#include <cstddef>
+#include <cstdint>
+
+#include "../include/pool.hpp"
+#include "../include/storage.hpp"
+
 namespace statistics {
 struct Statistics {
   ///@brief Is the mean value of the distance between each couple of bird::Boid objects, at a fixed time.
@@ -20,18 +28,76 @@ struct Statistics {
   ///@brief Is the standard deviation associated with the mean speed of each bird::Boid object.
   double dev_speed;
 
+  ///@brief Is the standard error of mean_dist due to sampling, 0 when every couple has been taken into account.
+  double mean_dist_error;
+
   ///@brief Constructs a Statistics object.
   ///@details Each attribute is initialized to '0.'.
   Statistics();
 
   ///@brief Constructs a Statistics object.
-  ///@details Each attribute is initialized with the given parameters.
+  ///@details Each attribute is initialized with the given parameters, mean_dist_error with '0.'.
   ///@param m_dist Is the mean distance.
   ///@param d_dist Is the standard deviation associated with the mean distance.
   ///@param m_speed Is the mean speed.
   ///@param d_speed Is the standard deviation associated with the mean speed.
   Statistics(double m_dist, double d_dist, double m_speed, double d_speed);
 };
+
+/// @brief Identifies how the distance statistics are evaluated.
+enum class Mode {
+  ///@brief Every couple of birds is taken into account: O(N^2), split among the threads of a pool.
+  Exact,
+
+  ///@brief Random couples of birds are drawn until the standard error of the mean distance falls below a bound.
+  Sampled
+};
+
+/// @brief The Options struct selects the evaluation mode of the statistics and its parameters.
+struct Options {
+  ///@brief Is the evaluation mode of the distance statistics.
+  Mode mode;
+
+  ///@brief Is the target standard error of the mean distance, in pixels, used by Mode::Sampled.
+  double error_bound;
+
+  ///@brief Is the largest number of couples drawn by Mode::Sampled, whatever the error reached.
+  size_t max_pairs;
+
+  ///@brief Is the seed of the random draws of Mode::Sampled, so that an estimate can be reproduced.
+  std::uint64_t seed;
+
+  ///@brief Are the sides of a toroidal world, whose opposite edges are adjacent; 0 for a world without wrap-around.
+  /// The distance between two birds is then the one between their closest images, see torus::image(); the birds
+  /// must lie inside the world.
+  double period_x;
+  double period_y;
+
+  ///@brief Constructs an Options object selecting Mode::Exact, in a world without wrap-around.
+  Options();
+
+  ///@brief Constructs an Options object, in a world without wrap-around.
+  ///@param m Is the evaluation mode.
+  ///@param bound Is the target standard error of the mean distance, in pixels.
+  ///@param pairs Is the largest number of couples drawn.
+  ///@param s Is the seed of the random draws.
+  Options(Mode m, double bound, size_t pairs, std::uint64_t s);
+};
+
+///@brief Evaluates the statistics of a group of birds.
+///@details The speed statistics are always exact. In Mode::Exact the couples are split into a fixed number of blocks
+/// whose partial sums are added in order, so the result does not depend on the number of threads. In Mode::Sampled
+/// couples of distinct birds are drawn uniformly with replacement, in batches, until the standard error of the mean
+/// distance is below the bound or the budget of couples is exhausted: each draw is an unbiased estimate of the mean
+/// distance and of the mean squared distance over all couples. The sums are accumulated in double precision whatever
+/// the precision of the birds.
+///@tparam T Is the type of the components, float or double.
+///@param birds Are the birds, at least one.
+///@param options Selects the evaluation mode.
+///@param pool Is the pool splitting the work among threads, or nullptr for serial execution.
+///@return A Statistics object.
+template <typename T>
+Statistics evaluate(const storage::BasicBirdArrays<T>& birds, const Options& options, pool::ThreadPool* pool);
 }  // namespace statistics
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,109 @@
+/// @file       ../include/storage.hpp
+/// @brief      Defines the BasicBirdArrays struct template and the BirdArrays struct.
+///
+/// @details    This file contains the definition of the BasicBirdArrays struct template and of its double precision
+///             instance, the BirdArrays struct.
+///             A BasicBirdArrays object stores the positions and the velocities of a group of birds of the same
+///             species as a structure of arrays: each component lives in its own contiguous vector, indexed by the
+///             bird.
+#ifndef STORAGE_HPP
+#define STORAGE_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "../include/point.hpp"
+
+namespace storage {
+
+/// @brief The BasicBirdArrays struct template represents the state of a group of birds as a structure of arrays.
+/// @details It is instantiated for float and double only, in storage.cpp.
+/// @tparam T Is the type of the components.
+template <typename T>
+struct BasicBirdArrays {
+  ///@brief Are the x components of the positions.
+  std::vector<T> x;
+
+  ///@brief Are the y components of the positions.
+  std::vector<T> y;
+
+  ///@brief Are the x components of the velocities.
+  std::vector<T> vx;
+
+  ///@brief Are the y components of the velocities.
+  std::vector<T> vy;
+
+  ///@brief Gets the number of birds.
+  ///@return The number of birds.
+  [[nodiscard]] size_t size() const;
+
+  ///@brief Resizes every array to the given number of birds.
+  ///@param n Is the number of birds.
+  void resize(size_t n);
+
+  ///@brief Gets the position of a bird.
+  ///@param i Is the index of the bird.
+  ///@return The position of the i-th bird.
+  [[nodiscard]] point::BasicPoint<T> position(size_t i) const;
+
+  ///@brief Gets the velocity of a bird.
+  ///@param i Is the index of the bird.
+  ///@return The velocity of the i-th bird.
+  [[nodiscard]] point::BasicPoint<T> velocity(size_t i) const;
+
+  ///@brief Sets the position and the velocity of a bird.
+  ///@param i Is the index of the bird.
+  ///@param position Is the new position.
+  ///@param velocity Is the new velocity.
+  void set(size_t i, const point::BasicPoint<T>& position, const point::BasicPoint<T>& velocity);
+
+  ///@brief Appends a bird at the end of the arrays.
+  ///@param position Is the position of the new bird.
+  ///@param velocity Is the velocity of the new bird.
+  void push_back(const point::BasicPoint<T>& position, const point::BasicPoint<T>& velocity);
+};
+
+/// @brief The BirdArrays struct represents the state of a group of birds as a structure of arrays, in double precision.
+using BirdArrays = BasicBirdArrays<double>;
+
+/// @brief Copies the state of a group of birds into arrays of another precision.
+/// @details Each component is converted with static_cast; the copy is exact from float to double.
+/// @tparam To Is the type of the components of the copy.
+/// @tparam From Is the type of the components of the original.
+/// @param birds Is the original.
+/// @return The copy.
+template <typename To, typename From>
+BasicBirdArrays<To> convert(const BasicBirdArrays<From>& birds) {
+  BasicBirdArrays<To> copy;
+  copy.resize(birds.size());
+  for (size_t i = 0; i < birds.size(); ++i) {
+    copy.x[i] = static_cast<To>(birds.x[i]);
+    copy.y[i] = static_cast<To>(birds.y[i]);
+    copy.vx[i] = static_cast<To>(birds.vx[i]);
+    copy.vy[i] = static_cast<To>(birds.vy[i]);
+  }
+  return copy;
+}
+
+/// @brief Copies the state of a group of birds into arrays of another precision, in the order of their ids.
+/// @details Same as the overload above, the bird at index k being copied to index ids[k].
+/// @tparam To Is the type of the components of the copy.
+/// @tparam From Is the type of the components of the original.
+/// @param birds Is the original.
+/// @param ids Is the id of each bird, a permutation of 0, ..., birds.size() - 1.
+/// @return The copy.
+template <typename To, typename From>
+BasicBirdArrays<To> convert(const BasicBirdArrays<From>& birds, const std::vector<size_t>& ids) {
+  BasicBirdArrays<To> copy;
+  copy.resize(birds.size());
+  for (size_t i = 0; i < birds.size(); ++i) {
+    copy.x[ids[i]] = static_cast<To>(birds.x[i]);
+    copy.y[ids[i]] = static_cast<To>(birds.y[i]);
+    copy.vx[ids[i]] = static_cast<To>(birds.vx[i]);
+    copy.vy[ids[i]] = static_cast<To>(birds.vy[i]);
+  }
+  return copy;
+}
+}  // namespace storage
+
+#endif
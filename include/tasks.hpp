@@ -0,0 +1,83 @@
+/// @file       ../include/tasks.hpp
+/// @brief      Defines the Task struct and the functions listing and resuming the runs of a sweep.
+///
+/// @details    This file contains the definition of the Task struct, one configuration of a sweep over the
+///             separation, alignment and cohesion coefficients, and of the functions parsing the lists of
+///             coefficients, listing the configurations and reading the rows of an interrupted sweep.
+///             The output file of a sweep starts with a comment line recording the settings shared by its runs,
+///             followed by the names of the columns and by one row per run; a sweep resumes only the files written
+///             with its own settings.
+#ifndef TASKS_HPP
+#define TASKS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../include/config.hpp"
+#include "../include/statistics.hpp"
+
+namespace tasks {
+
+/// @brief Is the line naming the columns of the output of a sweep.
+inline constexpr const char* columns{
+    "index,separation,alignment,cohesion,repeat,seed,mean_dist,dev_dist,mean_speed,dev_speed,mean_dist_error,"
+    "seconds"};
+
+/// @brief Is one configuration of the grid, run on a flock of its own.
+struct Task {
+  size_t index;
+  double s;
+  double a;
+  double c;
+  size_t repeat;
+  std::uint64_t seed;
+};
+
+/// @brief Parses a list of values, either 'x,y,z' or 'first:last:count' for count values evenly spaced.
+/// @details Throws std::domain_error, naming the key, if the list is empty or a value is not valid, see
+/// config::toDouble() and config::toSize().
+/// @param key Is the name of the option, for the error messages.
+/// @param value Is the list, as text.
+/// @return The values of the list.
+std::vector<double> toValues(const std::string& key, const std::string& value);
+
+/// @brief Lists the configurations of the grid, the repeats of a configuration being consecutive.
+/// @param separation Are the separation coefficients.
+/// @param alignment Are the alignment coefficients.
+/// @param cohesion Are the cohesion coefficients.
+/// @param repeats Is the number of runs of each configuration.
+/// @param first_seed Is the seed of the first run of each configuration, the next ones taking the following seeds.
+/// @return The configurations, indexed in order.
+std::vector<Task> makeTasks(const std::vector<double>& separation, const std::vector<double>& alignment,
+                            const std::vector<double>& cohesion, size_t repeats, std::uint64_t first_seed);
+
+/// @brief Formats the columns of a row identifying its configuration.
+/// @param task Is the configuration.
+/// @return The index, s, a, c, repeat and seed of the task, separated by commas.
+std::string describe(const Task& task);
+
+/// @brief Formats the comment line recording the settings shared by the runs of a sweep.
+/// @details Every setting that changes the rows is recorded, at full precision: the number of steps, of boids and
+/// of predators, every value of flock::Parameters, the field of view, the distribution, the skin, the reorder period
+/// and the statistics options.
+/// @param settings Are the settings of the sweep, whose unset numbers of birds take the defaults of the sweep.
+/// @param steps Is the number of steps of each run.
+/// @param stats Are the statistics options of each run.
+/// @return The line, starting with '#' and without the newline.
+std::string describe(const config::Config& settings, size_t steps, const statistics::Options& stats);
+
+/// @brief Reads the rows of a previous run of the same sweep.
+/// @details A last row cut by an interruption is removed from the file, and a file cut before the end of its two
+/// first lines is emptied. Throws std::runtime_error if the file was written with other settings or over another
+/// grid.
+/// @param path Is the path of the output file; a missing file has no rows.
+/// @param settings Is the settings line of the sweep, see describe(const config::Config&, size_t, const
+/// statistics::Options&).
+/// @param tasks Are the configurations of the sweep.
+/// @return Whether each task already has its row.
+std::vector<bool> readDone(const std::string& path, const std::string& settings, const std::vector<Task>& tasks);
+}  // namespace tasks
+
+#endif
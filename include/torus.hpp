@@ -0,0 +1,37 @@
+/// @file       ../include/torus.hpp
+/// @brief      Defines the functions of distances in a toroidal world.
+///
+/// @details    This file contains the minimum-image convention shared by the neighbour search of flock::BasicFlock
+///             and by the distance statistics: in a world whose opposite edges are adjacent, the difference between
+///             two coordinates is the one between the closest images of the two points.
+#ifndef TORUS_HPP
+#define TORUS_HPP
+
+#include <cassert>
+#include <cmath>
+
+namespace torus {
+
+/// @brief Evaluates the difference of two coordinates between the closest images of two points.
+/// @details Precondition: both coordinates lie in the same interval of length period, such as the world in which
+/// flock::BasicFlock wraps the birds, so that the difference lies in [-period, period] and adding or removing a single
+/// period reduces it; this takes one or two comparisons where a difference of any size would need a rounding.
+/// @param delta Is the difference of the coordinates.
+/// @param period Is the side of the world along the axis, 0 if it does not wrap around.
+/// @return The difference, reduced to [-period / 2, period / 2] if period is positive.
+template <typename T>
+T image(const T delta, const T period) {
+  if (period > 0) {
+    assert(std::abs(delta) <= period && "the coordinates must lie in the world");
+    if (delta > period / 2) {
+      return delta - period;
+    }
+    if (delta < -period / 2) {
+      return delta + period;
+    }
+  }
+  return delta;
+}
+}  // namespace torus
+
+#endif
@@ -5,6 +5,7 @@
 
 #include "../include/bird.hpp"
 #include "../include/flock.hpp"
+#include "../include/storage.hpp"
 
 namespace triangles {
 
@@ -27,7 +28,8 @@ inline const std::array<sf::Vector2f, 6> relative_position = {
 /// @param flock Is the vector of birds.
 /// @param triangles Is an array containing three sf::Vertex for each bird in the flock, those constitute a
 /// sf::Triangle.
-void createTriangles(const flock::Flock& flock, sf::VertexArray& triangles);
+template <typename T>
+void createTriangles(const flock::BasicFlock<T>& flock, sf::VertexArray& triangles);
 
 /// @brief Updates the direction of the triangle.
 /// @details Rotates the triangle associated with the bird, according to the direction of the bird's velocity.
@@ -38,8 +40,33 @@ void createTriangles(const flock::Flock& flock, sf::VertexArray& triangles);
 /// @param i Is the index associated with the position of the bird in the flock.
 /// @param is_boid Is a boolean constant which states whether the current bird is a bird::Boid or a bird::Predator.
 /// @param nBoids Is the number of bird::Boid objects in the flock.
-void rotateTriangle(const point::Point& target_position, sf::VertexArray& triangles, double theta, size_t i,
+template <typename T>
+void rotateTriangle(const point::BasicPoint<T>& target_position, sf::VertexArray& triangles, double theta, size_t i,
                     bool is_boid, size_t nBoids);
+
+/// @brief Updates the direction of the triangles associated with a range of birds, in one pass.
+/// @details Same result as rotateTriangle() with the angle of each bird's velocity, up to rounding: the sine and the
+/// cosine of the angle are read from the normalized velocity instead of being evaluated for each vertex, and the
+/// vertices of several birds are evaluated together with AVX or SSE2 instructions when the target supports them and T
+/// is double.
+/// @tparam T Is the type of the components, float or double.
+/// @param birds Are the positions and velocities of either the bird::Boid or the bird::Predator objects of the flock.
+/// @param is_boid States whether birds are bird::Boid objects or bird::Predator objects.
+/// @param nBoids Is the number of bird::Boid objects in the flock.
+/// @param triangles Is an array containing three sf::Vertex for each bird in the flock, those constitute a
+/// sf::Triangle.
+/// @param begin Is the index of the first bird of the range.
+/// @param end Is the index past the last bird of the range.
+template <typename T>
+void rotateTriangles(const storage::BasicBirdArrays<T>& birds, bool is_boid, size_t nBoids, sf::VertexArray& triangles,
+                     size_t begin, size_t end);
+
+/// @brief Updates the direction of every triangle of the flock, see rotateTriangles().
+/// @param flock Is the flock.
+/// @param triangles Is an array containing three sf::Vertex for each bird in the flock, those constitute a
+/// sf::Triangle.
+template <typename T>
+void updateTriangles(const flock::BasicFlock<T>& flock, sf::VertexArray& triangles);
 }  // namespace triangles
 
 #endif  // TRIANGLE_HPP
@@ -0,0 +1,239 @@
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/config.hpp"
+#include "../include/flock.hpp"
+#include "../include/statistics.hpp"
+#include "../include/triangle.hpp"
+
+namespace {
+
+/// @brief Collects the options of a benchmark run.
+struct Options {
+  std::vector<size_t> sizes{100, 1000, 10000, 100000};
+  std::vector<double> ratios{0., 0.01};
+  size_t threads{std::thread::hardware_concurrency()};
+  double min_time{0.2};
+  std::uint64_t seed{1};
+  ///@brief States whether the birds are simulated in single precision.
+  bool single{false};
+  std::string output;
+};
+
+/// @brief Is the time taken by a kernel.
+struct Timing {
+  ///@brief Is the number of passes over the whole flock that were timed.
+  size_t runs;
+
+  ///@brief Is the total time of the passes, in seconds.
+  double seconds;
+};
+
+void printUsage(std::ostream& out) {
+  out << "Usage: Boids.bench [options]\n"
+      << "  --sizes N,N,...   total numbers of birds to time (default 100,1000,10000,100000)\n"
+      << "  --ratios R,R,...  fractions of the birds that are predators (default 0,0.01)\n"
+      << "  --threads T       number of threads of evolve and statistics (default: all hardware threads)\n"
+      << "  --min-time S      time each kernel for at least S seconds (default 0.2)\n"
+      << "  --seed S          seed of the generated flocks, the same for every run (default 1)\n"
+      << "  --precision P     'single' or 'double' precision of the simulation (default double)\n"
+      << "  --output FILE     write the results to FILE instead of the standard output\n";
+}
+
+template <typename T, typename Convert>
+std::vector<T> toList(const std::string& value, Convert&& convert) {
+  std::vector<T> list;
+  std::istringstream in(value);
+  for (std::string item; std::getline(in, item, ',');) {
+    list.push_back(convert(item));
+  }
+  if (list.empty()) {
+    throw std::domain_error("Error: '" + value + "' is an empty list.");
+  }
+  return list;
+}
+
+Options parseOptions(const int argc, char* argv[]) {
+  Options options;
+  for (int k = 1; k < argc; ++k) {
+    const std::string flag{argv[k]};
+    if (flag == "--help" || flag == "-h") {
+      printUsage(std::cout);
+      std::exit(EXIT_SUCCESS);
+    }
+    if (k + 1 == argc) {
+      throw std::domain_error("Error: missing value for option " + flag + ".");
+    }
+    const std::string value{argv[++k]};
+
+    if (flag == "--sizes") {
+      options.sizes =
+          toList<size_t>(value, [&flag](const std::string& item) { return config::toSize(flag, item); });
+    } else if (flag == "--ratios") {
+      options.ratios =
+          toList<double>(value, [&flag](const std::string& item) { return config::toDouble(flag, item); });
+    } else if (flag == "--threads") {
+      options.threads = config::toSize(flag, value);
+    } else if (flag == "--min-time") {
+      options.min_time = config::toDouble(flag, value);
+    } else if (flag == "--seed") {
+      options.seed = config::toSize(flag, value);
+    } else if (flag == "--precision") {
+      if (value != "single" && value != "double") {
+        throw std::domain_error("Error: unknown precision " + value + ".");
+      }
+      options.single = value == "single";
+    } else if (flag == "--output") {
+      options.output = value;
+    } else {
+      throw std::domain_error("Error: unknown option " + flag + ".");
+    }
+  }
+
+  for (const double ratio : options.ratios) {
+    if (!(ratio >= 0. && ratio < 1.)) {
+      throw std::domain_error("Error: the predator ratios must lie in [0, 1).");
+    }
+  }
+  return options;
+}
+
+/// @brief Repeats a pass over the flock until at least min_time seconds have elapsed.
+/// @param min_time Is the least time to spend, in seconds.
+/// @param pass Is the timed pass.
+/// @return The number of passes and their total time.
+template <typename Pass>
+Timing measure(const double min_time, Pass&& pass) {
+  Timing timing{0, 0.};
+  const auto start = std::chrono::steady_clock::now();
+  do {
+    pass();
+    ++timing.runs;
+    timing.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  } while (timing.seconds < min_time);
+  return timing;
+}
+
+/// @brief Calls visit(i, is_boid) for each bird in the flock, boids first.
+template <typename T, typename Visitor>
+void forEachBird(const flock::BasicFlock<T>& flock, Visitor&& visit) {
+  for (size_t i = 0; i < flock.getBoidsNum(); ++i) {
+    visit(i, true);
+  }
+  for (size_t i = 0; i < flock.getPredatorsNum(); ++i) {
+    visit(i, false);
+  }
+}
+
+template <typename T>
+void writeRow(std::ostream& out, const std::string& kernel, const flock::BasicFlock<T>& flock, const Timing& timing) {
+  const double birds_steps{static_cast<double>(flock.getFlockSize()) * static_cast<double>(timing.runs)};
+  out << kernel << ',' << flock.getBoidsNum() << ',' << flock.getPredatorsNum() << ',' << flock.getThreads() << ','
+      << timing.runs << ',' << timing.seconds * 1e9 / birds_steps << ','
+      << static_cast<double>(timing.runs) / timing.seconds << std::endl;
+}
+
+template <typename T>
+void benchmark(std::ostream& out, const Options& options, const size_t n_birds, const double ratio) {
+  const auto n_predators = static_cast<size_t>(std::lround(ratio * static_cast<double>(n_birds)));
+  if (n_birds <= n_predators) {
+    return;
+  }
+
+  flock::BasicFlock<T> flock(n_birds - n_predators, n_predators);
+  flock.setThreads(options.threads);
+  flock.generateBirds(options.seed);
+
+  sf::VertexArray triangles(sf::Triangles, 3 * flock.getFlockSize());
+  triangles::createTriangles(flock, triangles);
+
+  // the birds spread out from the generation area during the first steps: time a settled flock
+  for (size_t step = 0; step < 10; ++step) {
+    flock.evolve(triangles);
+  }
+
+  std::vector<size_t> near;
+  writeRow(out, "findNearBoids", flock, measure(options.min_time, [&] {
+             forEachBird(flock, [&](const size_t i, const bool is_boid) { flock.findNearBoids(i, is_boid, near); });
+           }));
+
+  flock::BasicNeighbours<T> neighbours;
+  writeRow(out, "updateBird", flock, measure(options.min_time, [&] {
+             forEachBird(flock, [&](const size_t i, const bool is_boid) {
+               static_cast<void>(flock.updateBird(triangles, i, is_boid, neighbours));
+             });
+           }));
+
+  flock.setKernel(flock::Kernel::Composed);
+  writeRow(out, "updateBird.composed", flock, measure(options.min_time, [&] {
+             forEachBird(flock, [&](const size_t i, const bool is_boid) {
+               static_cast<void>(flock.updateBird(triangles, i, is_boid, neighbours));
+             });
+           }));
+  flock.setKernel(flock::Kernel::Fused);
+
+  writeRow(out, "rotateTriangle", flock, measure(options.min_time, [&] {
+             forEachBird(flock, [&](const size_t i, const bool is_boid) {
+               const storage::BasicBirdArrays<T>& birds = is_boid ? flock.getBoidArrays() : flock.getPredatorArrays();
+               triangles::rotateTriangle(birds.position(i), triangles, birds.velocity(i).angle(), i, is_boid,
+                                         flock.getBoidsNum());
+             });
+           }));
+
+  writeRow(out, "rotateTriangles", flock,
+           measure(options.min_time, [&] { triangles::updateTriangles(flock, triangles); }));
+
+  writeRow(out, "evolve", flock, measure(options.min_time, [&] { flock.evolve(triangles); }));
+
+  writeRow(out, "statistics", flock,
+           measure(options.min_time, [&] { static_cast<void>(flock.statistics()); }));
+
+  const statistics::Options sampled(statistics::Mode::Sampled, 1., 1'000'000, 0);
+  writeRow(out, "statistics.sampled", flock,
+           measure(options.min_time, [&] { static_cast<void>(flock.statistics(sampled)); }));
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  try {
+    options = parseOptions(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n\n";
+    printUsage(std::cerr);
+    return EXIT_FAILURE;
+  }
+
+  std::ofstream file;
+  if (!options.output.empty()) {
+    file.open(options.output);
+    if (!file) {
+      std::cerr << "Error: cannot open " << options.output << " for writing.\n";
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream& out = options.output.empty() ? std::cout : file;
+
+  // one pass times each bird once: ns_per_bird_step is the cost of a bird, steps_per_s the rate of whole passes
+  out << std::setprecision(6) << "kernel,boids,predators,threads,runs,ns_per_bird_step,steps_per_s\n";
+  for (const size_t n_birds : options.sizes) {
+    for (const double ratio : options.ratios) {
+      if (options.single) {
+        benchmark<float>(out, options, n_birds, ratio);
+      } else {
+        benchmark<double>(out, options, n_birds, ratio);
+      }
+    }
+  }
+}
@@ -3,56 +3,93 @@
 #include <cassert>
 #include <memory>
 #include <numeric>
+#include <type_traits>
 #include <vector>
 
 #include "../include/graphic.hpp"
 #include "../include/point.hpp"
+#include "../include/storage.hpp"
 
 namespace bird {
 //----------------------------------------------------------------------------------------------------------------------
 // ---Implementation of Bird class--------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
-Bird::Bird(point::Point const& position, point::Point const& velocity) : position_(position), velocity_(velocity) {}
+template <typename T>
+BasicBird<T>::BasicBird(point::BasicPoint<T> const& position, point::BasicPoint<T> const& velocity)
+    : position_(position), velocity_(velocity) {}
 
-point::Point Bird::getPosition() const { return position_; }
-point::Point Bird::getVelocity() const { return velocity_; }
+template <typename T>
+point::BasicPoint<T> BasicBird<T>::getPosition() const {
+  return position_;
+}
+template <typename T>
+point::BasicPoint<T> BasicBird<T>::getVelocity() const {
+  return velocity_;
+}
 
-void Bird::setBird(const point::Point position, const point::Point velocity) {
+template <typename T>
+void BasicBird<T>::setBird(const point::BasicPoint<T> position, const point::BasicPoint<T> velocity) {
   position_ = position;
   velocity_ = velocity;
 }
 
-point::Point Bird::separation(const double s, const double ds, const std::vector<std::shared_ptr<Bird>>& near) const {
+template <typename T>
+point::BasicPoint<T> BasicBird<T>::separation(const double s, const double ds,
+                                              const std::vector<std::shared_ptr<BasicBird<T>>>& near) const {
+  assert(s >= 0 && s <= 1);
+  assert(ds > 0);
+  const point::BasicPoint<T> sum =
+      std::accumulate(near.begin(), near.end(), point::BasicPoint<T>(),
+                      [this, ds](point::BasicPoint<T> acc, const std::shared_ptr<BasicBird<T>>& boid) {
+                        if (boid->getPosition().distance(position_) < ds) {
+                          acc += boid->getPosition() - position_;
+                        }
+                        return acc;
+                      });
+  return -s * sum;
+}
+
+template <typename T>
+point::BasicPoint<T> BasicBird<T>::separation(const double s, const double ds, const std::vector<size_t>& near,
+                                              const storage::BasicBirdArrays<T>& birds) const {
   assert(s >= 0 && s <= 1);
   assert(ds > 0);
-  const point::Point sum = std::accumulate(near.begin(), near.end(), point::Point(0., 0.),
-                                           [this, ds](point::Point acc, const std::shared_ptr<Bird>& boid) {
-                                             if (boid->getPosition().distance(position_) < ds) {
-                                               acc += boid->getPosition() - position_;
-                                             }
-                                             return acc;
-                                           });
+  const point::BasicPoint<T> sum = std::accumulate(near.begin(), near.end(), point::BasicPoint<T>(),
+                                                   [this, ds, &birds](point::BasicPoint<T> acc, const size_t j) {
+                                                     if (birds.position(j).distance(position_) < ds) {
+                                                       acc += birds.position(j) - position_;
+                                                     }
+                                                     return acc;
+                                                   });
   return -s * sum;
 }
 
-point::Point Bird::border(const double margin, const double turn_factor) const {
-  assert(margin > 0 && margin < graphic_par::stats_width && margin <= graphic_par::window_height);
+template <typename T>
+point::BasicPoint<T> BasicBird<T>::border(const double margin, const double turn_factor) const {
+  return border(margin, turn_factor, graphic_par::window_width, graphic_par::window_height);
+}
+
+template <typename T>
+point::BasicPoint<T> BasicBird<T>::border(const double margin, const double turn_factor, const double width,
+                                          const double height) const {
+  assert(margin > 0 && 2 * margin < width - graphic_par::stats_width && 2 * margin < height);
   assert(turn_factor > 0);
 
-  double v4_x{velocity_.getX()};
-  double v4_y{velocity_.getY()};
+  const T turn{static_cast<T>(turn_factor)};
+  T v4_x{velocity_.getX()};
+  T v4_y{velocity_.getY()};
 
   if (position_.getX() < graphic_par::stats_width + margin) {
-    v4_x += turn_factor;
+    v4_x += turn;
   }
-  if (position_.getX() > graphic_par::window_width - margin) {
-    v4_x -= turn_factor;
+  if (position_.getX() > width - margin) {
+    v4_x -= turn;
   }
   if (position_.getY() < margin) {
-    v4_y += turn_factor;
+    v4_y += turn;
   }
-  if (position_.getY() > graphic_par::window_height - margin) {
-    v4_y -= turn_factor;
+  if (position_.getY() > height - margin) {
+    v4_y -= turn;
   }
   return {v4_x, v4_y};
 }
@@ -61,77 +98,123 @@ point::Point Bird::border(const double margin, const double turn_factor) const {
 // ---Implementation of Boid class--------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
 
-Boid::Boid() : Bird() {}
-Boid::Boid(point::Point const& pos, point::Point const& vel) : Bird(pos, vel) {}
+template <typename T>
+BasicBoid<T>::BasicBoid() : BasicBird<T>() {}
+template <typename T>
+BasicBoid<T>::BasicBoid(point::BasicPoint<T> const& pos, point::BasicPoint<T> const& vel) : BasicBird<T>(pos, vel) {}
 
-point::Point Boid::alignment(const double a, const std::vector<std::shared_ptr<Bird>>& near_boids) const {
+template <typename T>
+point::BasicPoint<T> BasicBoid<T>::alignment(const double a,
+                                             const std::vector<std::shared_ptr<BasicBird<T>>>& near_boids) const {
   assert(a >= 0 && a <= 1);
-  const point::Point sum = std::accumulate(
-      near_boids.begin(), near_boids.end(), point::Point(0., 0.),
-      [](const point::Point acc, const std::shared_ptr<Bird>& boid) { return acc + boid->getVelocity(); });
-  return a * (sum / static_cast<double>(near_boids.size()) - velocity_);
+  const point::BasicPoint<T> sum = std::accumulate(
+      near_boids.begin(), near_boids.end(), point::BasicPoint<T>(),
+      [](const point::BasicPoint<T> acc, const std::shared_ptr<BasicBird<T>>& boid) {
+        return acc + boid->getVelocity();
+      });
+  return a * (sum / static_cast<double>(near_boids.size()) - this->velocity_);
 }
 
-point::Point Boid::cohesion(const double c, const std::vector<std::shared_ptr<Bird>>& near_boids) const {
-  assert(c >= 0 && c <= 1);
-  const point::Point sum = std::accumulate(
-      near_boids.begin(), near_boids.end(), point::Point(0., 0.),
-      [](const point::Point acc, const std::shared_ptr<Bird>& boid) { return acc + boid->getPosition(); });
-  return c * (sum / static_cast<double>(near_boids.size()) - position_);
+template <typename T>
+point::BasicPoint<T> BasicBoid<T>::alignment(const double a, const std::vector<size_t>& near_boids,
+                                             const storage::BasicBirdArrays<T>& boids) const {
+  assert(a >= 0 && a <= 1);
+  const point::BasicPoint<T> sum =
+      std::accumulate(near_boids.begin(), near_boids.end(), point::BasicPoint<T>(),
+                      [&boids](const point::BasicPoint<T> acc, const size_t j) { return acc + boids.velocity(j); });
+  return a * (sum / static_cast<double>(near_boids.size()) - this->velocity_);
 }
 
-point::Point Boid::repel(const double r, const std::vector<std::shared_ptr<Bird>>& near_predators) const {
-  assert(r >= 0);
-  const point::Point sum = std::accumulate(
-      near_predators.begin(), near_predators.end(), point::Point(0., 0.),
-      [this](point::Point acc, const std::shared_ptr<Bird>& boid) { return acc += boid->getPosition() - position_; });
-  return -r * sum;
+template <typename T>
+point::BasicPoint<T> BasicBoid<T>::cohesion(const double c,
+                                            const std::vector<std::shared_ptr<BasicBird<T>>>& near_boids) const {
+  assert(c >= 0 && c <= 1);
+  const point::BasicPoint<T> sum = std::accumulate(
+      near_boids.begin(), near_boids.end(), point::BasicPoint<T>(),
+      [](const point::BasicPoint<T> acc, const std::shared_ptr<BasicBird<T>>& boid) {
+        return acc + boid->getPosition();
+      });
+  return c * (sum / static_cast<double>(near_boids.size()) - this->position_);
 }
 
-void Boid::friction(const double b_max_speed, point::Point& velocity) {
-  assert(velocity.module() != 0);
-  assert(b_max_speed > 0);
-  if (velocity.module() > b_max_speed) {
-    velocity = b_max_speed * (velocity / velocity.module());
-  }
+template <typename T>
+point::BasicPoint<T> BasicBoid<T>::cohesion(const double c, const std::vector<size_t>& near_boids,
+                                            const storage::BasicBirdArrays<T>& boids) const {
+  assert(c >= 0 && c <= 1);
+  const point::BasicPoint<T> sum =
+      std::accumulate(near_boids.begin(), near_boids.end(), point::BasicPoint<T>(),
+                      [&boids](const point::BasicPoint<T> acc, const size_t j) { return acc + boids.position(j); });
+  return c * (sum / static_cast<double>(near_boids.size()) - this->position_);
 }
 
-void Boid::boost(const double b_min_speed, point::Point& velocity) {
-  assert(velocity.module() != 0);
-  assert(b_min_speed > 0);
+template <typename T>
+point::BasicPoint<T> BasicBoid<T>::repel(const double r,
+                                         const std::vector<std::shared_ptr<BasicBird<T>>>& near_predators) const {
+  assert(r >= 0);
+  const point::BasicPoint<T> sum = std::accumulate(
+      near_predators.begin(), near_predators.end(), point::BasicPoint<T>(),
+      [this](point::BasicPoint<T> acc, const std::shared_ptr<BasicBird<T>>& boid) {
+        return acc += boid->getPosition() - this->position_;
+      });
+  return -r * sum;
+}
 
-  if (velocity.module() < b_min_speed) {
-    velocity = b_min_speed * (velocity / velocity.module());
-  }
+template <typename T>
+point::BasicPoint<T> BasicBoid<T>::repel(const double r, const std::vector<size_t>& near_predators,
+                                         const storage::BasicBirdArrays<T>& predators) const {
+  assert(r >= 0);
+  const point::BasicPoint<T> sum = std::accumulate(
+      near_predators.begin(), near_predators.end(), point::BasicPoint<T>(),
+      [this, &predators](point::BasicPoint<T> acc, const size_t j) {
+        return acc += predators.position(j) - this->position_;
+      });
+  return -r * sum;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 // ---Implementation of Predator class----------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
 
-Predator::Predator() : Bird() {}
-Predator::Predator(point::Point const& pos, point::Point const& vel) : Bird(pos, vel) {}
+template <typename T>
+BasicPredator<T>::BasicPredator() : BasicBird<T>() {}
+template <typename T>
+BasicPredator<T>::BasicPredator(point::BasicPoint<T> const& pos, point::BasicPoint<T> const& vel)
+    : BasicBird<T>(pos, vel) {}
 
-point::Point Predator::chase(const double ch, const std::vector<std::shared_ptr<Bird>>& near_boids) const {
+template <typename T>
+point::BasicPoint<T> BasicPredator<T>::chase(const double ch,
+                                             const std::vector<std::shared_ptr<BasicBird<T>>>& near_boids) const {
   assert(ch >= 0 && ch <= 1);
-  const point::Point sum = std::accumulate(
-      near_boids.begin(), near_boids.end(), point::Point(0., 0.),
-      [](const point::Point acc, const std::shared_ptr<Bird>& boid) { return acc + boid->getPosition(); });
+  const point::BasicPoint<T> sum = std::accumulate(
+      near_boids.begin(), near_boids.end(), point::BasicPoint<T>(),
+      [](const point::BasicPoint<T> acc, const std::shared_ptr<BasicBird<T>>& boid) {
+        return acc + boid->getPosition();
+      });
 
-  return ch * (sum / static_cast<double>(near_boids.size()) - position_);
+  return ch * (sum / static_cast<double>(near_boids.size()) - this->position_);
 }
-void Predator::friction(const double p_max_speed, point::Point& velocity) {
-  assert(p_max_speed > 0);
-  assert(velocity.module() != 0);
-  if (velocity.module() > p_max_speed) {
-    velocity = p_max_speed * (velocity / velocity.module());
-  }
-}
-void Predator::boost(const double p_min_speed, point::Point& velocity) {
-  assert(velocity.module() != 0);
-  assert(p_min_speed > 0);
-  if (velocity.module() < p_min_speed) {
-    velocity = p_min_speed * (velocity / velocity.module());
-  }
+
+template <typename T>
+point::BasicPoint<T> BasicPredator<T>::chase(const double ch, const std::vector<size_t>& near_boids,
+                                             const storage::BasicBirdArrays<T>& boids) const {
+  assert(ch >= 0 && ch <= 1);
+  const point::BasicPoint<T> sum =
+      std::accumulate(near_boids.begin(), near_boids.end(), point::BasicPoint<T>(),
+                      [&boids](const point::BasicPoint<T> acc, const size_t j) { return acc + boids.position(j); });
+
+  return ch * (sum / static_cast<double>(near_boids.size()) - this->position_);
 }
+
+// a bird is a plain record of its position and velocity
+static_assert(std::is_trivially_copyable_v<Bird> && std::is_trivially_copyable_v<Boid> &&
+              std::is_trivially_copyable_v<Predator>);
+static_assert(sizeof(Bird) == 32 && sizeof(Boid) == 32 && sizeof(Predator) == 32);
+
+// the only precisions of the simulation
+template class BasicBird<float>;
+template class BasicBird<double>;
+template class BasicBoid<float>;
+template class BasicBoid<double>;
+template class BasicPredator<float>;
+template class BasicPredator<double>;
 }  // namespace bird
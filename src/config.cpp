@@ -0,0 +1,272 @@
+#include "../include/config.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "../include/flock.hpp"
+#include "../include/statistics.hpp"
+
+namespace config {
+
+namespace {
+
+bool toBool(const std::string& key, const std::string& value) {
+  if (value == "true" || value == "yes" || value == "1") {
+    return true;
+  }
+  if (value == "false" || value == "no" || value == "0") {
+    return false;
+  }
+  throw std::domain_error("Error: " + key + " must be true or false, not '" + value + "'.");
+}
+
+double toRadians(const std::string& key, const std::string& value) { return toDouble(key, value) * M_PI / 180.; }
+
+std::string trim(const std::string& text) {
+  const size_t begin{text.find_first_not_of(" \t\r")};
+  if (begin == std::string::npos) {
+    return {};
+  }
+  const size_t end{text.find_last_not_of(" \t\r")};
+  return text.substr(begin, end - begin + 1);
+}
+}  // namespace
+
+size_t toSize(const std::string& key, const std::string& value) {
+  // std::stoull takes the whole range of a seed, but reads '-1' as its largest value
+  const size_t first{value.find_first_not_of(" \t\n\v\f\r")};
+  size_t end{0};
+  unsigned long long parsed{0};
+  if (first != std::string::npos && value[first] != '-') {
+    try {
+      parsed = std::stoull(value, &end);
+    } catch (const std::exception&) {
+      end = 0;
+    }
+  }
+  if (end == 0 || end != value.size() || parsed > std::numeric_limits<size_t>::max()) {
+    throw std::domain_error("Error: " + key + " must be a non-negative integer, not '" + value + "'.");
+  }
+  return static_cast<size_t>(parsed);
+}
+
+double toDouble(const std::string& key, const std::string& value) {
+  size_t end{0};
+  double parsed{0.};
+  try {
+    parsed = std::stod(value, &end);
+  } catch (const std::exception&) {
+    end = 0;
+  }
+  if (end != value.size() || !std::isfinite(parsed)) {
+    throw std::domain_error("Error: " + key + " must be a number, not '" + value + "'.");
+  }
+  return parsed;
+}
+
+Config::Config()
+    : distribution{flock::Distribution::Uniform}, field_of_view{flock::FieldOfView::Angle},
+      threads{std::thread::hardware_concurrency()}, skin{0.}, reorder_every{0}, steps_per_second{60.},
+      prefer_gpu{true} {}
+
+bool Config::hasFlightParams() const { return s.has_value() || a.has_value() || c.has_value(); }
+
+void set(Config& config, const std::string& name, const std::string& value) {
+  flock::Parameters& params = config.parameters;
+  // boid-sight-angle and boid_sight_angle are the same key
+  std::string key{name};
+  std::replace(key.begin(), key.end(), '-', '_');
+
+  if (key == "boids") {
+    config.n_boids = toSize(key, value);
+    if (*config.n_boids == 0) {
+      throw std::domain_error("Error: the number of boids must be strictly positive.");
+    }
+  } else if (key == "predators") {
+    config.n_predators = toSize(key, value);
+  } else if (key == "separation") {
+    config.s = toDouble(key, value);
+  } else if (key == "alignment") {
+    config.a = toDouble(key, value);
+  } else if (key == "cohesion") {
+    config.c = toDouble(key, value);
+  } else if (key == "distance") {
+    params.d = toDouble(key, value);
+  } else if (key == "boid_separation") {
+    params.b_ds = toDouble(key, value);
+  } else if (key == "predator_separation") {
+    params.p_ds = toDouble(key, value);
+  } else if (key == "boid_sight_angle") {
+    params.b_sight_angle = toRadians(key, value);
+  } else if (key == "predator_sight_angle") {
+    params.p_sight_angle = toRadians(key, value);
+  } else if (key == "margin") {
+    params.margin = toDouble(key, value);
+  } else if (key == "turn_factor") {
+    params.turn_factor = toDouble(key, value);
+  } else if (key == "boid_max_speed") {
+    params.b_max_speed = toDouble(key, value);
+  } else if (key == "boid_min_speed") {
+    params.b_min_speed = toDouble(key, value);
+  } else if (key == "predator_max_speed") {
+    params.p_max_speed = toDouble(key, value);
+  } else if (key == "predator_min_speed") {
+    params.p_min_speed = toDouble(key, value);
+  } else if (key == "dt") {
+    params.dt = toDouble(key, value);
+  } else if (key == "width") {
+    params.width = static_cast<double>(toSize(key, value));
+  } else if (key == "height") {
+    params.height = static_cast<double>(toSize(key, value));
+  } else if (key == "boundary") {
+    if (value == "walls") {
+      params.boundary = flock::Boundary::Walls;
+    } else if (value == "torus") {
+      params.boundary = flock::Boundary::Torus;
+    } else {
+      throw std::domain_error("Error: unknown boundary " + value + ".");
+    }
+  } else if (key == "seed") {
+    config.seed = toSize(key, value);
+  } else if (key == "distribution") {
+    if (value == "uniform") {
+      config.distribution = flock::Distribution::Uniform;
+    } else if (value == "clustered") {
+      config.distribution = flock::Distribution::Clustered;
+    } else if (value == "ring") {
+      config.distribution = flock::Distribution::Ring;
+    } else if (value == "gaussian") {
+      config.distribution = flock::Distribution::Gaussian;
+    } else {
+      throw std::domain_error("Error: unknown distribution " + value + ".");
+    }
+  } else if (key == "field_of_view") {
+    if (value == "angle") {
+      config.field_of_view = flock::FieldOfView::Angle;
+    } else if (value == "cone") {
+      config.field_of_view = flock::FieldOfView::Cone;
+    } else {
+      throw std::domain_error("Error: unknown field of view " + value + ".");
+    }
+  } else if (key == "threads") {
+    config.threads = toSize(key, value);
+  } else if (key == "skin") {
+    config.skin = toDouble(key, value);
+    if (config.skin < 0.) {
+      throw std::domain_error("Error: the skin of the candidate lists cannot be negative.");
+    }
+  } else if (key == "reorder_every") {
+    config.reorder_every = toSize(key, value);
+  } else if (key == "steps_per_second") {
+    config.steps_per_second = toDouble(key, value);
+    if (config.steps_per_second < 0.) {
+      throw std::domain_error("Error: the number of steps per second cannot be negative.");
+    }
+  } else if (key == "gpu") {
+    config.prefer_gpu = toBool(key, value);
+  } else if (key == "stats") {
+    if (value == "exact") {
+      config.stats_mode = statistics::Mode::Exact;
+    } else if (value == "sampled") {
+      config.stats_mode = statistics::Mode::Sampled;
+    } else {
+      throw std::domain_error("Error: unknown statistics mode " + value + ".");
+    }
+  } else {
+    throw std::domain_error("Error: unknown setting " + key + ".");
+  }
+}
+
+void load(Config& config, std::istream& in) {
+  std::string line;
+  for (size_t number = 1; std::getline(in, line); ++number) {
+    const std::string text{trim(line.substr(0, line.find('#')))};
+    if (text.empty()) {
+      continue;
+    }
+
+    const size_t equals{text.find('=')};
+    if (equals == std::string::npos) {
+      throw std::domain_error("Error: line " + std::to_string(number) + " is not of the form key = value.");
+    }
+    try {
+      set(config, trim(text.substr(0, equals)), trim(text.substr(equals + 1)));
+    } catch (const std::domain_error& e) {
+      throw std::domain_error("Error: line " + std::to_string(number) + ": " + std::string(e.what()).substr(7));
+    }
+  }
+}
+
+void loadFile(Config& config, const std::string& path) {
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("Error: cannot open " + path + ".");
+  }
+  load(config, in);
+}
+
+void parseArguments(Config& config, const int argc, const char* const argv[]) {
+  for (int k = 1; k < argc; ++k) {
+    const std::string flag{argv[k]};
+    if (flag.size() < 3 || flag.compare(0, 2, "--") != 0) {
+      throw std::domain_error("Error: unexpected argument " + flag + ".");
+    }
+    if (k + 1 == argc) {
+      throw std::domain_error("Error: missing value for option " + flag + ".");
+    }
+    const std::string value{argv[++k]};
+
+    if (flag == "--config") {
+      loadFile(config, value);
+    } else {
+      set(config, flag.substr(2), value);
+    }
+  }
+}
+
+void printKeys(std::ostream& out) {
+  const flock::Parameters defaults;
+  out << "  --config FILE                read settings from FILE, one 'key = value' per line, '#' for comments\n"
+      << "  --boids N                    number of boids\n"
+      << "  --predators N                number of predators\n"
+      << "  --separation S               separation coefficient in [0, 1] (default 0.1)\n"
+      << "  --alignment A                alignment coefficient in [0, 1] (default 0.1)\n"
+      << "  --cohesion C                 cohesion coefficient in [0, 1] (default 0.004)\n"
+      << "  --distance D                 radius of the neighbourhood (default " << defaults.d << ")\n"
+      << "  --boid_separation D          separation radius of the boids (default " << defaults.b_ds << ")\n"
+      << "  --predator_separation D      separation radius of the predators (default " << defaults.p_ds << ")\n"
+      << "  --boid_sight_angle DEG       half-width of the field of view of the boids (default 120)\n"
+      << "  --predator_sight_angle DEG   half-width of the field of view of the predators (default 90)\n"
+      << "  --margin M                   width of the border region (default " << defaults.margin << ")\n"
+      << "  --turn_factor T              velocity increment of the border rule (default " << defaults.turn_factor
+      << ")\n"
+      << "  --boid_max_speed V           (default " << defaults.b_max_speed << ")\n"
+      << "  --boid_min_speed V           (default " << defaults.b_min_speed << ")\n"
+      << "  --predator_max_speed V       (default " << defaults.p_max_speed << ")\n"
+      << "  --predator_min_speed V       (default " << defaults.p_min_speed << ")\n"
+      << "  --dt T                       time step (default " << defaults.dt << ")\n"
+      << "  --width W, --height H        size of the window and of the world (default " << defaults.width << " x "
+      << defaults.height << ")\n"
+      << "  --boundary walls|torus       turn the birds back at the edges, or wrap the world around (default walls)\n"
+      << "  --seed S                     seed of the generated birds (default: from the clock)\n"
+      << "  --distribution D             'uniform', 'clustered', 'ring' or 'gaussian' (default uniform)\n"
+      << "  --field_of_view angle|cone   former atan2 test, whose view points behind the bird, or cone ahead of its\n"
+      << "                               velocity (default angle)\n"
+      << "  --threads T                  number of threads (default: all hardware threads)\n"
+      << "  --skin S                     reuse neighbour candidates within distance + S until a bird moves S / 2,\n"
+      << "                               0 to search them at every step (default 0)\n"
+      << "  --reorder_every K            sort the birds in memory along the Z curve every K steps, 0 never\n"
+      << "                               (default 0)\n"
+      << "  --steps_per_second R         steps per second of the window, 0 for no limit (default 60)\n"
+      << "  --gpu true|false             draw the birds on the GPU if it can (default true)\n"
+      << "  --stats exact|sampled        statistics mode (default: sampled above 2000 boids)\n";
+}
+}  // namespace config
@@ -1,51 +1,306 @@
 #include "../include/flock.hpp"
 
 #include <SFML/Graphics/VertexArray.hpp>
+#include <algorithm>
 #include <array>
 #include <cassert>
-#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <numeric>
-#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 #include "../include/bird.hpp"
 #include "../include/graphic.hpp"
+#include "../include/grid.hpp"
+#include "../include/morton.hpp"
 #include "../include/point.hpp"
+#include "../include/pool.hpp"
+#include "../include/rng.hpp"
+#include "../include/snapshot.hpp"
 #include "../include/statistics.hpp"
+#include "../include/storage.hpp"
+#include "../include/torus.hpp"
 #include "../include/triangle.hpp"
 
 namespace flock {
 
-Flock::Flock(const size_t nBoids, const size_t nPredators)
-    : n_boids_(nBoids), n_predators_(nPredators), s_(0.1), a_(0.1), c_(0.004), r_(s_ * 6), ch_(c_ * 2),
-      b_max_speed_(12.), p_max_speed_(8.), b_min_speed_(7.), p_min_speed_(5.) {
-  b_flock_.reserve(n_boids_);
-  p_flock_.reserve(n_predators_);
+namespace {
+
+/// @brief Is the rectangle [x0, x1) x [y0, y1) the birds are generated in.
+struct Area {
+  double x0;
+  double x1;
+  double y0;
+  double y1;
+};
+
+/// @brief Draws two independent standard normal values, by the Box-Muller transform.
+std::array<double, 2> gaussianPair(rng::Xoshiro256& engine) {
+  // 1 - u lies in (0, 1], so that the logarithm is finite
+  const double radius{std::sqrt(-2. * std::log(1. - engine.uniform()))};
+  const double angle{2. * M_PI * engine.uniform()};
+  return {radius * std::cos(angle), radius * std::sin(angle)};
 }
 
-Flock::Flock(const std::vector<std::shared_ptr<bird::Boid>>& boids,
-             const std::vector<std::shared_ptr<bird::Predator>>& predators, const double bMaxSpeed,
-             const double pMaxSpeed, const double bMinSpeed, const double pMinSpeed)
-    : n_boids_(boids.size()), n_predators_(predators.size()), b_flock_(boids), p_flock_(predators), s_(0.1), a_(0.1),
-      c_(0.004), r_(s_ * 6), ch_(c_ * 2), b_max_speed_(bMaxSpeed), p_max_speed_(pMaxSpeed), b_min_speed_(bMinSpeed),
-      p_min_speed_(pMinSpeed) {}
+/// @brief Draws the position of a bird.
+/// @details Distribution::Uniform draws x, then y, as generateBirds() always did; the other distributions go through
+/// libm, so their positions may differ in the last bits between platforms.
+template <size_t N>
+std::array<double, 2> placeBird(rng::Xoshiro256& engine, const Distribution distribution, const Area& area,
+                                const std::array<std::array<double, 2>, N>& centres) {
+  const double cx{(area.x0 + area.x1) / 2.};
+  const double cy{(area.y0 + area.y1) / 2.};
+  const double height{area.y1 - area.y0};
+
+  std::array<double, 2> position{};
+  switch (distribution) {
+    case Distribution::Uniform:
+      position[0] = engine.uniform(area.x0, area.x1);
+      position[1] = engine.uniform(area.y0, area.y1);
+      return position;
+    case Distribution::Clustered: {
+      const std::array<double, 2>& centre = centres[static_cast<size_t>(engine.below(N))];
+      const std::array<double, 2> offset{gaussianPair(engine)};
+      position = {centre[0] + 40. * offset[0], centre[1] + 40. * offset[1]};
+      break;
+    }
+    case Distribution::Ring: {
+      const double radius{engine.uniform(0.35 * height, 0.45 * height)};
+      const double angle{2. * M_PI * engine.uniform()};
+      position = {cx + radius * std::cos(angle), cy + radius * std::sin(angle)};
+      break;
+    }
+    case Distribution::Gaussian: {
+      const std::array<double, 2> offset{gaussianPair(engine)};
+      position = {cx + height / 6. * offset[0], cy + height / 6. * offset[1]};
+      break;
+    }
+  }
+  position[0] = std::clamp(position[0], area.x0, area.x1);
+  position[1] = std::clamp(position[1], area.y0, area.y1);
+  return position;
+}
+
+/// @brief States whether a minimum and a maximum speed are finite, strictly positive and in order.
+bool validSpeeds(const double min_speed, const double max_speed) {
+  return std::isfinite(min_speed) && std::isfinite(max_speed) && min_speed > 0. && min_speed <= max_speed;
+}
+
+/// @brief States whether a flight parameter lies in the range [0, 1], which NaN does not.
+bool validCoefficient(const double k) { return k >= 0. && k <= 1.; }
+
+/// @brief Throws std::domain_error if a set of parameters is not valid, see BasicFlock::setParameters().
+void checkParameters(const Parameters& params) {
+  const bool positive{params.d > 0. && params.b_ds > 0. && params.p_ds > 0. && params.margin > 0. &&
+                      params.turn_factor > 0. && params.dt > 0. && params.b_min_speed > 0. &&
+                      params.p_min_speed > 0.};
+  if (!positive) {
+    throw std::domain_error("Error: the distances, the margin, the turn factor, dt and the speeds must be strictly "
+                            "positive.");
+  }
+  if (params.b_ds > params.d || params.p_ds > params.d) {
+    throw std::domain_error("Error: the separation radii cannot exceed the radius of the neighbourhood.");
+  }
+  if (!(params.b_sight_angle > 0. && params.b_sight_angle <= M_PI && params.p_sight_angle > 0. &&
+        params.p_sight_angle <= M_PI)) {
+    throw std::domain_error("Error: the sight angles must be in (0, pi].");
+  }
+  if (!validSpeeds(params.b_min_speed, params.b_max_speed) || !validSpeeds(params.p_min_speed, params.p_max_speed)) {
+    throw std::domain_error("Error: the speeds must be finite and a minimum speed cannot exceed the maximum one.");
+  }
+  if (!(std::isfinite(params.width) && std::isfinite(params.height) &&
+        params.width - graphic_par::stats_width > 2. * params.margin && params.height > 2. * params.margin)) {
+    throw std::domain_error("Error: the world must be finite, and wider and taller than twice the margin.");
+  }
+  if (params.boundary == Boundary::Torus &&
+      !(params.width - graphic_par::stats_width > 2. * params.d && params.height > 2. * params.d)) {
+    throw std::domain_error("Error: a toroidal world must be wider and taller than twice the radius of the "
+                            "neighbourhood.");
+  }
+}
+}  // namespace
+
+Parameters::Parameters()
+    : d{75.}, b_ds{20.}, p_ds{d * 0.5}, b_sight_angle{2. / 3 * M_PI}, p_sight_angle{0.5 * M_PI}, margin{100.},
+      turn_factor{2.5}, b_max_speed{12.}, p_max_speed{8.}, b_min_speed{7.}, p_min_speed{5.}, dt{graphic_par::dt},
+      width{graphic_par::window_width}, height{graphic_par::window_height}, boundary{Boundary::Walls} {}
+
+template <typename T>
+BasicFlock<T>::BasicFlock(const size_t nBoids, const size_t nPredators)
+    : n_boids_(nBoids), n_predators_(nPredators), params_(), b_cos_sight_(std::cos(params_.b_sight_angle)),
+      p_cos_sight_(std::cos(params_.p_sight_angle)), fov_(FieldOfView::Angle), kernel_(Kernel::Fused), skin_(0.),
+      s_(0.1), a_(0.1), c_(0.004), r_(s_ * 6), ch_(c_ * 2), b_grid_(params_.d), p_grid_(params_.d),
+      lists_valid_(false), list_builds_(0), reorder_every_(0), steps_(0), profiler_(nullptr) {}
+
+template <typename T>
+BasicFlock<T>::BasicFlock(const std::vector<std::shared_ptr<bird::BasicBoid<T>>>& boids,
+                          const std::vector<std::shared_ptr<bird::BasicPredator<T>>>& predators,
+                          const double bMaxSpeed, const double pMaxSpeed, const double bMinSpeed,
+                          const double pMinSpeed)
+    : n_boids_(boids.size()), n_predators_(predators.size()), b_flock_(boids), p_flock_(predators), params_(),
+      b_cos_sight_(std::cos(params_.b_sight_angle)), p_cos_sight_(std::cos(params_.p_sight_angle)),
+      fov_(FieldOfView::Angle), kernel_(Kernel::Fused), skin_(0.), s_(0.1), a_(0.1), c_(0.004), r_(s_ * 6),
+      ch_(c_ * 2), b_grid_(params_.d), p_grid_(params_.d), lists_valid_(false), list_builds_(0), reorder_every_(0),
+      steps_(0), profiler_(nullptr) {
+  params_.b_max_speed = bMaxSpeed;
+  params_.p_max_speed = pMaxSpeed;
+  params_.b_min_speed = bMinSpeed;
+  params_.p_min_speed = pMinSpeed;
+  for (const std::shared_ptr<bird::BasicBoid<T>>& boid : boids) {
+    b_arrays_.push_back(boid->getPosition(), boid->getVelocity());
+  }
+  for (const std::shared_ptr<bird::BasicPredator<T>>& predator : predators) {
+    p_arrays_.push_back(predator->getPosition(), predator->getVelocity());
+  }
+  resetIds();
+  buildIndex();
+}
+
+template <typename T>
+size_t BasicFlock<T>::getBoidsNum() const { return n_boids_; }
+template <typename T>
+size_t BasicFlock<T>::getPredatorsNum() const { return n_predators_; }
+template <typename T>
+size_t BasicFlock<T>::getFlockSize() const { return n_predators_ + n_boids_; }
+template <typename T>
+std::vector<std::shared_ptr<bird::BasicBoid<T>>> BasicFlock<T>::getBoidFlock() const {
+  syncViews();
+  return b_flock_;
+}
+template <typename T>
+std::vector<std::shared_ptr<bird::BasicPredator<T>>> BasicFlock<T>::getPredatorFlock() const {
+  syncViews();
+  return p_flock_;
+}
+template <typename T>
+const storage::BasicBirdArrays<T>& BasicFlock<T>::getBoidArrays() const { return b_arrays_; }
+template <typename T>
+const storage::BasicBirdArrays<T>& BasicFlock<T>::getPredatorArrays() const { return p_arrays_; }
+
+template <typename T>
+double BasicFlock<T>::getTurnFactor() { return Parameters().turn_factor; }
+template <typename T>
+double BasicFlock<T>::getMargin() { return Parameters().margin; }
+
+template <typename T>
+std::array<double, 5> BasicFlock<T>::getFlightParams() const { return {s_, a_, c_, r_, ch_}; }
+
+template <typename T>
+std::array<double, 3> BasicFlock<T>::getDistancesParams() {
+  const Parameters defaults;
+  return {defaults.d, defaults.b_ds, defaults.p_ds};
+}
+
+template <typename T>
+void BasicFlock<T>::setParameters(const Parameters& params) {
+  checkParameters(params);
+
+  params_ = params;
+  b_cos_sight_ = std::cos(params_.b_sight_angle);
+  p_cos_sight_ = std::cos(params_.p_sight_angle);
+  b_grid_ = grid::Grid(params_.d + skin_);
+  p_grid_ = grid::Grid(params_.d + skin_);
+  lists_valid_ = false;
+  buildIndex();
+}
+
+template <typename T>
+const Parameters& BasicFlock<T>::getParameters() const { return params_; }
+
+template <typename T>
+std::array<T, 2> BasicFlock<T>::getPeriods() const {
+  if (params_.boundary == Boundary::Torus) {
+    return {static_cast<T>(params_.width - graphic_par::stats_width), static_cast<T>(params_.height)};
+  }
+  return {0, 0};
+}
+
+template <typename T>
+void BasicFlock<T>::setThreads(const size_t n_threads) {
+  if (n_threads > 1) {
+    pool_ = std::make_shared<pool::ThreadPool>(n_threads);
+  } else {
+    pool_.reset();
+  }
+}
 
-size_t Flock::getBoidsNum() const { return n_boids_; }
-size_t Flock::getPredatorsNum() const { return n_predators_; }
-size_t Flock::getFlockSize() const { return n_predators_ + n_boids_; }
-std::vector<std::shared_ptr<bird::Boid>> Flock::getBoidFlock() const { return b_flock_; }
-std::vector<std::shared_ptr<bird::Predator>> Flock::getPredatorFlock() const { return p_flock_; }
+template <typename T>
+size_t BasicFlock<T>::getThreads() const { return pool_ ? pool_->size() : 1; }
 
-double Flock::getTurnFactor() { return {turn_factor_}; }
-double Flock::getMargin() { return {margin_}; }
+template <typename T>
+void BasicFlock<T>::setProfiler(profiler::Profiler* const profiler) { profiler_ = profiler; }
 
-std::array<double, 5> Flock::getFlightParams() const { return {s_, a_, c_, r_, ch_}; }
+template <typename T>
+void BasicFlock<T>::setFieldOfView(const FieldOfView fov) { fov_ = fov; }
+template <typename T>
+FieldOfView BasicFlock<T>::getFieldOfView() const { return fov_; }
 
-std::array<double, 3> Flock::getDistancesParams() { return {d_, b_ds_, p_ds_}; }
+template <typename T>
+void BasicFlock<T>::setKernel(const Kernel kernel) { kernel_ = kernel; }
+template <typename T>
+Kernel BasicFlock<T>::getKernel() const { return kernel_; }
 
-void Flock::setFlightParams(std::istream& in, std::ostream& out) {
+template <typename T>
+void BasicFlock<T>::setSkin(const double skin) {
+  if (!(skin >= 0.)) {
+    throw std::domain_error("Error: the skin of the candidate lists cannot be negative.");
+  }
+  skin_ = skin;
+  // the cells must cover the reach of the lists, so that the 3x3 cells around a bird hold all its candidates
+  b_grid_ = grid::Grid(params_.d + skin_);
+  p_grid_ = grid::Grid(params_.d + skin_);
+  lists_valid_ = false;
+  list_builds_ = 0;
+  buildIndex();
+}
+template <typename T>
+double BasicFlock<T>::getSkin() const { return skin_; }
+template <typename T>
+size_t BasicFlock<T>::getListBuilds() const { return list_builds_; }
+
+template <typename T>
+void BasicFlock<T>::setReorder(const size_t every) {
+  reorder_every_ = every;
+  steps_ = 0;
+}
+template <typename T>
+size_t BasicFlock<T>::getReorder() const { return reorder_every_; }
+template <typename T>
+const std::vector<size_t>& BasicFlock<T>::getBoidIds() const { return b_ids_; }
+template <typename T>
+const std::vector<size_t>& BasicFlock<T>::getPredatorIds() const { return p_ids_; }
+
+template <typename T>
+void BasicFlock<T>::parallelFor(const size_t n, const std::function<void(size_t, size_t, size_t)>& task) const {
+  if (pool_) {
+    pool_->parallelFor(n, task);
+  } else if (n > 0) {
+    task(0, n, 0);
+  }
+}
+
+template <typename T>
+void BasicFlock<T>::setFlightParams(const double s, const double a, const double c) {
+  if (!validCoefficient(s) || !validCoefficient(a) || !validCoefficient(c)) {
+    throw std::domain_error("Error: the flight parameters must lie in the range [0, 1].");
+  }
+  s_ = s;
+  a_ = a;
+  c_ = c;
+
+  r_ = s * 6;
+  ch_ = c * 2;
+}
+
+template <typename T>
+void BasicFlock<T>::setFlightParams(std::istream& in, std::ostream& out) {
   char statement;
   out << "\nWould you like to customize the parameters of the simulation? (Y/n) ";
   in >> statement;
@@ -59,12 +314,7 @@ void Flock::setFlightParams(std::istream& in, std::ostream& out) {
     const double a = graphic_par::getPositiveDouble("Enter the alignment coefficient: ", in, out);
     const double c = graphic_par::getPositiveDouble("Enter the cohesion coefficient: ", in, out);
 
-    s_ = s;
-    a_ = a;
-    c_ = c;
-
-    r_ = s * 6;
-    ch_ = c * 2;
+    setFlightParams(s, a, c);
 
   } else if (statement == 'N' || statement == 'n') {
     out << "\nThe simulation parameters are set as default (s = 0.1, a = 0.1, c = 0.004) \n";
@@ -74,241 +324,759 @@ void Flock::setFlightParams(std::istream& in, std::ostream& out) {
   }
 }
 
-void Flock::generateBirds() {
-  std::default_random_engine rng(
-      static_cast<long unsigned int>(std::chrono::system_clock::now().time_since_epoch().count()));
-  std::uniform_real_distribution<> dist_pos_x(graphic_par::stats_width, graphic_par::window_width);
-  std::uniform_real_distribution<> dist_pos_y(0., graphic_par::window_height);
-  std::uniform_real_distribution<> dist_vel_x(graphic_par::min_vel_x, graphic_par::max_vel_x);
-  std::uniform_real_distribution<> dist_vel_y(graphic_par::min_vel_y, graphic_par::max_vel_y);
+template <typename T>
+void BasicFlock<T>::generateBirds() { generateBirds(rng::clockSeed()); }
+
+template <typename T>
+void BasicFlock<T>::generateBirds(const std::uint64_t seed) { generateBirds(seed, Distribution::Uniform); }
 
+template <typename T>
+void BasicFlock<T>::generateBirds(const std::uint64_t seed, const Distribution distribution) {
+  b_arrays_.resize(n_boids_);
+  p_arrays_.resize(n_predators_);
   b_flock_.clear();
+  p_flock_.clear();
 
-  for (size_t i = 0; i < n_boids_; ++i) {
-    b_flock_.emplace_back(std::make_shared<bird::Boid>(point::Point(dist_pos_x(rng), dist_pos_y(rng)),
-                                                       point::Point(dist_vel_x(rng), dist_vel_y(rng))));
+  const Area area{graphic_par::stats_width, params_.width, 0., params_.height};
+
+  // the centres of the clusters have a stream of their own, after those of the birds
+  std::array<std::array<double, 2>, n_clusters> centres{};
+  rng::Xoshiro256 centre_engine(seed, std::uint64_t{2} << 32);
+  for (std::array<double, 2>& centre : centres) {
+    centre = {centre_engine.uniform(area.x0 + params_.margin, area.x1 - params_.margin),
+              centre_engine.uniform(area.y0 + params_.margin, area.y1 - params_.margin)};
   }
 
-  if (n_predators_ > 0) {
-    p_flock_.clear();
-    for (size_t i = 0; i < n_predators_; ++i) {
-      p_flock_.emplace_back(std::make_shared<bird::Predator>(point::Point(dist_pos_x(rng), dist_pos_y(rng)),
-                                                             point::Point(dist_vel_x(rng), dist_vel_y(rng))));
-    }
-    assert(!p_flock_.empty());
+  // each chunk of generation_chunk birds draws from its own stream, the predators from streams after those of the
+  // boids: the birds of a chunk do not depend on how many chunks come before it, or on the thread generating them
+  for (const bool is_boid : {true, false}) {
+    storage::BasicBirdArrays<T>& birds = is_boid ? b_arrays_ : p_arrays_;
+    const std::uint64_t first_stream{is_boid ? 0 : std::uint64_t{1} << 32};
+    const size_t n_chunks{(birds.size() + generation_chunk - 1) / generation_chunk};
+
+    parallelFor(n_chunks, [&](const size_t first, const size_t last, size_t) {
+      for (size_t chunk = first; chunk < last; ++chunk) {
+        rng::Xoshiro256 engine(seed, first_stream + chunk);
+        const size_t end{std::min((chunk + 1) * generation_chunk, birds.size())};
+        for (size_t i = chunk * generation_chunk; i < end; ++i) {
+          const std::array<double, 2> position{placeBird(engine, distribution, area, centres)};
+          birds.x[i] = static_cast<T>(position[0]);
+          birds.y[i] = static_cast<T>(position[1]);
+          birds.vx[i] = static_cast<T>(engine.uniform(graphic_par::min_vel_x, graphic_par::max_vel_x));
+          birds.vy[i] = static_cast<T>(engine.uniform(graphic_par::min_vel_y, graphic_par::max_vel_y));
+        }
+      }
+    });
   }
 
-  assert(!b_flock_.empty());
+  assert(b_arrays_.size() == n_boids_ && p_arrays_.size() == n_predators_);
+  resetIds();
+  buildIndex();
 }
 
-std::vector<std::shared_ptr<bird::Bird>> Flock::findNearBoids(const size_t i, const bool is_boid) const {
-  // Finds near boids for both boids and predators
-  double alpha{};
-  double beta{};
+template <typename T>
+void BasicFlock<T>::save(const std::string& path) const {
+  snapshot::Header header{};
+  header.field_of_view = static_cast<std::uint32_t>(fov_);
+  header.s = s_;
+  header.a = a_;
+  header.c = c_;
+  header.b_max_speed = params_.b_max_speed;
+  header.p_max_speed = params_.p_max_speed;
+  header.b_min_speed = params_.b_min_speed;
+  header.p_min_speed = params_.p_min_speed;
+  header.boundary = static_cast<std::uint32_t>(params_.boundary);
+  header.width = params_.width;
+  header.height = params_.height;
+
+  // snapshots are in double precision whatever the precision of the flock, and in the order of the ids
+  const bool in_order{std::is_sorted(b_ids_.begin(), b_ids_.end()) && std::is_sorted(p_ids_.begin(), p_ids_.end())};
+  if constexpr (std::is_same_v<T, double>) {
+    if (in_order) {
+      snapshot::write(path, header, b_arrays_, p_arrays_);
+      return;
+    }
+  }
+  snapshot::write(path, header, storage::convert<double>(b_arrays_, b_ids_),
+                  storage::convert<double>(p_arrays_, p_ids_));
+}
 
-  std::vector<std::shared_ptr<bird::Bird>> near_boids;
+template <typename T>
+void BasicFlock<T>::load(const std::string& path) {
+  const snapshot::MappedSnapshot file(path);
+  const snapshot::Header& header = file.header();
 
-  for (size_t j = 0; j < n_boids_; ++j) {
-    point::Point other_pos = b_flock_[j]->getPosition();
+  if (header.field_of_view > static_cast<std::uint32_t>(FieldOfView::Cone)) {
+    throw std::runtime_error("Error: " + path + " has an unknown field of view.");
+  }
+  if (header.n_boids == 0) {
+    throw std::runtime_error("Error: " + path + " contains no boids.");
+  }
+  // everything read from the file is validated before anything is changed
+  if (!validCoefficient(header.s) || !validCoefficient(header.a) || !validCoefficient(header.c)) {
+    throw std::runtime_error("Error: " + path + " has flight parameters out of the range [0, 1].");
+  }
+  if (!validSpeeds(header.b_min_speed, header.b_max_speed) || !validSpeeds(header.p_min_speed, header.p_max_speed)) {
+    throw std::runtime_error("Error: " + path + " has invalid speed limits.");
+  }
+  if (header.boundary > static_cast<std::uint32_t>(Boundary::Torus)) {
+    throw std::runtime_error("Error: " + path + " has an unknown boundary.");
+  }
 
-    if (is_boid) {
-      // boid who sees near boids
+  // the world of the file replaces the one of the flock, the other parameters are kept
+  Parameters world{params_};
+  world.b_max_speed = header.b_max_speed;
+  world.p_max_speed = header.p_max_speed;
+  world.b_min_speed = header.b_min_speed;
+  world.p_min_speed = header.p_min_speed;
+  world.boundary = static_cast<Boundary>(header.boundary);
+  world.width = header.width;
+  world.height = header.height;
+  try {
+    checkParameters(world);
+  } catch (const std::domain_error&) {
+    throw std::runtime_error("Error: " + path + " does not describe a valid world for the parameters of the flock.");
+  }
+  // the values are checked as the flock stores them: a single precision flock would round some to infinity or 0
+  const auto valid = [](const std::array<const double*, 4>& arrays, const size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      const auto x = static_cast<T>(arrays[0][i]);
+      const auto y = static_cast<T>(arrays[1][i]);
+      const auto vx = static_cast<T>(arrays[2][i]);
+      const auto vy = static_cast<T>(arrays[3][i]);
+      if (!(std::isfinite(x) && std::isfinite(y) && std::isfinite(vx) && std::isfinite(vy)) || (vx == 0 && vy == 0)) {
+        return false;
+      }
+    }
+    return true;
+  };
+  if (!valid(file.boids(), static_cast<size_t>(header.n_boids)) ||
+      !valid(file.predators(), static_cast<size_t>(header.n_predators))) {
+    throw std::runtime_error("Error: " + path + " has birds of non-finite position or velocity, or at rest.");
+  }
+  if (world.boundary == Boundary::Torus) {
+    // the birds of a torus lie in the world: load() restores them where they were saved instead of wrapping them
+    const auto inside = [&world](const std::array<const double*, 4>& arrays, const size_t n) {
+      for (size_t i = 0; i < n; ++i) {
+        if (!(arrays[0][i] >= graphic_par::stats_width && arrays[0][i] < world.width && arrays[1][i] >= 0. &&
+              arrays[1][i] < world.height)) {
+          return false;
+        }
+      }
+      return true;
+    };
+    if (!inside(file.boids(), static_cast<size_t>(header.n_boids)) ||
+        !inside(file.predators(), static_cast<size_t>(header.n_predators))) {
+      throw std::runtime_error("Error: " + path + " has birds outside of its toroidal world.");
+    }
+  }
+  setFlightParams(header.s, header.a, header.c);
+
+  n_boids_ = static_cast<size_t>(header.n_boids);
+  n_predators_ = static_cast<size_t>(header.n_predators);
+  fov_ = static_cast<FieldOfView>(header.field_of_view);
+  // the grids keep their cells, which depend on Parameters::d only
+  params_ = world;
+  lists_valid_ = false;
+
+  const auto copy = [](const std::array<const double*, 4>& from, const size_t n, storage::BasicBirdArrays<T>& to) {
+    // a flock in single precision rounds the values of the file
+    to.x.assign(from[0], from[0] + n);
+    to.y.assign(from[1], from[1] + n);
+    to.vx.assign(from[2], from[2] + n);
+    to.vy.assign(from[3], from[3] + n);
+  };
+  copy(file.boids(), n_boids_, b_arrays_);
+  copy(file.predators(), n_predators_, p_arrays_);
+  b_flock_.clear();
+  p_flock_.clear();
 
-      beta = b_flock_[i]->getVelocity().angle();
-      const point::Point target_pos = b_flock_[i]->getPosition();
+  resetIds();
+  buildIndex();
+}
 
-      if (i != j && target_pos.distance(other_pos) < d_) {
-        alpha = (target_pos - other_pos).angle();
+template <typename T>
+void BasicFlock<T>::buildIndex() {
+  if (params_.boundary == Boundary::Torus) {
+    wrapPositions();
+    const double width{params_.width - graphic_par::stats_width};
+    b_grid_.buildPeriodic(b_arrays_.x, b_arrays_.y, graphic_par::stats_width, 0., width, params_.height);
+    p_grid_.buildPeriodic(p_arrays_.x, p_arrays_.y, graphic_par::stats_width, 0., width, params_.height);
+  } else {
+    b_grid_.build(b_arrays_.x, b_arrays_.y);
+    p_grid_.build(p_arrays_.x, p_arrays_.y);
+  }
+  refreshLists();
+}
 
-        if (alpha - beta < b_sight_angle_ || alpha - beta > 2 * M_PI - b_sight_angle_) {
-          near_boids.emplace_back(b_flock_[j]);
-        }
+template <typename T>
+void BasicFlock<T>::wrapPositions() {
+  const std::array<T, 2> period{getPeriods()};
+  const auto wrap = [](std::vector<T>& coordinates, const T low, const T side) {
+    for (T& c : coordinates) {
+      if (c < low || c >= low + side) {
+        c -= side * std::floor((c - low) / side);
       }
-    } else {
-      // predator who sees near boids
+    }
+  };
+  const auto left{static_cast<T>(graphic_par::stats_width)};
+  wrap(b_arrays_.x, left, period[0]);
+  wrap(b_arrays_.y, 0, period[1]);
+  wrap(p_arrays_.x, left, period[0]);
+  wrap(p_arrays_.y, 0, period[1]);
+}
 
-      beta = p_flock_[i]->getVelocity().angle();
-      const point::Point target_pos = p_flock_[i]->getPosition();
+template <typename T>
+void BasicFlock<T>::gatherImages(const point::BasicPoint<T>& position, std::vector<size_t>& near,
+                                 const storage::BasicBirdArrays<T>& birds, storage::BasicBirdArrays<T>& images) const {
+  const std::array<T, 2> period{getPeriods()};
+  const T x{position.getX()};
+  const T y{position.getY()};
+  images.resize(near.size());
+  for (size_t k = 0; k < near.size(); ++k) {
+    const size_t j{near[k]};
+    images.x[k] = x + torus::image(birds.x[j] - x, period[0]);
+    images.y[k] = y + torus::image(birds.y[j] - y, period[1]);
+    images.vx[k] = birds.vx[j];
+    images.vy[k] = birds.vy[j];
+    near[k] = k;
+  }
+}
 
-      if (target_pos.distance(other_pos) < d_) {
-        alpha = (target_pos - other_pos).angle();
+template <typename T>
+void BasicFlock<T>::resetIds() {
+  b_ids_.resize(b_arrays_.size());
+  std::iota(b_ids_.begin(), b_ids_.end(), size_t{0});
+  p_ids_.resize(p_arrays_.size());
+  std::iota(p_ids_.begin(), p_ids_.end(), size_t{0});
+}
 
-        if (alpha - beta < p_sight_angle_ || alpha - beta > 2 * M_PI - p_sight_angle_) {
-          near_boids.emplace_back(b_flock_[j]);
-        }
+template <typename T>
+void BasicFlock<T>::reorder(storage::BasicBirdArrays<T>& birds, std::vector<size_t>& ids) {
+  morton::order(birds.x, birds.y, order_);
+
+  reordered_.resize(birds.size());
+  for (size_t k = 0; k < order_.size(); ++k) {
+    reordered_.x[k] = birds.x[order_[k]];
+    reordered_.y[k] = birds.y[order_[k]];
+    reordered_.vx[k] = birds.vx[order_[k]];
+    reordered_.vy[k] = birds.vy[order_[k]];
+  }
+  std::swap(birds, reordered_);
+
+  // order_ is overwritten with the permuted ids, which are then swapped in
+  for (size_t& k : order_) {
+    k = ids[k];
+  }
+  std::swap(ids, order_);
+}
+
+template <typename T>
+void BasicFlock<T>::refreshLists() {
+  if (skin_ == 0.) {
+    return;
+  }
+
+  // the lists stay exhaustive as long as no two birds have closed in by more than the skin, each moving half of it
+  const auto half_skin{static_cast<T>(skin_ / 2.)};
+  const std::array<T, 2> period{getPeriods()};
+  const auto moved = [half_skin, &period](const storage::BasicBirdArrays<T>& now,
+                                          const storage::BasicBirdArrays<T>& then) {
+    if (now.size() != then.size()) {
+      return true;
+    }
+    for (size_t i = 0; i < now.size(); ++i) {
+      // a bird wrapped across an edge has only moved by the step it took
+      const T dx{torus::image(now.x[i] - then.x[i], period[0])};
+      const T dy{torus::image(now.y[i] - then.y[i], period[1])};
+      if (dx * dx + dy * dy > half_skin * half_skin) {
+        return true;
       }
     }
+    return false;
+  };
+  if (lists_valid_ && !moved(b_arrays_, b_listed_) && !moved(p_arrays_, p_listed_)) {
+    return;
   }
-  return near_boids;
+
+  buildList(true, true, b_near_boids_);
+  buildList(true, false, b_near_predators_);
+  buildList(false, true, p_near_boids_);
+  buildList(false, false, p_near_predators_);
+  b_listed_ = b_arrays_;
+  p_listed_ = p_arrays_;
+  lists_valid_ = true;
+  ++list_builds_;
 }
 
-std::vector<std::shared_ptr<bird::Bird>> Flock::findNearPredators(const size_t i, const bool is_boid) const {
-  // Finds near boids for both boids and predators
-  double alpha{};
-  double beta{};
+template <typename T>
+void BasicFlock<T>::buildList(const bool is_boid, const bool of_boids, CandidateList& list) {
+  const storage::BasicBirdArrays<T>& target = is_boid ? b_arrays_ : p_arrays_;
+  const storage::BasicBirdArrays<T>& others = of_boids ? b_arrays_ : p_arrays_;
+  const grid::Grid& grid = of_boids ? b_grid_ : p_grid_;
+  const auto reach{static_cast<T>(params_.d + skin_)};
+  const bool same_kind{is_boid == of_boids};
+  const std::array<T, 2> period{getPeriods()};
+
+  const auto visit = [&](const size_t i, auto&& add) {
+    grid.forEachCandidate(target.position(i), [&](const size_t j) {
+      const T ox{torus::image(others.x[j] - target.x[i], period[0])};
+      const T oy{torus::image(others.y[j] - target.y[i], period[1])};
+      if ((!same_kind || i != j) && ox * ox + oy * oy < reach * reach) {
+        add(j);
+      }
+    });
+  };
+
+  // one pass over the cells: every worker appends the rows of its chunks to a buffer of its own, remembering where
+  // each row went, then the rows are copied in place
+  list_buffers_.resize(getThreads());
+  for (std::vector<size_t>& buffer : list_buffers_) {
+    buffer.clear();
+  }
+  list_rows_.resize(target.size());
+  list.starts.assign(target.size() + 1, 0);
+  parallelFor(target.size(), [&](const size_t begin, const size_t end, const size_t worker) {
+    std::vector<size_t>& buffer = list_buffers_[worker];
+    for (size_t i = begin; i < end; ++i) {
+      list_rows_[i] = {worker, buffer.size()};
+      visit(i, [&](const size_t j) { buffer.push_back(j); });
+      list.starts[i + 1] = buffer.size() - list_rows_[i][1];
+    }
+  });
+  std::partial_sum(list.starts.begin(), list.starts.end(), list.starts.begin());
+
+  list.indices.resize(list.starts.back());
+  parallelFor(target.size(), [&](const size_t begin, const size_t end, size_t) {
+    for (size_t i = begin; i < end; ++i) {
+      const auto row{list.indices.begin() + static_cast<std::ptrdiff_t>(list.starts[i])};
+      const auto from{list_buffers_[list_rows_[i][0]].begin() + static_cast<std::ptrdiff_t>(list_rows_[i][1])};
+      std::copy(from, from + static_cast<std::ptrdiff_t>(list.starts[i + 1] - list.starts[i]), row);
+    }
+  });
+}
 
-  std::vector<std::shared_ptr<bird::Bird>> near_predators;
+template <typename T>
+template <typename Visitor>
+void BasicFlock<T>::forEachCandidate(const size_t i, const bool is_boid, const bool of_boids, Visitor&& visit) const {
+  if (skin_ > 0.) {
+    const CandidateList& list = is_boid ? (of_boids ? b_near_boids_ : b_near_predators_)
+                                        : (of_boids ? p_near_boids_ : p_near_predators_);
+    for (size_t k = list.starts[i]; k < list.starts[i + 1]; ++k) {
+      visit(list.indices[k]);
+    }
+    return;
+  }
+  const storage::BasicBirdArrays<T>& target = is_boid ? b_arrays_ : p_arrays_;
+  (of_boids ? b_grid_ : p_grid_).forEachCandidate(target.position(i), visit);
+}
 
-  for (size_t j = 0; j < n_predators_; ++j) {
-    point::Point other_pos = p_flock_[j]->getPosition();
+template <typename T>
+void BasicFlock<T>::syncViews() const {
+  if (b_flock_.size() != b_arrays_.size()) {
+    b_flock_.clear();
+    for (size_t i = 0; i < b_arrays_.size(); ++i) {
+      b_flock_.emplace_back(std::make_shared<bird::BasicBoid<T>>());
+    }
+  }
+  if (p_flock_.size() != p_arrays_.size()) {
+    p_flock_.clear();
+    for (size_t i = 0; i < p_arrays_.size(); ++i) {
+      p_flock_.emplace_back(std::make_shared<bird::BasicPredator<T>>());
+    }
+  }
 
-    if (is_boid) {
-      // boid who sees near predators
+  for (size_t i = 0; i < b_arrays_.size(); ++i) {
+    b_flock_[i]->setBird(b_arrays_.position(i), b_arrays_.velocity(i));
+  }
+  for (size_t i = 0; i < p_arrays_.size(); ++i) {
+    p_flock_[i]->setBird(p_arrays_.position(i), p_arrays_.velocity(i));
+  }
+}
 
-      beta = b_flock_[i]->getVelocity().angle();
-      const point::Point target_pos = b_flock_[i]->getPosition();
+template <typename T>
+BasicFlock<T>::Sight::Sight(const BasicFlock& flock, const point::BasicPoint<T>& position,
+                            const point::BasicPoint<T>& velocity, const bool is_boid)
+    : fov{flock.fov_}, x{position.getX()}, y{position.getY()}, vx{velocity.getX()}, vy{velocity.getY()},
+      d{static_cast<T>(flock.params_.d)}, period_x{flock.getPeriods()[0]}, period_y{flock.getPeriods()[1]},
+      sight_angle{is_boid ? flock.params_.b_sight_angle : flock.params_.p_sight_angle}, beta{0.}, cos2_speed2{0.} {
+  if (fov == FieldOfView::Angle) {
+    beta = velocity.angle();
+  } else {
+    const double cos_sight{is_boid ? flock.b_cos_sight_ : flock.p_cos_sight_};
+    cos2_speed2 = static_cast<T>(std::copysign(cos_sight * cos_sight, cos_sight)) * (vx * vx + vy * vy);
+  }
+}
 
-      if (target_pos.distance(other_pos) < d_) {
-        alpha = (target_pos - other_pos).angle();
+template <typename T>
+std::array<T, 2> BasicFlock<T>::Sight::offset(const T other_x, const T other_y) const {
+  return {torus::image(other_x - x, period_x), torus::image(other_y - y, period_y)};
+}
 
-        if (alpha - beta < b_sight_angle_ || alpha - beta > 2 * M_PI - b_sight_angle_) {
-          near_predators.emplace_back(p_flock_[j]);
-        }
-      }
-    } else {
-      // predator who sees near predators
+template <typename T>
+bool BasicFlock<T>::Sight::sees(const T ox, const T oy) const {
+  if (fov == FieldOfView::Angle) {
+    // the offset from the other bird to this one, as the angle of the former test is measured
+    const point::BasicPoint<T> back(-ox, -oy);
+    if (back.module() < d) {
+      const double alpha{back.angle()};
+      return alpha - beta < sight_angle || alpha - beta > 2 * M_PI - sight_angle;
+    }
+    return false;
+  }
 
-      beta = p_flock_[i]->getVelocity().angle();
-      const point::Point target_pos = p_flock_[i]->getPosition();
+  const T dist2{ox * ox + oy * oy};
+  if (dist2 >= d * d) {
+    return false;
+  }
+  // angle(v, o) < sight_angle  <=>  v.o > cos(sight_angle) |v| |o|; both sides are squared keeping their sign
+  const T dot{vx * ox + vy * oy};
+  return std::copysign(dot * dot, dot) > cos2_speed2 * dist2;
+}
 
-      if (i != j && target_pos.distance(other_pos) < d_) {
-        alpha = (target_pos - other_pos).angle();
+template <typename T>
+void BasicFlock<T>::findNearBoids(const size_t i, const bool is_boid, std::vector<size_t>& near) const {
+  // Finds near boids for both boids and predators
+  near.clear();
 
-        if (alpha - beta < p_sight_angle_ || alpha - beta > 2 * M_PI - p_sight_angle_) {
-          near_predators.emplace_back(p_flock_[j]);
-        }
-      }
+  if (n_boids_ == 0) {
+    return;
+  }
+
+  const storage::BasicBirdArrays<T>& target = is_boid ? b_arrays_ : p_arrays_;
+  const Sight sight(*this, target.position(i), target.velocity(i), is_boid);
+
+  forEachCandidate(i, is_boid, true, [&](const size_t j) {
+    // a boid does not see itself
+    if (is_boid && i == j) {
+      return;
+    }
+    const std::array<T, 2> o{sight.offset(b_arrays_.x[j], b_arrays_.y[j])};
+    if (sight.sees(o[0], o[1])) {
+      near.push_back(j);
+    }
+  });
+  std::sort(near.begin(), near.end());
+}
+
+template <typename T>
+void BasicFlock<T>::findNearPredators(const size_t i, const bool is_boid, std::vector<size_t>& near) const {
+  // Finds near predators for both boids and predators
+  near.clear();
+
+  if (n_predators_ == 0) {
+    return;
+  }
+
+  const storage::BasicBirdArrays<T>& target = is_boid ? b_arrays_ : p_arrays_;
+  const Sight sight(*this, target.position(i), target.velocity(i), is_boid);
+
+  forEachCandidate(i, is_boid, false, [&](const size_t j) {
+    // a predator does not see itself
+    if (!is_boid && i == j) {
+      return;
     }
+    const std::array<T, 2> o{sight.offset(p_arrays_.x[j], p_arrays_.y[j])};
+    if (sight.sees(o[0], o[1])) {
+      near.push_back(j);
+    }
+  });
+  std::sort(near.begin(), near.end());
+}
+
+template <typename T>
+std::vector<std::shared_ptr<bird::BasicBird<T>>> BasicFlock<T>::findNearBoids(const size_t i,
+                                                                              const bool is_boid) const {
+  std::vector<size_t> near;
+  findNearBoids(i, is_boid, near);
+  syncViews();
+
+  std::vector<std::shared_ptr<bird::BasicBird<T>>> near_boids;
+  near_boids.reserve(near.size());
+  for (const size_t j : near) {
+    near_boids.emplace_back(b_flock_[j]);
+  }
+  return near_boids;
+}
+
+template <typename T>
+std::vector<std::shared_ptr<bird::BasicBird<T>>> BasicFlock<T>::findNearPredators(const size_t i,
+                                                                                  const bool is_boid) const {
+  std::vector<size_t> near;
+  findNearPredators(i, is_boid, near);
+  syncViews();
+
+  std::vector<std::shared_ptr<bird::BasicBird<T>>> near_predators;
+  near_predators.reserve(near.size());
+  for (const size_t j : near) {
+    near_predators.emplace_back(p_flock_[j]);
   }
   return near_predators;
 }
 
-std::array<point::Point, 2> Flock::updateBird(sf::VertexArray& triangles, const size_t i, const bool is_boid) const {
-  if (is_boid) {
-    point::Point p = b_flock_[i]->getPosition();
+template <typename T>
+std::array<point::BasicPoint<T>, 2> BasicFlock<T>::updateBird(sf::VertexArray& triangles, const size_t i,
+                                                              const bool is_boid) const {
+  BasicNeighbours<T> near;
+  return updateBird(triangles, i, is_boid, near);
+}
+
+template <typename T>
+std::array<point::BasicPoint<T>, 2> BasicFlock<T>::updateBird(sf::VertexArray& triangles, const size_t i,
+                                                              const bool is_boid, BasicNeighbours<T>& near) const {
+  const std::array<point::BasicPoint<T>, 2> next{advanceBird(i, is_boid, near)};
+  triangles::rotateTriangle(next[0], triangles, next[1].angle(), i, is_boid, n_boids_);
+  return next;
+}
 
-    const std::vector<std::shared_ptr<bird::Bird>> near_boids{findNearBoids(i, true)};
-    const std::vector<std::shared_ptr<bird::Bird>> near_predators{findNearPredators(i, true)};
+template <typename T>
+std::array<point::BasicPoint<T>, 2> BasicFlock<T>::advanceBird(const size_t i, const bool is_boid,
+                                                               BasicNeighbours<T>& near) const {
+  if (kernel_ == Kernel::Fused) {
+    return advanceBirdFused(i, is_boid);
+  }
+  const bool wraps{params_.boundary == Boundary::Torus};
+
+  if (is_boid) {
+    bird::BasicBoid<T> boid(b_arrays_.position(i), b_arrays_.velocity(i));
+    point::BasicPoint<T> p = boid.getPosition();
+
+    findNearBoids(i, true, near.boids);
+    findNearPredators(i, true, near.predators);
+    // the rules see the closest images of the neighbours, through the edges of a toroidal world
+    if (wraps) {
+      gatherImages(p, near.boids, b_arrays_, near.boid_images);
+      gatherImages(p, near.predators, p_arrays_, near.predator_images);
+    }
+    const std::vector<size_t>& near_boids{near.boids};
+    const std::vector<size_t>& near_predators{near.predators};
+    const storage::BasicBirdArrays<T>& boids = wraps ? near.boid_images : b_arrays_;
+    const storage::BasicBirdArrays<T>& predators = wraps ? near.predator_images : p_arrays_;
 
-    point::Point v = b_flock_[i]->border(margin_, turn_factor_);
+    point::BasicPoint<T> v =
+        wraps ? boid.getVelocity() : boid.border(params_.margin, params_.turn_factor, params_.width, params_.height);
 
     if (!near_predators.empty()) {
-      v += b_flock_[i]->repel(r_, near_predators);
+      v += boid.repel(r_, near_predators, predators);
     }
     if (!near_boids.empty()) {
-      v += b_flock_[i]->separation(s_, b_ds_, near_boids) + b_flock_[i]->alignment(a_, near_boids) +
-           b_flock_[i]->cohesion(c_, near_boids);
+      v += boid.separation(s_, params_.b_ds, near_boids, boids) + boid.alignment(a_, near_boids, boids) +
+           boid.cohesion(c_, near_boids, boids);
     }
 
-    b_flock_[i]->boost(b_min_speed_, v);
-    b_flock_[i]->friction(b_max_speed_, v);
-
-    const double theta{v.angle()};
-    p += graphic_par::dt * v;
+    boid.boost(params_.b_min_speed, v);
+    boid.friction(params_.b_max_speed, v);
 
-    triangles::rotateTriangle(p, triangles, theta, i, true, n_boids_);
+    p += params_.dt * v;
     return {p, v};
   } else {
-    point::Point p = p_flock_[i]->getPosition();
-
-    const std::vector<std::shared_ptr<bird::Bird>> near_boids{findNearBoids(i, false)};
-    const std::vector<std::shared_ptr<bird::Bird>> near_predators{findNearPredators(i, false)};
+    bird::BasicPredator<T> predator(p_arrays_.position(i), p_arrays_.velocity(i));
+    point::BasicPoint<T> p = predator.getPosition();
+
+    findNearBoids(i, false, near.boids);
+    findNearPredators(i, false, near.predators);
+    if (wraps) {
+      gatherImages(p, near.boids, b_arrays_, near.boid_images);
+      gatherImages(p, near.predators, p_arrays_, near.predator_images);
+    }
+    const std::vector<size_t>& near_boids{near.boids};
+    const std::vector<size_t>& near_predators{near.predators};
+    const storage::BasicBirdArrays<T>& boids = wraps ? near.boid_images : b_arrays_;
+    const storage::BasicBirdArrays<T>& predators = wraps ? near.predator_images : p_arrays_;
 
-    point::Point v = p_flock_[i]->border(margin_, turn_factor_);
+    point::BasicPoint<T> v = wraps ? predator.getVelocity()
+                                   : predator.border(params_.margin, params_.turn_factor, params_.width,
+                                                     params_.height);
 
     if (!near_predators.empty()) {
-      v += p_flock_[i]->separation(s_, p_ds_, near_predators);
+      v += predator.separation(s_, params_.p_ds, near_predators, predators);
     }
     if (!near_boids.empty()) {
-      v += p_flock_[i]->chase(ch_, near_boids);
+      v += predator.chase(ch_, near_boids, boids);
     }
-    p_flock_[i]->boost(p_min_speed_, v);
-    p_flock_[i]->friction(p_max_speed_, v);
-
-    const double theta{v.angle()};
-    p += graphic_par::dt * v;
+    predator.boost(params_.p_min_speed, v);
+    predator.friction(params_.p_max_speed, v);
 
-    triangles::rotateTriangle(p, triangles, theta, i, false, n_boids_);
+    p += params_.dt * v;
     return {p, v};
   }
 }
 
-void Flock::evolve(sf::VertexArray& triangles) const {
-  std::vector<point::Point> b_pos;
-  std::vector<point::Point> b_vel;
+template <typename T>
+std::array<point::BasicPoint<T>, 2> BasicFlock<T>::advanceBirdFused(const size_t i, const bool is_boid) const {
+  const storage::BasicBirdArrays<T>& target = is_boid ? b_arrays_ : p_arrays_;
+  const point::BasicPoint<T> position{target.position(i)};
+  const Sight sight(*this, position, target.velocity(i), is_boid);
+  const T x{position.getX()};
+  const T y{position.getY()};
+  const auto ds{static_cast<T>(is_boid ? params_.b_ds : params_.p_ds)};
+
+  // the sums over the birds of one kind in sight: the offsets towards them, the offsets closer than the separation
+  // distance and the velocities; the mean offset is the cohesion and chase term, the mean position minus our own
+  struct Sums {
+    size_t n;
+    T x;
+    T y;
+    T close_x;
+    T close_y;
+    T vx;
+    T vy;
+  };
+  // the test for a toroidal world is taken once per bird, out of the loop over the candidates
+  const auto gather = [&](const bool of_boids, auto wraps) {
+    const storage::BasicBirdArrays<T>& birds = of_boids ? b_arrays_ : p_arrays_;
+    Sums sums{0, 0, 0, 0, 0, 0, 0};
+    forEachCandidate(i, is_boid, of_boids, [&](const size_t j) {
+      // a bird does not see itself
+      if (is_boid == of_boids && i == j) {
+        return;
+      }
+      T ox{birds.x[j] - x};
+      T oy{birds.y[j] - y};
+      if constexpr (decltype(wraps)::value) {
+        ox = torus::image(ox, sight.period_x);
+        oy = torus::image(oy, sight.period_y);
+      }
+      if (!sight.sees(ox, oy)) {
+        return;
+      }
+      ++sums.n;
+      sums.x += ox;
+      sums.y += oy;
+      if (ox * ox + oy * oy < ds * ds) {
+        sums.close_x += ox;
+        sums.close_y += oy;
+      }
+      sums.vx += birds.vx[j];
+      sums.vy += birds.vy[j];
+    });
+    return sums;
+  };
+  const bool wraps{params_.boundary == Boundary::Torus};
+  const auto sum = [&](const bool of_boids) {
+    return wraps ? gather(of_boids, std::true_type{}) : gather(of_boids, std::false_type{});
+  };
+  const Sums boids{n_boids_ == 0 ? Sums{0, 0, 0, 0, 0, 0, 0} : sum(true)};
+  const Sums predators{n_predators_ == 0 ? Sums{0, 0, 0, 0, 0, 0, 0} : sum(false)};
 
-  for (size_t i = 0; i < n_boids_; ++i) {
-    // Evaluates new positions and velocities for each bird::Boid
-    std::array<point::Point, 2> p = updateBird(triangles, i, true);
-    b_pos.push_back(p[0]);
-    b_vel.push_back(p[1]);
+  if (is_boid) {
+    bird::BasicBoid<T> boid(position, target.velocity(i));
+    point::BasicPoint<T> v =
+        wraps ? boid.getVelocity() : boid.border(params_.margin, params_.turn_factor, params_.width, params_.height);
+
+    if (predators.n != 0) {
+      v += -r_ * point::BasicPoint<T>(predators.x, predators.y);
+    }
+    if (boids.n != 0) {
+      const auto n{static_cast<double>(boids.n)};
+      v += -s_ * point::BasicPoint<T>(boids.close_x, boids.close_y) +
+           a_ * (point::BasicPoint<T>(boids.vx, boids.vy) / n - boid.getVelocity()) +
+           c_ * (point::BasicPoint<T>(boids.x, boids.y) / n);
+    }
+
+    boid.boost(params_.b_min_speed, v);
+    boid.friction(params_.b_max_speed, v);
+    return {position + params_.dt * v, v};
   }
 
-  if (n_predators_ > 0) {
-    std::vector<point::Point> p_pos;
-    std::vector<point::Point> p_vel;
+  bird::BasicPredator<T> predator(position, target.velocity(i));
+  point::BasicPoint<T> v = wraps ? predator.getVelocity()
+                               : predator.border(params_.margin, params_.turn_factor, params_.width, params_.height);
 
-    for (size_t i = 0; i < n_predators_; ++i) {
-      // Evaluates new positions and velocities for each bird::Predator
-      std::array<point::Point, 2> p = updateBird(triangles, i, false);
-      p_pos.push_back(p[0]);
-      p_vel.push_back(p[1]);
-    }
+  if (predators.n != 0) {
+    v += -s_ * point::BasicPoint<T>(predators.close_x, predators.close_y);
+  }
+  if (boids.n != 0) {
+    v += ch_ * (point::BasicPoint<T>(boids.x, boids.y) / static_cast<double>(boids.n));
+  }
+  predator.boost(params_.p_min_speed, v);
+  predator.friction(params_.p_max_speed, v);
+  return {position + params_.dt * v, v};
+}
 
-    for (size_t i = 0; i < n_predators_; ++i) {
-      // Updates bird::Predator objects' positions and velocities
-      p_flock_[i]->setBird(p_pos[i], p_vel[i]);
-    }
+template <typename T>
+void BasicFlock<T>::evolve(sf::VertexArray& triangles) {
+  const profiler::ScopedTimer evolve_timer(profiler_, profiler::Phase::Evolve);
+  step();
+
+  // the triangles are rotated after the step, in one pass over the new state
+  const profiler::ScopedTimer triangles_timer(profiler_, profiler::Phase::Triangles);
+  parallelFor(n_boids_, [&](const size_t begin, const size_t end, size_t) {
+    triangles::rotateTriangles(b_arrays_, true, n_boids_, triangles, begin, end);
+  });
+  parallelFor(n_predators_, [&](const size_t begin, const size_t end, size_t) {
+    triangles::rotateTriangles(p_arrays_, false, n_boids_, triangles, begin, end);
+  });
+}
+
+template <typename T>
+void BasicFlock<T>::evolve() {
+  const profiler::ScopedTimer evolve_timer(profiler_, profiler::Phase::Evolve);
+  step();
+}
+
+template <typename T>
+void BasicFlock<T>::step() {
+  // every bird writes only its own slot of b_next_ / p_next_, so the updates can be split among threads without
+  // synchronization; each worker queries into its own scratch storage
+  scratch_.resize(getThreads());
+  b_next_.resize(n_boids_);
+  p_next_.resize(n_predators_);
+
+  {
+    const profiler::ScopedTimer rules_timer(profiler_, profiler::Phase::Rules);
+
+    parallelFor(n_boids_, [&](const size_t begin, const size_t end, const size_t worker) {
+      for (size_t i = begin; i < end; ++i) {
+        // Evaluates new positions and velocities for each bird::Boid
+        b_next_[i] = advanceBird(i, true, scratch_[worker]);
+      }
+    });
+
+    parallelFor(n_predators_, [&](const size_t begin, const size_t end, const size_t worker) {
+      for (size_t i = begin; i < end; ++i) {
+        // Evaluates new positions and velocities for each bird::Predator
+        p_next_[i] = advanceBird(i, false, scratch_[worker]);
+      }
+    });
   }
 
-  for (size_t i = 0; i < n_boids_; ++i) {
-    // Updates bird::Boid objects' positions and velocities
-    b_flock_[i]->setBird(b_pos[i], b_vel[i]);
-  }
-}
-
-statistics::Statistics Flock::statistics() const {
-  double meanBoids_dist{0.};
-  double meanBoids_dist2{0.};
-  double dev_dist{0.};
-  const int nBoids{static_cast<int>(n_boids_)};
-
-  if (nBoids > 1) {
-    for (auto it = b_flock_.begin(); it != b_flock_.begin() + nBoids; ++it) {
-      std::array<double, 2> sum =
-          std::accumulate(it, b_flock_.begin() + nBoids, std::array<double, 2>{0., 0.},
-                          [&it](std::array<double, 2>& acc, const std::shared_ptr<bird::Bird>& bird) {
-                            acc[0] += (bird->getPosition().distance((*it)->getPosition()));
-                            acc[1] += bird->getPosition().distance((*it)->getPosition()) *
-                                      bird->getPosition().distance((*it)->getPosition());
-                            return acc;
-                          });
-      meanBoids_dist += sum[0];
-      meanBoids_dist2 += sum[1];
-    }
-    const double denominator{nBoids * (nBoids - 1) / 2.};
+  const profiler::ScopedTimer index_timer(profiler_, profiler::Phase::Index);
 
-    meanBoids_dist /= denominator;
-    meanBoids_dist2 /= denominator;
-    dev_dist = std::sqrt(meanBoids_dist2 - meanBoids_dist * meanBoids_dist);
+  for (size_t i = 0; i < n_predators_; ++i) {
+    // Updates bird::Predator objects' positions and velocities
+    p_arrays_.set(i, p_next_[i][0], p_next_[i][1]);
   }
 
-  double meanBoids_speed{0.};
-  double meanBoids_speed2{0.};
+  for (size_t i = 0; i < n_boids_; ++i) {
+    // Updates bird::Boid objects' positions and velocities
+    b_arrays_.set(i, b_next_[i][0], b_next_[i][1]);
+  }
 
-  const std::array<double, 2> sum =
-      std::accumulate(b_flock_.begin(), b_flock_.begin() + nBoids, std::array<double, 2>{0., 0.},
-                      [](std::array<double, 2>& acc, const std::shared_ptr<bird::Bird>& bird) {
-                        acc[0] += bird->getVelocity().module();
-                        acc[1] += bird->getVelocity().module() * bird->getVelocity().module();
-                        return acc;
-                      });
-  assert(nBoids > 0 && "Flock must contain at least one element");
-  meanBoids_speed = sum[0] / nBoids;
-  meanBoids_speed2 = sum[1] / nBoids;
+  ++steps_;
+  if (reorder_every_ != 0 && steps_ % reorder_every_ == 0) {
+    reorder(b_arrays_, b_ids_);
+    reorder(p_arrays_, p_ids_);
+    lists_valid_ = false;
+  }
 
-  const double dev_speed = std::sqrt(meanBoids_speed2 - meanBoids_speed * meanBoids_speed);
+  buildIndex();
+}
 
-  return {meanBoids_dist, dev_dist, meanBoids_speed, dev_speed};
+template <typename T>
+statistics::Statistics BasicFlock<T>::statistics() const { return statistics(statistics::Options()); }
+
+template <typename T>
+statistics::Statistics BasicFlock<T>::statistics(const statistics::Options& options) const {
+  const profiler::ScopedTimer timer(profiler_, profiler::Phase::Statistics);
+  statistics::Options in_world{options};
+  const std::array<T, 2> period{getPeriods()};
+  in_world.period_x = period[0];
+  in_world.period_y = period[1];
+  return statistics::evaluate(b_arrays_, in_world, pool_.get());
 }
-}  // namespace flock
\ No newline at end of file
+
+// the only precisions of the simulation
+template class BasicFlock<float>;
+template class BasicFlock<double>;
+}  // namespace flock
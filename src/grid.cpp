@@ -0,0 +1,133 @@
+#include "../include/grid.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace grid {
+
+namespace {
+
+/// @brief Evaluates the cell containing a coordinate along an axis of a periodic grid.
+/// @param fraction Is the coordinate, relative to the world and in units of its side.
+/// @param cells Is the number of cells along the axis.
+/// @return The index of the cell of the image of the coordinate inside the world.
+size_t wrapped(const double fraction, const size_t cells) {
+  const double f = (fraction - std::floor(fraction)) * static_cast<double>(cells);
+  if (!(f > 0.)) {
+    return 0;
+  }
+  return std::min(static_cast<size_t>(f), cells - 1);
+}
+}  // namespace
+
+Grid::Grid(const double cell_size)
+    : cell_size_{cell_size}, x0_{0.}, y0_{0.}, columns_{1}, rows_{1}, periodic_{false}, width_{0.}, height_{0.} {
+  assert(cell_size_ > 0);
+}
+
+size_t Grid::column(const double x) const {
+  if (periodic_) {
+    return wrapped((x - x0_) / width_, columns_);
+  }
+  const double c = std::floor((x - x0_) / cell_size_);
+  if (!(c > 0.)) {
+    return 0;
+  }
+  return std::min(static_cast<size_t>(c), columns_ - 1);
+}
+
+size_t Grid::row(const double y) const {
+  if (periodic_) {
+    return wrapped((y - y0_) / height_, rows_);
+  }
+  const double r = std::floor((y - y0_) / cell_size_);
+  if (!(r > 0.)) {
+    return 0;
+  }
+  return std::min(static_cast<size_t>(r), rows_ - 1);
+}
+
+size_t Grid::size() const { return indices_.size(); }
+
+template <typename T>
+void Grid::build(const std::vector<T>& x, const std::vector<T>& y) {
+  assert(x.size() == y.size());
+  const size_t n = x.size();
+  indices_.resize(n);
+  periodic_ = false;
+
+  if (n == 0) {
+    cell_start_.assign(2, 0);
+    columns_ = rows_ = 1;
+    return;
+  }
+
+  const auto [x_min, x_max] = std::minmax_element(x.begin(), x.end());
+  const auto [y_min, y_max] = std::minmax_element(y.begin(), y.end());
+  x0_ = *x_min;
+  y0_ = *y_min;
+  const double x1{*x_max};
+  const double y1{*y_max};
+
+  // A bird flying far away would stretch the bounding box over a huge number of empty cells: the number of cells is
+  // bounded, and the positions beyond the last row or column are clamped into it. Clamping never moves two birds
+  // closer than one cell apart further than one cell apart, so the 3x3 neighbourhood of a query stays exhaustive.
+  const size_t max_side = static_cast<size_t>(std::sqrt(static_cast<double>(max_cells_per_bird_ * n))) + 1;
+  const double side{static_cast<double>(max_side)};
+  columns_ = std::min(static_cast<size_t>(std::min((x1 - x0_) / cell_size_, side)) + 1, max_side);
+  rows_ = std::min(static_cast<size_t>(std::min((y1 - y0_) / cell_size_, side)) + 1, max_side);
+  fill(x, y);
+}
+
+template <typename T>
+void Grid::buildPeriodic(const std::vector<T>& x, const std::vector<T>& y, const double x0, const double y0,
+                         const double width, const double height) {
+  assert(x.size() == y.size());
+  assert(width > 0 && height > 0);
+  const size_t n = x.size();
+  indices_.resize(n);
+  periodic_ = true;
+  x0_ = x0;
+  y0_ = y0;
+  width_ = width;
+  height_ = height;
+
+  // cells wider than the cell size are as good, so the bound on their number of build() holds here too
+  const size_t max_side = static_cast<size_t>(std::sqrt(static_cast<double>(max_cells_per_bird_ * n))) + 1;
+  const double side{static_cast<double>(max_side)};
+  columns_ = std::max<size_t>(static_cast<size_t>(std::min(width / cell_size_, side)), 1);
+  rows_ = std::max<size_t>(static_cast<size_t>(std::min(height / cell_size_, side)), 1);
+  fill(x, y);
+}
+
+template <typename T>
+void Grid::fill(const std::vector<T>& x, const std::vector<T>& y) {
+  const size_t n = x.size();
+
+  // counting sort of the indices by cell: a stable pass keeps them increasing within each cell
+  cell_start_.assign(columns_ * rows_ + 1, 0);
+  cell_of_.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    cell_of_[i] = row(y[i]) * columns_ + column(x[i]);
+    ++cell_start_[cell_of_[i] + 1];
+  }
+  for (size_t k = 1; k < cell_start_.size(); ++k) {
+    cell_start_[k] += cell_start_[k - 1];
+  }
+
+  cursor_.assign(cell_start_.begin(), cell_start_.end() - 1);
+  for (size_t i = 0; i < n; ++i) {
+    indices_[cursor_[cell_of_[i]]++] = i;
+  }
+  assert(cell_start_.back() == n);
+}
+
+template void Grid::build(const std::vector<float>&, const std::vector<float>&);
+template void Grid::build(const std::vector<double>&, const std::vector<double>&);
+template void Grid::buildPeriodic(const std::vector<float>&, const std::vector<float>&, double, double, double,
+                                  double);
+template void Grid::buildPeriodic(const std::vector<double>&, const std::vector<double>&, double, double, double,
+                                  double);
+}  // namespace grid
@@ -0,0 +1,235 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "../include/config.hpp"
+#include "../include/flock.hpp"
+#include "../include/profiler.hpp"
+#include "../include/recorder.hpp"
+#include "../include/rng.hpp"
+#include "../include/statistics.hpp"
+
+namespace {
+
+/// @brief Collects the options of a headless run.
+struct Options {
+  ///@brief Are the settings shared with Boids, see config::set().
+  config::Config settings;
+  size_t steps{1000};
+  size_t every{15};
+  std::string output;
+  std::string profile;
+  std::string load;
+  std::string save;
+  std::string record;
+  ///@brief States whether the birds are simulated in single precision.
+  bool single{false};
+  statistics::Options stats;
+  recorder::Options recording;
+};
+
+void printUsage(std::ostream& out) {
+  out << "Usage: Boids.headless [options]\n"
+      << "  --steps K         number of steps to simulate (default 1000)\n"
+      << "  --every K         evaluate the statistics every K steps (default 15)\n"
+      << "  --error E         target standard error of the sampled mean distance, in pixels (default 1)\n"
+      << "  --output FILE     write the statistics to FILE instead of the standard output\n"
+      << "  --profile FILE    write the timings of the phases of the steps to FILE\n"
+      << "  --load FILE       start from the snapshot in FILE, with its birds and parameters\n"
+      << "  --save FILE       write a snapshot of the final state to FILE\n"
+      << "  --record FILE     write the trajectory of the birds to FILE\n"
+      << "  --record-every K  record every K steps (default 1)\n"
+      << "  --encoding ENC    'float32', 'float16' or 'int16' values in the trajectory (default float32)\n"
+      << "  --precision P     'single' or 'double' precision of the simulation (default double)\n"
+      << "Settings shared with Boids, 1000 boids, 0 predators and exact statistics unless given:\n";
+  config::printKeys(out);
+}
+
+Options parseOptions(const int argc, char* argv[]) {
+  Options options;
+  for (int k = 1; k < argc; ++k) {
+    const std::string flag{argv[k]};
+    if (flag == "--help" || flag == "-h") {
+      printUsage(std::cout);
+      std::exit(EXIT_SUCCESS);
+    }
+    if (k + 1 == argc) {
+      throw std::domain_error("Error: missing value for option " + flag + ".");
+    }
+    const std::string value{argv[++k]};
+
+    if (flag == "--steps") {
+      options.steps = config::toSize(flag, value);
+    } else if (flag == "--every") {
+      options.every = config::toSize(flag, value);
+    } else if (flag == "--error") {
+      options.stats.error_bound = config::toDouble(flag, value);
+    } else if (flag == "--output") {
+      options.output = value;
+    } else if (flag == "--profile") {
+      options.profile = value;
+    } else if (flag == "--load") {
+      options.load = value;
+    } else if (flag == "--save") {
+      options.save = value;
+    } else if (flag == "--record") {
+      options.record = value;
+    } else if (flag == "--record-every") {
+      options.recording.every = config::toSize(flag, value);
+    } else if (flag == "--encoding") {
+      if (value == "float32") {
+        options.recording.encoding = recorder::Encoding::Float32;
+      } else if (value == "float16") {
+        options.recording.encoding = recorder::Encoding::Float16;
+      } else if (value == "int16") {
+        options.recording.encoding = recorder::Encoding::Int16;
+      } else {
+        throw std::domain_error("Error: unknown trajectory encoding " + value + ".");
+      }
+    } else if (flag == "--precision") {
+      if (value != "single" && value != "double") {
+        throw std::domain_error("Error: unknown precision " + value + ".");
+      }
+      options.single = value == "single";
+    } else if (flag == "--config") {
+      config::loadFile(options.settings, value);
+    } else if (flag.compare(0, 2, "--") == 0) {
+      config::set(options.settings, flag.substr(2), value);
+    } else {
+      throw std::domain_error("Error: unknown option " + flag + ".");
+    }
+  }
+  options.stats.mode = options.settings.stats_mode.value_or(statistics::Mode::Exact);
+
+  if (!(options.stats.error_bound > 0.)) {
+    throw std::domain_error("Error: the statistics error bound must be strictly positive.");
+  }
+  if (options.every == 0) {
+    throw std::domain_error("Error: the statistics interval must be strictly positive.");
+  }
+  if (options.recording.every == 0) {
+    throw std::domain_error("Error: the recording interval must be strictly positive.");
+  }
+  return options;
+}
+
+void writeRow(std::ostream& out, const size_t step, const statistics::Statistics& stats) {
+  out << step << ',' << stats.mean_dist << ',' << stats.dev_dist << ',' << stats.mean_speed << ',' << stats.dev_speed
+      << ',' << stats.mean_dist_error << '\n';
+}
+
+/// @brief Runs the simulation with the birds in precision T, writing the statistics to out.
+/// @return The exit status of the program.
+template <typename T>
+int run(const Options& options, std::ostream& out) {
+  const config::Config& settings = options.settings;
+  const std::uint64_t seed{settings.seed.value_or(rng::clockSeed())};
+  flock::BasicFlock<T> flock(settings.n_boids.value_or(1000), settings.n_predators.value_or(0));
+  try {
+    flock.setFlightParams(settings.s.value_or(0.1), settings.a.value_or(0.1), settings.c.value_or(0.004));
+    flock.setParameters(settings.parameters);
+    flock.setThreads(settings.threads);
+    flock.setFieldOfView(settings.field_of_view);
+    flock.setSkin(settings.skin);
+    flock.setReorder(settings.reorder_every);
+    if (options.load.empty()) {
+      flock.generateBirds(seed, settings.distribution);
+    } else {
+      flock.load(options.load);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << '\n';
+    return EXIT_FAILURE;
+  }
+
+  profiler::Profiler profiler(1000);
+  if (!options.profile.empty()) {
+    flock.setProfiler(&profiler);
+  }
+
+  std::unique_ptr<recorder::Recorder> recording;
+  if (!options.record.empty()) {
+    try {
+      recording = std::make_unique<recorder::Recorder>(options.record, flock.getBoidArrays().size(),
+                                                       flock.getPredatorArrays().size(), options.recording);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << '\n';
+      return EXIT_FAILURE;
+    }
+    recording->record(0, flock.getBoidArrays(), flock.getPredatorArrays(), flock.getBoidIds(),
+                      flock.getPredatorIds());
+  }
+
+  out << std::setprecision(10) << "step,mean_dist,dev_dist,mean_speed,dev_speed,mean_dist_error\n";
+  writeRow(out, 0, flock.statistics(options.stats));
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t step = 1; step <= options.steps; ++step) {
+    flock.evolve();
+    if (recording) {
+      recording->record(step, flock.getBoidArrays(), flock.getPredatorArrays(), flock.getBoidIds(),
+                        flock.getPredatorIds());
+    }
+    if (step % options.every == 0) {
+      writeRow(out, step, flock.statistics(options.stats));
+    }
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cerr << options.steps << " steps of " << flock.getFlockSize() << " birds on " << flock.getThreads()
+            << " threads in " << elapsed.count() << " s ("
+            << static_cast<double>(options.steps) / elapsed.count() << " steps/s)";
+  if (options.load.empty()) {
+    std::cerr << ", seed " << seed;
+  }
+  std::cerr << '\n';
+
+  if (!options.save.empty()) {
+    try {
+      flock.save(options.save);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << '\n';
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!options.profile.empty()) {
+    std::ofstream profile(options.profile);
+    if (!profile) {
+      std::cerr << "Error: cannot open " << options.profile << " for writing.\n";
+      return EXIT_FAILURE;
+    }
+    profiler.dump(profile);
+  }
+  return EXIT_SUCCESS;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  try {
+    options = parseOptions(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n\n";
+    printUsage(std::cerr);
+    return EXIT_FAILURE;
+  }
+
+  std::ofstream file;
+  if (!options.output.empty()) {
+    file.open(options.output);
+    if (!file) {
+      std::cerr << "Error: cannot open " << options.output << " for writing.\n";
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream& out = options.output.empty() ? std::cout : file;
+
+  return options.single ? run<float>(options, out) : run<double>(options, out);
+}
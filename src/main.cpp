@@ -1,89 +1,149 @@
 #include <SFML/Graphics.hpp>
-#include <SFML/Graphics/Color.hpp>
 #include <SFML/System/Vector2.hpp>
-#include <iomanip>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
-#include <sstream>
 #include <string>
+#include <thread>
 
+#include "../include/config.hpp"
 #include "../include/flock.hpp"
 #include "../include/graphic.hpp"
-#include "../include/triangle.hpp"
-
-int main() {
-  statistics::Statistics statistics;
+#include "../include/overlay.hpp"
+#include "../include/profiler.hpp"
+#include "../include/renderer.hpp"
+#include "../include/rng.hpp"
+#include "../include/simulation.hpp"
+#include "../include/statistics.hpp"
+
+int main(int argc, char* argv[]) {
   unsigned int counter{0};
 
-  size_t nBoids = graphic_par::getPositiveInteger("Enter the number of boids to simulate: ", std::cin, std::cout, true);
-  size_t nPredators =
-      graphic_par::getPositiveInteger("Enter the number of predators to simulate: ", std::cin, std::cout, false);
-
-  flock::Flock flock(nBoids, nPredators);
-  flock.setFlightParams(std::cin, std::cout);
+  // the settings given on the command line or in a --config file; the numbers of birds and the coefficients which
+  // are not given are asked for
+  config::Config settings;
+  try {
+    if (argc == 2 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")) {
+      std::cout << "Usage: Boids [options]\n";
+      config::printKeys(std::cout);
+      return EXIT_SUCCESS;
+    }
+    config::parseArguments(settings, argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n\nUsage: Boids [options]\n";
+    config::printKeys(std::cerr);
+    return EXIT_FAILURE;
+  }
 
-  flock.generateBirds();
+  const size_t nBoids =
+      settings.n_boids ? *settings.n_boids
+                       : graphic_par::getPositiveInteger("Enter the number of boids to simulate: ", std::cin, std::cout,
+                                                         true);
+  const size_t nPredators =
+      settings.n_predators ? *settings.n_predators
+                           : graphic_par::getPositiveInteger("Enter the number of predators to simulate: ", std::cin,
+                                                             std::cout, false);
 
-  sf::VertexArray triangles(sf::Triangles, 3 * (flock.getFlockSize()));
-  triangles::createTriangles(flock, triangles);
+  flock::Flock flock(nBoids, nPredators);
+  try {
+    if (settings.hasFlightParams()) {
+      flock.setFlightParams(settings.s.value_or(0.1), settings.a.value_or(0.1), settings.c.value_or(0.004));
+    } else {
+      flock.setFlightParams(std::cin, std::cout);
+    }
+    flock.setParameters(settings.parameters);
+    flock.setFieldOfView(settings.field_of_view);
+    flock.setSkin(settings.skin);
+    flock.setReorder(settings.reorder_every);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << '\n';
+    return EXIT_FAILURE;
+  }
 
-  sf::VertexBuffer stats_rectangle = graphic_par::createRectangle(graphic_par::stats_rectangle, 50, 50, 50);
+  // the threads are set first, so that large flocks are generated in parallel
+  flock.setThreads(settings.threads);
+  // the seed is printed so that an interesting flock can be generated again with --seed
+  const std::uint64_t seed{settings.seed.value_or(rng::clockSeed())};
+  std::cout << "Seed: " << seed << '\n';
+  flock.generateBirds(seed, settings.distribution);
+
+  overlay::StatsOverlay stats_overlay("arial.ttf", static_cast<float>(flock.getParameters().height));
+  // above a few thousand boids the exact O(N^2) statistics would cost more than a frame
+  const statistics::Mode stats_mode{
+      settings.stats_mode.value_or(nBoids > 2000 ? statistics::Mode::Sampled : statistics::Mode::Exact)};
+  statistics::Options stats_options(stats_mode, 1., 1'000'000, 0);
+  // the frames are copies of the birds, so the distances are taken across the edges of a torus here, as
+  // flock::Flock::statistics() does
+  stats_options.period_x = flock.getPeriods()[0];
+  stats_options.period_y = flock.getPeriods()[1];
+
+  // percentiles over the last 4 seconds at 60 fps
+  profiler::Profiler profiler(240);
+  flock.setProfiler(&profiler);
 
   sf::RenderWindow window(
-      {static_cast<unsigned int>(graphic_par::window_width), static_cast<unsigned int>(graphic_par::window_height)},
+      {static_cast<unsigned int>(settings.parameters.width), static_cast<unsigned int>(settings.parameters.height)},
       "Flock simulation", sf::Style::Titlebar);
 
   window.setPosition(sf::Vector2i(10, 50));
   window.setFramerateLimit(60);
   sf::Event event{};
 
+  // the shaders need the context of the window; without them the triangles are rotated on the CPU
+  renderer::BirdRenderer birds(flock, settings.prefer_gpu);
+  std::cout << "Drawing the birds on the " << (birds.getPath() == renderer::Path::Gpu ? "GPU" : "CPU") << ".\n";
+
+  // from now on the flock is advanced on the simulation thread only, at a rate independent of the frame rate; the
+  // window draws the latest complete state
+  simulation::Simulation simulation(flock, settings.steps_per_second);
+
   while (window.isOpen()) {
-    while (window.pollEvent(event)) {
-      switch (event.type) {
-        case sf::Event::Closed:
-          window.close();
-          break;
-
-        default:
-          break;
+    {
+      const profiler::ScopedTimer timer(&profiler, profiler::Phase::Events);
+      while (window.pollEvent(event)) {
+        switch (event.type) {
+          case sf::Event::Closed:
+            window.close();
+            break;
+
+          default:
+            break;
+        }
       }
     }
 
-    sf::Text text;
-    sf::Font font;
-
-    if (!font.loadFromFile("arial.ttf")) {
-      throw std::runtime_error("Error: failed to load font.\n");
+    if (simulation.update()) {
+      const profiler::ScopedTimer timer(&profiler, profiler::Phase::Triangles);
+      birds.update(simulation.frame().boids, simulation.frame().predators);
     }
 
-    text.setFont(font);
-    text.setPosition(sf::Vector2f(10, 10));
-
-    std::string text_display;
-
     if (counter % 15 == 0) {
-      statistics = flock.statistics();
-    }
-
-    std::ostringstream out;
-
-    out << "Mean distance: " << std::fixed << std::setprecision(0) << statistics.mean_dist << "\n"
-        << "Distance standard deviation: " << std::fixed << std::setprecision(0) << statistics.dev_dist << "\n\n"
-        << "Mean speed: " << std::fixed << std::setprecision(2) << statistics.mean_speed << "\n"
-        << "Speed standard deviation: " << std::fixed << std::setprecision(2) << statistics.dev_speed;
+      statistics::Statistics stats;
+      {
+        const profiler::ScopedTimer timer(&profiler, profiler::Phase::Statistics);
+        stats = statistics::evaluate(simulation.frame().boids, stats_options, nullptr);
+      }
 
-    text.setString(out.str());
-    text.setCharacterSize(24);  // in pixels
-    text.setFillColor(sf::Color::White);
+      // the text is rebuilt only when the statistics change
+      const profiler::ScopedTimer timer(&profiler, profiler::Phase::Overlay);
+      stats_overlay.update(stats);
+      stats_overlay.updateProfile(profiler.report());
+    }
 
     ++counter;  // might overflow, it would restart from 0, which is compatible with the logic of the program.
-    window.clear();
 
-    flock.evolve(triangles);
+    {
+      const profiler::ScopedTimer timer(&profiler, profiler::Phase::Draw);
+      window.clear();
 
-    window.draw(triangles);
-    window.draw(stats_rectangle);
-    window.draw(text);
+      window.draw(birds);
+      window.draw(stats_overlay);
 
-    window.display();
+      window.display();
+    }
   }
+
+  std::ofstream profile("profile.csv");
+  profiler.dump(profile);
 }
@@ -0,0 +1,79 @@
+#include "../include/morton.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace morton {
+
+namespace {
+
+/// @brief Spreads the 16 bits of a value over the even bits of a 32 bit one.
+std::uint32_t spread(const std::uint16_t value) {
+  std::uint32_t v{value};
+  v = (v | (v << 8)) & 0x00ff00ffu;
+  v = (v | (v << 4)) & 0x0f0f0f0fu;
+  v = (v | (v << 2)) & 0x33333333u;
+  v = (v | (v << 1)) & 0x55555555u;
+  return v;
+}
+
+/// @brief Maps a coordinate in [low, low + 65535 / scale] onto [0, 65535].
+template <typename T>
+std::uint16_t quantize(const T value, const double low, const double scale) {
+  const double q{(static_cast<double>(value) - low) * scale};
+  return static_cast<std::uint16_t>(std::clamp(q, 0., 65535.));
+}
+}  // namespace
+
+std::uint32_t encode(const std::uint16_t x, const std::uint16_t y) { return spread(x) | (spread(y) << 1); }
+
+template <typename T>
+void order(const std::vector<T>& x, const std::vector<T>& y, std::vector<size_t>& permutation) {
+  assert(x.size() == y.size());
+  const size_t n{x.size()};
+  permutation.resize(n);
+  if (n == 0) {
+    return;
+  }
+
+  const auto [x_min, x_max] = std::minmax_element(x.begin(), x.end());
+  const auto [y_min, y_max] = std::minmax_element(y.begin(), y.end());
+  const double width{static_cast<double>(*x_max) - static_cast<double>(*x_min)};
+  const double height{static_cast<double>(*y_max) - static_cast<double>(*y_min)};
+  // the same scale on both axes keeps the cells of the curve square
+  const double side{std::max(width, height)};
+  const double scale{side > 0. ? 65535. / side : 0.};
+
+  std::vector<std::uint32_t> codes(n);
+  for (size_t i = 0; i < n; ++i) {
+    codes[i] = encode(quantize(x[i], *x_min, scale), quantize(y[i], *y_min, scale));
+    permutation[i] = i;
+  }
+
+  // four stable counting passes over the bytes of the codes, the least significant first
+  std::vector<std::uint32_t> sorted_codes(n);
+  std::vector<size_t> sorted_order(n);
+  for (unsigned shift = 0; shift < 32; shift += 8) {
+    std::array<size_t, 257> start{};
+    for (const std::uint32_t code : codes) {
+      ++start[((code >> shift) & 0xffu) + 1];
+    }
+    for (size_t digit = 0; digit < 256; ++digit) {
+      start[digit + 1] += start[digit];
+    }
+    for (size_t i = 0; i < n; ++i) {
+      const size_t k{start[(codes[i] >> shift) & 0xffu]++};
+      sorted_codes[k] = codes[i];
+      sorted_order[k] = permutation[i];
+    }
+    codes.swap(sorted_codes);
+    permutation.swap(sorted_order);
+  }
+}
+
+template void order(const std::vector<float>&, const std::vector<float>&, std::vector<size_t>&);
+template void order(const std::vector<double>&, const std::vector<double>&, std::vector<size_t>&);
+}  // namespace morton
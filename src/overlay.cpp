@@ -0,0 +1,66 @@
+#include "../include/overlay.hpp"
+
+#include <array>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "../include/graphic.hpp"
+#include "../include/statistics.hpp"
+
+namespace overlay {
+
+namespace {
+
+sf::VertexBuffer createBackground(const float height) {
+  std::array<sf::Vertex, 4> rectangle{
+      sf::Vertex(sf::Vector2f(0.f, 0.f)), sf::Vertex(sf::Vector2f(0.f, height)),
+      sf::Vertex(sf::Vector2f(graphic_par::stats_width, 0.f)),
+      sf::Vertex(sf::Vector2f(graphic_par::stats_width, height))};
+  return graphic_par::createRectangle(rectangle, 50, 50, 50);
+}
+}  // namespace
+
+std::string formatStatistics(const statistics::Statistics& stats) {
+  std::ostringstream out;
+
+  out << "Mean distance: " << std::fixed << std::setprecision(0) << stats.mean_dist;
+  if (stats.mean_dist_error > 0.) {
+    out << " +/- " << std::fixed << std::setprecision(1) << stats.mean_dist_error;
+  }
+  out << "\n"
+      << "Distance standard deviation: " << std::fixed << std::setprecision(0) << stats.dev_dist << "\n\n"
+      << "Mean speed: " << std::fixed << std::setprecision(2) << stats.mean_speed << "\n"
+      << "Speed standard deviation: " << std::fixed << std::setprecision(2) << stats.dev_speed;
+
+  return out.str();
+}
+
+StatsOverlay::StatsOverlay(const std::string& font_path, const float height) : background_{createBackground(height)} {
+  if (!font_.loadFromFile(font_path)) {
+    throw std::runtime_error("Error: failed to load font.\n");
+  }
+
+  text_.setFont(font_);
+  text_.setPosition(sf::Vector2f(10, 10));
+  text_.setCharacterSize(24);  // in pixels
+  text_.setFillColor(sf::Color::White);
+  update(statistics::Statistics());
+
+  profile_text_.setFont(font_);
+  profile_text_.setPosition(sf::Vector2f(10, 250));
+  profile_text_.setCharacterSize(16);  // in pixels
+  profile_text_.setFillColor(sf::Color(200, 200, 200));
+}
+
+void StatsOverlay::update(const statistics::Statistics& stats) { text_.setString(formatStatistics(stats)); }
+
+void StatsOverlay::updateProfile(const std::string& profile) { profile_text_.setString(profile); }
+
+void StatsOverlay::draw(sf::RenderTarget& target, const sf::RenderStates states) const {
+  target.draw(background_, states);
+  target.draw(text_, states);
+  target.draw(profile_text_, states);
+}
+}  // namespace overlay
@@ -5,50 +5,83 @@
 
 namespace point {
 
-Point::Point() : x_{0.}, y_{0.} {}
-Point::Point(const double x, const double y) : x_{x}, y_{y} {}
+template <typename T>
+BasicPoint<T>::BasicPoint() : x_{0.}, y_{0.} {}
+template <typename T>
+BasicPoint<T>::BasicPoint(const T x, const T y) : x_{x}, y_{y} {}
 
-double Point::getX() const { return x_; }
-double Point::getY() const { return y_; }
+template <typename T>
+T BasicPoint<T>::getX() const { return x_; }
+template <typename T>
+T BasicPoint<T>::getY() const { return y_; }
 
-double Point::module() const { return std::sqrt(x_ * x_ + y_ * y_); }
-double Point::distance(const Point& p) const {
+template <typename T>
+T BasicPoint<T>::module() const { return std::sqrt(x_ * x_ + y_ * y_); }
+template <typename T>
+T BasicPoint<T>::distance(const BasicPoint& p) const {
   return std::sqrt((x_ - p.getX()) * (x_ - p.getX()) + (y_ - p.getY()) * (y_ - p.getY()));
 }
 
-float Point::angle() const { return static_cast<float>(std::atan2(y_, x_) + M_PI / 2); }  // output in radiant
+template <typename T>
+float BasicPoint<T>::angle() const {
+  return static_cast<float>(std::atan2(y_, x_) + M_PI / 2);  // output in radiant
+}
 
-Point& Point::operator+=(const Point& a) {
+template <typename T>
+BasicPoint<T>& BasicPoint<T>::operator+=(const BasicPoint& a) {
   x_ += a.getX();
   y_ += a.getY();
   return *this;
 }
 
-Point operator+(const Point& a, const Point& b) {
-  const Point sum{a.getX() + b.getX(), a.getY() + b.getY()};
+template <typename T>
+BasicPoint<T> operator+(const BasicPoint<T>& a, const BasicPoint<T>& b) {
+  const BasicPoint<T> sum{a.getX() + b.getX(), a.getY() + b.getY()};
   return sum;
 }
 
-Point operator-(const Point& a, const Point& b) {
-  const Point diff{a.getX() - b.getX(), a.getY() - b.getY()};
+template <typename T>
+BasicPoint<T> operator-(const BasicPoint<T>& a, const BasicPoint<T>& b) {
+  const BasicPoint<T> diff{a.getX() - b.getX(), a.getY() - b.getY()};
   return diff;
 }
 
-Point operator*(const double scalar, const Point& a) {
-  const Point mult{scalar * a.getX(), scalar * a.getY()};
+template <typename T>
+BasicPoint<T> operator*(const double scalar, const BasicPoint<T>& a) {
+  const T factor{static_cast<T>(scalar)};
+  const BasicPoint<T> mult{factor * a.getX(), factor * a.getY()};
   return mult;
 }
 
-Point operator/(const Point& a, const double scalar) {
+template <typename T>
+BasicPoint<T> operator/(const BasicPoint<T>& a, const double scalar) {
   assert(scalar != 0);
-  const Point div{a.getX() / scalar, a.getY() / scalar};
+  const T divisor{static_cast<T>(scalar)};
+  const BasicPoint<T> div{a.getX() / divisor, a.getY() / divisor};
   return div;
 }
 
-bool operator==(const Point& a, const Point& b) { return a.getX() == b.getX() && a.getY() == b.getY(); }
+template <typename T>
+bool operator==(const BasicPoint<T>& a, const BasicPoint<T>& b) { return a.getX() == b.getX() && a.getY() == b.getY(); }
 
-sf::Vertex Point::operator()() const {
+template <typename T>
+sf::Vertex BasicPoint<T>::operator()() const {
   const sf::Vertex out = {sf::Vector2f(static_cast<float>(x_), static_cast<float>(y_))};
   return out;
 }
+
+// the only precisions of the simulation
+template class BasicPoint<float>;
+template class BasicPoint<double>;
+
+template BasicPoint<float> operator+(const BasicPoint<float>&, const BasicPoint<float>&);
+template BasicPoint<double> operator+(const BasicPoint<double>&, const BasicPoint<double>&);
+template BasicPoint<float> operator-(const BasicPoint<float>&, const BasicPoint<float>&);
+template BasicPoint<double> operator-(const BasicPoint<double>&, const BasicPoint<double>&);
+template BasicPoint<float> operator*(double, const BasicPoint<float>&);
+template BasicPoint<double> operator*(double, const BasicPoint<double>&);
+template BasicPoint<float> operator/(const BasicPoint<float>&, double);
+template BasicPoint<double> operator/(const BasicPoint<double>&, double);
+template bool operator==(const BasicPoint<float>&, const BasicPoint<float>&);
+template bool operator==(const BasicPoint<double>&, const BasicPoint<double>&);
 }  // namespace point
@@ -0,0 +1,87 @@
+#include "../include/pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace pool {
+
+ThreadPool::ThreadPool(const size_t n_threads)
+    : generation_{0}, running_{0}, stop_{false}, task_{nullptr}, n_{0}, grain_{1}, next_{0} {
+  assert(n_threads > 0);
+  for (size_t w = 1; w < n_threads; ++w) {
+    workers_.emplace_back(&ThreadPool::loop, this, w);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+size_t ThreadPool::size() const { return workers_.size() + 1; }
+
+void ThreadPool::work(const size_t worker) {
+  for (size_t begin = next_.fetch_add(grain_); begin < n_; begin = next_.fetch_add(grain_)) {
+    (*task_)(begin, std::min(begin + grain_, n_), worker);
+  }
+}
+
+void ThreadPool::loop(const size_t worker) {
+  size_t seen{0};
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_.wait(lock, [this, seen] { return stop_ || generation_ != seen; });
+      if (stop_) {
+        return;
+      }
+      seen = generation_;
+    }
+
+    work(worker);
+
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (--running_ == 0) {
+      done_.notify_one();
+    }
+  }
+}
+
+void ThreadPool::parallelFor(const size_t n, const std::function<void(size_t, size_t, size_t)>& task) {
+  if (n == 0) {
+    return;
+  }
+  if (workers_.empty()) {
+    task(0, n, 0);
+    return;
+  }
+
+  const std::lock_guard<std::mutex> submit(submit_mutex_);
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    n_ = n;
+    // a few chunks per worker balance the load without making the shared counter a hot spot
+    grain_ = std::max<size_t>(1, n / (8 * size()));
+    next_ = 0;
+    running_ = workers_.size();
+    ++generation_;
+  }
+  start_.notify_all();
+
+  work(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return running_ == 0; });
+  task_ = nullptr;
+}
+}  // namespace pool
@@ -0,0 +1,131 @@
+#include "../include/profiler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace profiler {
+
+const char* phaseName(const Phase phase) {
+  switch (phase) {
+    case Phase::Events:
+      return "events";
+    case Phase::Evolve:
+      return "evolve";
+    case Phase::Rules:
+      return "rules";
+    case Phase::Index:
+      return "index";
+    case Phase::Triangles:
+      return "triangles";
+    case Phase::Statistics:
+      return "statistics";
+    case Phase::Overlay:
+      return "overlay";
+    case Phase::Draw:
+      return "draw";
+  }
+  return "";
+}
+
+namespace {
+
+/// @brief Evaluates a percentile of sorted samples, with the nearest-rank method.
+double percentile(const std::vector<double>& sorted, const double p) {
+  const auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+  return sorted[std::max<size_t>(rank, 1) - 1];
+}
+}  // namespace
+
+Profiler::Profiler(const size_t window_size) : window_size_{window_size}, series_{} {
+  assert(window_size > 0);
+  for (Series& series : series_) {
+    series.window.reserve(window_size_);
+    series.next = 0;
+    series.count = 0;
+    series.total = 0.;
+    series.max = 0.;
+  }
+}
+
+void Profiler::record(const Phase phase, const double milliseconds) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  Series& series = series_[static_cast<size_t>(phase)];
+
+  if (series.window.size() < window_size_) {
+    series.window.push_back(milliseconds);
+  } else {
+    series.window[series.next] = milliseconds;
+  }
+  series.next = (series.next + 1) % window_size_;
+  ++series.count;
+  series.total += milliseconds;
+  series.max = std::max(series.max, milliseconds);
+}
+
+Summary Profiler::summary(const Phase phase) const {
+  std::vector<double> sorted;
+  Summary result{0, 0., 0., 0., 0., 0.};
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const Series& series = series_[static_cast<size_t>(phase)];
+    if (series.count == 0) {
+      return result;
+    }
+    sorted = series.window;
+    result.count = series.count;
+    result.mean = series.total / static_cast<double>(series.count);
+    result.max = series.max;
+  }
+
+  std::sort(sorted.begin(), sorted.end());
+  result.p50 = percentile(sorted, 0.50);
+  result.p95 = percentile(sorted, 0.95);
+  result.p99 = percentile(sorted, 0.99);
+  return result;
+}
+
+std::string Profiler::report() const {
+  std::ostringstream out;
+  out << "Frame phases (ms)   p50 / p95 / p99";
+
+  for (size_t p = 0; p < n_phases; ++p) {
+    const auto phase = static_cast<Phase>(p);
+    const Summary s = summary(phase);
+    if (s.count > 0) {
+      out << "\n" << phaseName(phase) << ": " << std::fixed << std::setprecision(2) << s.p50 << " / " << s.p95
+          << " / " << s.p99;
+    }
+  }
+  return out.str();
+}
+
+void Profiler::dump(std::ostream& out) const {
+  out << "phase,count,mean_ms,max_ms,p50_ms,p95_ms,p99_ms\n";
+
+  for (size_t p = 0; p < n_phases; ++p) {
+    const auto phase = static_cast<Phase>(p);
+    const Summary s = summary(phase);
+    out << phaseName(phase) << ',' << s.count << ',' << s.mean << ',' << s.max << ',' << s.p50 << ',' << s.p95 << ','
+        << s.p99 << '\n';
+  }
+}
+
+ScopedTimer::ScopedTimer(Profiler* const profiler, const Phase phase)
+    : profiler_{profiler}, phase_{phase}, start_{profiler != nullptr ? std::chrono::steady_clock::now()
+                                                                      : std::chrono::steady_clock::time_point{}} {}
+
+ScopedTimer::~ScopedTimer() {
+  if (profiler_ != nullptr) {
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_;
+    profiler_->record(phase_, elapsed.count());
+  }
+}
+}  // namespace profiler
@@ -0,0 +1,448 @@
+#include "../include/recorder.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../include/storage.hpp"
+
+namespace recorder {
+
+static_assert(std::is_trivially_copyable_v<Header>, "Header must be written byte by byte");
+static_assert(sizeof(Header) % alignof(std::uint64_t) == 0, "the frames following Header must be aligned");
+
+namespace {
+
+///@brief Is the number of frames record() may queue before it waits for the writer.
+constexpr size_t queue_depth{4};
+
+size_t elementSize(const Encoding encoding) { return encoding == Encoding::Float32 ? sizeof(float) : 2; }
+
+size_t frameBytes(const Encoding encoding, const size_t n_birds) {
+  const size_t bytes{sizeof(std::uint64_t) + 4 * n_birds * elementSize(encoding)};
+  return (bytes + 7) / 8 * 8;
+}
+
+size_t pageSize() { return static_cast<size_t>(::sysconf(_SC_PAGESIZE)); }
+
+/// @brief Maps the part of a file from offset on; the mapping starts at the page holding offset.
+void* mapFrom(const int fd, const size_t offset, const size_t length, size_t& mapped_length, void*& base) {
+  const size_t start{offset / pageSize() * pageSize()};
+  mapped_length = length + (offset - start);
+  base = ::mmap(nullptr, mapped_length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, static_cast<off_t>(start));
+  return base == MAP_FAILED ? nullptr : static_cast<unsigned char*>(base) + (offset - start);
+}
+
+/// @brief Encodes an array of n values at out, advancing out past them.
+void encode(const std::vector<double>& values, const Header& header, const bool is_position, unsigned char*& out) {
+  const size_t n{values.size()};
+  switch (static_cast<Encoding>(header.encoding)) {
+    case Encoding::Float32:
+      for (size_t i = 0; i < n; ++i) {
+        const auto value = static_cast<float>(values[i]);
+        std::memcpy(out + i * sizeof(float), &value, sizeof(float));
+      }
+      out += n * sizeof(float);
+      break;
+    case Encoding::Float16:
+      for (size_t i = 0; i < n; ++i) {
+        const std::uint16_t bits{toHalf(static_cast<float>(values[i]))};
+        std::memcpy(out + 2 * i, &bits, 2);
+      }
+      out += 2 * n;
+      break;
+    case Encoding::Int16:
+      for (size_t i = 0; i < n; ++i) {
+        // positions as unsigned offsets over [min_position, max_position], velocities as signed fractions of max_speed
+        std::uint16_t bits;
+        if (is_position) {
+          const double unit{(values[i] - header.min_position) / (header.max_position - header.min_position)};
+          bits = static_cast<std::uint16_t>(std::lround(std::clamp(unit, 0., 1.) * 65535.));
+        } else {
+          const double unit{values[i] / header.max_speed};
+          const auto level = static_cast<std::int16_t>(std::lround(std::clamp(unit, -1., 1.) * 32767.));
+          std::memcpy(&bits, &level, 2);
+        }
+        std::memcpy(out + 2 * i, &bits, 2);
+      }
+      out += 2 * n;
+      break;
+  }
+}
+
+/// @brief Decodes an array of values.size() values at in, advancing in past them.
+void decode(const unsigned char*& in, const Header& header, const bool is_position, std::vector<double>& values) {
+  const size_t n{values.size()};
+  switch (static_cast<Encoding>(header.encoding)) {
+    case Encoding::Float32:
+      for (size_t i = 0; i < n; ++i) {
+        float value;
+        std::memcpy(&value, in + i * sizeof(float), sizeof(float));
+        values[i] = value;
+      }
+      in += n * sizeof(float);
+      break;
+    case Encoding::Float16:
+      for (size_t i = 0; i < n; ++i) {
+        std::uint16_t bits;
+        std::memcpy(&bits, in + 2 * i, 2);
+        values[i] = fromHalf(bits);
+      }
+      in += 2 * n;
+      break;
+    case Encoding::Int16:
+      for (size_t i = 0; i < n; ++i) {
+        if (is_position) {
+          std::uint16_t bits;
+          std::memcpy(&bits, in + 2 * i, 2);
+          values[i] = header.min_position + (header.max_position - header.min_position) * bits / 65535.;
+        } else {
+          std::int16_t level;
+          std::memcpy(&level, in + 2 * i, 2);
+          values[i] = header.max_speed * level / 32767.;
+        }
+      }
+      in += 2 * n;
+      break;
+  }
+}
+}  // namespace
+
+Options::Options()
+    : encoding{Encoding::Float32}, every{1}, min_position{-1000.}, max_position{3000.}, max_speed{20.},
+      chunk_frames{64} {}
+
+std::uint16_t toHalf(const float value) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const std::uint32_t sign{(bits >> 16) & 0x8000u};
+  std::uint32_t magnitude{bits & 0x7fffffffu};
+
+  std::uint32_t half;
+  if (magnitude >= 0x47800000u) {
+    // too large for half precision, infinite or not a number
+    half = magnitude > 0x7f800000u ? 0x7e00u : 0x7c00u;
+  } else if (magnitude < 0x38800000u) {
+    // subnormal in half precision: adding 0.5 aligns the 10 bits of the mantissa at the bottom of the float, and the
+    // rounding of the addition is the rounding to nearest even
+    const std::uint32_t magic_bits{126u << 23};
+    float half_magic;
+    std::memcpy(&half_magic, &magic_bits, sizeof(half_magic));
+    float shifted;
+    std::memcpy(&shifted, &magnitude, sizeof(shifted));
+    shifted += half_magic;
+    std::memcpy(&magnitude, &shifted, sizeof(magnitude));
+    half = magnitude - magic_bits;
+  } else {
+    const std::uint32_t odd{(magnitude >> 13) & 1u};
+    // rebias the exponent, then round to nearest even on the 13 bits that are dropped
+    magnitude += (static_cast<std::uint32_t>(15 - 127) << 23) + 0xfffu + odd;
+    half = magnitude >> 13;
+  }
+  return static_cast<std::uint16_t>(half | sign);
+}
+
+float fromHalf(const std::uint16_t bits) {
+  const std::uint32_t sign{static_cast<std::uint32_t>(bits & 0x8000u) << 16};
+  const std::uint32_t exponent{bits & 0x7c00u};
+  const std::uint32_t mantissa{bits & 0x03ffu};
+
+  std::uint32_t single;
+  if (exponent == 0x7c00u) {
+    single = 0x7f800000u | (mantissa << 13);
+  } else if (exponent != 0) {
+    single = (((exponent >> 10) + 127 - 15) << 23) | (mantissa << 13);
+  } else {
+    // zero or subnormal: mantissa · 2^-24 is exact in single precision
+    const float value{std::ldexp(static_cast<float>(mantissa), -24)};
+    std::memcpy(&single, &value, sizeof(single));
+  }
+  single |= sign;
+
+  float value;
+  std::memcpy(&value, &single, sizeof(value));
+  return value;
+}
+
+Recorder::Recorder(const std::string& path, const size_t n_boids, const size_t n_predators, const Options& options)
+    : options_{options},
+      fd_{-1},
+      frame_bytes_{frameBytes(options.encoding, n_boids + n_predators)},
+      header_{nullptr},
+      base_{nullptr},
+      base_length_{0},
+      chunk_{nullptr},
+      chunk_first_{0},
+      stop_{false},
+      failed_{false} {
+  if (options_.every == 0 || options_.chunk_frames == 0) {
+    throw std::domain_error("Error: the recording interval and the chunk size must be strictly positive.");
+  }
+  if (options_.encoding == Encoding::Int16 &&
+      !(options_.max_position > options_.min_position && options_.max_speed > 0.)) {
+    throw std::domain_error("Error: the ranges of a 16 bit integer recording must not be empty.");
+  }
+
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) {
+    throw std::runtime_error("Error: cannot open " + path + " for writing.");
+  }
+  if (::ftruncate(fd_, static_cast<off_t>(sizeof(Header))) != 0) {
+    ::close(fd_);
+    throw std::runtime_error("Error: cannot write " + path + ".");
+  }
+  void* const header{::mmap(nullptr, sizeof(Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0)};
+  if (header == MAP_FAILED) {
+    ::close(fd_);
+    throw std::runtime_error("Error: cannot map " + path + ".");
+  }
+  header_ = static_cast<Header*>(header);
+
+  Header h{};
+  std::copy(std::begin(magic), std::end(magic), h.magic);
+  h.version = version;
+  h.encoding = static_cast<std::uint32_t>(options_.encoding);
+  h.n_boids = n_boids;
+  h.n_predators = n_predators;
+  h.every = options_.every;
+  h.frame_bytes = frame_bytes_;
+  h.n_frames = 0;
+  h.min_position = options_.min_position;
+  h.max_position = options_.max_position;
+  h.max_speed = options_.max_speed;
+  std::memcpy(header_, &h, sizeof(Header));
+
+  writer_ = std::thread(&Recorder::loop, this);
+}
+
+Recorder::~Recorder() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  queued_.notify_one();
+  writer_.join();
+
+  if (base_ != nullptr) {
+    ::munmap(base_, base_length_);
+  }
+  const auto n_frames = static_cast<size_t>(header_->n_frames);
+  ::munmap(header_, sizeof(Header));
+  // the last chunk is only partly used: drop what follows the last frame
+  static_cast<void>(::ftruncate(fd_, static_cast<off_t>(sizeof(Header) + n_frames * frame_bytes_)));
+  ::close(fd_);
+}
+
+template <typename T>
+void Recorder::record(const size_t step, const storage::BasicBirdArrays<T>& boids,
+                      const storage::BasicBirdArrays<T>& predators) {
+  enqueue(step, boids, predators, nullptr, nullptr);
+}
+
+template <typename T>
+void Recorder::record(const size_t step, const storage::BasicBirdArrays<T>& boids,
+                      const storage::BasicBirdArrays<T>& predators, const std::vector<size_t>& boid_ids,
+                      const std::vector<size_t>& predator_ids) {
+  if (boid_ids.size() != boids.size() || predator_ids.size() != predators.size()) {
+    throw std::domain_error("Error: every bird of a recording needs an id.");
+  }
+  enqueue(step, boids, predators, &boid_ids, &predator_ids);
+}
+
+template <typename T>
+void Recorder::enqueue(const size_t step, const storage::BasicBirdArrays<T>& boids,
+                       const storage::BasicBirdArrays<T>& predators, const std::vector<size_t>* const boid_ids,
+                       const std::vector<size_t>* const predator_ids) {
+  if (step % options_.every != 0) {
+    return;
+  }
+  if (boids.size() != header_->n_boids || predators.size() != header_->n_predators) {
+    throw std::domain_error("Error: the number of birds of a recording cannot change.");
+  }
+
+  Pending frame;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    written_.wait(lock, [this] { return ready_.size() < queue_depth || failed_; });
+    if (failed_) {
+      throw std::runtime_error("Error: the recording could not be written.");
+    }
+    if (!spare_.empty()) {
+      frame = std::move(spare_.back());
+      spare_.pop_back();
+    }
+  }
+
+  // the copy is the only work left on the calling thread; assigning to a spare frame reuses its storage
+  const auto copy = [](const storage::BasicBirdArrays<T>& from, const std::vector<size_t>* const ids,
+                       storage::BirdArrays& to) {
+    if (ids == nullptr) {
+      to.x.assign(from.x.begin(), from.x.end());
+      to.y.assign(from.y.begin(), from.y.end());
+      to.vx.assign(from.vx.begin(), from.vx.end());
+      to.vy.assign(from.vy.begin(), from.vy.end());
+      return;
+    }
+    to.resize(from.size());
+    for (size_t k = 0; k < from.size(); ++k) {
+      const size_t id{(*ids)[k]};
+      to.x[id] = from.x[k];
+      to.y[id] = from.y[k];
+      to.vx[id] = from.vx[k];
+      to.vy[id] = from.vy[k];
+    }
+  };
+  frame.step = step;
+  copy(boids, boid_ids, frame.boids);
+  copy(predators, predator_ids, frame.predators);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_.push_back(std::move(frame));
+  }
+  queued_.notify_one();
+}
+
+template void Recorder::record(size_t, const storage::BasicBirdArrays<float>&,
+                               const storage::BasicBirdArrays<float>&);
+template void Recorder::record(size_t, const storage::BasicBirdArrays<double>&,
+                               const storage::BasicBirdArrays<double>&);
+template void Recorder::record(size_t, const storage::BasicBirdArrays<float>&, const storage::BasicBirdArrays<float>&,
+                               const std::vector<size_t>&, const std::vector<size_t>&);
+template void Recorder::record(size_t, const storage::BasicBirdArrays<double>&, const storage::BasicBirdArrays<double>&,
+                               const std::vector<size_t>&, const std::vector<size_t>&);
+
+void Recorder::loop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queued_.wait(lock, [this] { return !ready_.empty() || stop_; });
+    if (ready_.empty()) {
+      return;
+    }
+    Pending frame{std::move(ready_.front())};
+    ready_.pop_front();
+
+    lock.unlock();
+    const bool written{!failed_ && write(frame)};
+    lock.lock();
+
+    if (!written) {
+      failed_ = true;
+    }
+    spare_.push_back(std::move(frame));
+    written_.notify_one();
+  }
+}
+
+bool Recorder::write(const Pending& frame) {
+  const auto t = static_cast<size_t>(header_->n_frames);
+  if (chunk_ == nullptr || t >= chunk_first_ + options_.chunk_frames) {
+    if (base_ != nullptr) {
+      ::munmap(base_, base_length_);
+      base_ = nullptr;
+      chunk_ = nullptr;
+    }
+    const size_t offset{sizeof(Header) + t * frame_bytes_};
+    const size_t length{options_.chunk_frames * frame_bytes_};
+    if (::ftruncate(fd_, static_cast<off_t>(offset + length)) != 0) {
+      return false;
+    }
+    chunk_ = static_cast<unsigned char*>(mapFrom(fd_, offset, length, base_length_, base_));
+    if (chunk_ == nullptr) {
+      base_ = nullptr;
+      return false;
+    }
+    chunk_first_ = t;
+  }
+
+  unsigned char* out{chunk_ + (t - chunk_first_) * frame_bytes_};
+  const auto step = static_cast<std::uint64_t>(frame.step);
+  std::memcpy(out, &step, sizeof(step));
+  out += sizeof(step);
+  for (const storage::BirdArrays* birds : {&frame.boids, &frame.predators}) {
+    encode(birds->x, *header_, true, out);
+    encode(birds->y, *header_, true, out);
+    encode(birds->vx, *header_, false, out);
+    encode(birds->vy, *header_, false, out);
+  }
+
+  // the frame is counted only once it is complete, so that a reader of an unfinished file never sees a partial frame
+  header_->n_frames = t + 1;
+  return true;
+}
+
+Reader::Reader(const std::string& path) : data_{nullptr}, size_{0} {
+  const int fd{::open(path.c_str(), O_RDONLY)};
+  if (fd < 0) {
+    throw std::runtime_error("Error: cannot open " + path + ".");
+  }
+
+  struct stat info {};
+  if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+    ::close(fd);
+    throw std::runtime_error("Error: " + path + " is not a trajectory.");
+  }
+  size_ = static_cast<size_t>(info.st_size);
+
+  void* const data{::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0)};
+  // the mapping keeps the file alive on its own
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("Error: cannot map " + path + ".");
+  }
+  data_ = data;
+
+  const Header& h = header();
+  const bool valid{std::equal(std::begin(magic), std::end(magic), h.magic) && h.version == version &&
+                   h.encoding <= static_cast<std::uint32_t>(Encoding::Int16) && h.n_boids <= size_ &&
+                   h.n_predators <= size_ &&
+                   h.frame_bytes == frameBytes(static_cast<Encoding>(h.encoding), h.n_boids + h.n_predators) &&
+                   h.n_frames <= size_ && size_ >= sizeof(Header) + h.n_frames * h.frame_bytes};
+  if (!valid) {
+    ::munmap(data_, size_);
+    throw std::runtime_error("Error: " + path + " is not a trajectory of version " + std::to_string(version) + ".");
+  }
+}
+
+Reader::~Reader() { ::munmap(data_, size_); }
+
+const Header& Reader::header() const { return *static_cast<const Header*>(data_); }
+
+size_t Reader::frames() const { return static_cast<size_t>(header().n_frames); }
+
+const unsigned char* Reader::frameData(const size_t t) const {
+  if (t >= frames()) {
+    throw std::out_of_range("Error: the trajectory has no frame " + std::to_string(t) + ".");
+  }
+  return static_cast<const unsigned char*>(data_) + sizeof(Header) + t * header().frame_bytes;
+}
+
+size_t Reader::step(const size_t t) const {
+  std::uint64_t step;
+  std::memcpy(&step, frameData(t), sizeof(step));
+  return static_cast<size_t>(step);
+}
+
+void Reader::frame(const size_t t, storage::BirdArrays& boids, storage::BirdArrays& predators) const {
+  const unsigned char* in{frameData(t) + sizeof(std::uint64_t)};
+  boids.resize(static_cast<size_t>(header().n_boids));
+  predators.resize(static_cast<size_t>(header().n_predators));
+  for (storage::BirdArrays* birds : {&boids, &predators}) {
+    decode(in, header(), true, birds->x);
+    decode(in, header(), true, birds->y);
+    decode(in, header(), false, birds->vx);
+    decode(in, header(), false, birds->vy);
+  }
+}
+}  // namespace recorder
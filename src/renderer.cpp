@@ -0,0 +1,131 @@
+#include "../include/renderer.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "../include/flock.hpp"
+#include "../include/storage.hpp"
+#include "../include/triangle.hpp"
+
+namespace renderer {
+
+namespace {
+
+// the view is applied as the modelview and projection matrices of the fixed pipeline, so the triangle is rotated in
+// pixel coordinates, between the two
+const char* const vertex_shader = R"(#version 150 compatibility
+out vec2 heading;
+out vec4 color;
+
+void main() {
+  gl_Position = gl_ModelViewMatrix * gl_Vertex;
+  heading = gl_MultiTexCoord0.xy;
+  color = gl_Color;
+}
+)";
+
+const char* const geometry_shader = R"(#version 150 compatibility
+layout (points) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+// triangles::relative_position: the shape of a boid, then the shape of a predator
+uniform vec2 shape[6];
+
+// the points are drawn boids first, so the index of a point tells its species, whatever its color
+uniform int boids;
+
+in vec2 heading[];
+in vec4 color[];
+out vec4 vertex_color;
+
+void main() {
+  int first = gl_PrimitiveIDIn < boids ? 0 : 3;
+  float s = heading[0].x;
+  float c = heading[0].y;
+
+  for (int k = 0; k < 3; ++k) {
+    vec2 r = shape[first + k];
+    gl_Position = gl_ProjectionMatrix * (gl_in[0].gl_Position + vec4(r.x * c - r.y * s, r.x * s + r.y * c, 0., 0.));
+    vertex_color = color[0];
+    EmitVertex();
+  }
+  EndPrimitive();
+}
+)";
+
+const char* const fragment_shader = R"(#version 150 compatibility
+in vec4 vertex_color;
+
+void main() { gl_FragColor = vertex_color; }
+)";
+
+void packArrays(const storage::BirdArrays& birds, const sf::Color& color, sf::Vertex* points) {
+  for (size_t i = 0; i < birds.size(); ++i) {
+    // sin and cos of atan2(vy, vx) + pi / 2, a bird at rest points upwards
+    float sin_t{1.f};
+    float cos_t{0.f};
+    const double module2{birds.vx[i] * birds.vx[i] + birds.vy[i] * birds.vy[i]};
+    if (module2 != 0.) {
+      const double inverse{1. / std::sqrt(module2)};
+      sin_t = static_cast<float>(birds.vx[i] * inverse);
+      cos_t = static_cast<float>(-birds.vy[i] * inverse);
+    }
+
+    points[i].position = sf::Vector2f(static_cast<float>(birds.x[i]), static_cast<float>(birds.y[i]));
+    points[i].color = color;
+    points[i].texCoords = sf::Vector2f(sin_t, cos_t);
+  }
+}
+}  // namespace
+
+void packBirds(const storage::BirdArrays& boids, const storage::BirdArrays& predators,
+               std::vector<sf::Vertex>& points) {
+  points.resize(boids.size() + predators.size());
+
+  packArrays(boids, sf::Color::Blue, points.data());
+  packArrays(predators, sf::Color::Red, points.data() + boids.size());
+}
+
+BirdRenderer::BirdRenderer(const flock::Flock& flock, const bool prefer_gpu)
+    : path_{Path::Cpu}, points_(sf::Points, sf::VertexBuffer::Stream) {
+  if (prefer_gpu && sf::VertexBuffer::isAvailable() && sf::Shader::isGeometryAvailable() &&
+      shader_.loadFromMemory(vertex_shader, geometry_shader, fragment_shader) &&
+      points_.create(flock.getFlockSize())) {
+    shader_.setUniformArray("shape", triangles::relative_position.data(), triangles::relative_position.size());
+    shader_.setUniform("boids", static_cast<int>(flock.getBoidsNum()));
+    path_ = Path::Gpu;
+  } else {
+    triangles_ = sf::VertexArray(sf::Triangles, 3 * flock.getFlockSize());
+    triangles::createTriangles(flock, triangles_);
+  }
+  update(flock);
+}
+
+Path BirdRenderer::getPath() const { return path_; }
+
+const sf::VertexArray& BirdRenderer::getTriangles() const { return triangles_; }
+
+void BirdRenderer::update(const flock::Flock& flock) { update(flock.getBoidArrays(), flock.getPredatorArrays()); }
+
+void BirdRenderer::update(const storage::BirdArrays& boids, const storage::BirdArrays& predators) {
+  if (path_ == Path::Gpu) {
+    packBirds(boids, predators, staging_);
+    assert(staging_.size() == points_.getVertexCount());
+    points_.update(staging_.data());
+  } else {
+    triangles::rotateTriangles(boids, true, boids.size(), triangles_, 0, boids.size());
+    triangles::rotateTriangles(predators, false, boids.size(), triangles_, 0, predators.size());
+  }
+}
+
+void BirdRenderer::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+  if (path_ == Path::Gpu) {
+    states.shader = &shader_;
+    target.draw(points_, states);
+  } else {
+    target.draw(triangles_, states);
+  }
+}
+}  // namespace renderer
@@ -0,0 +1,59 @@
+#include "../include/simulation.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "../include/flock.hpp"
+
+namespace simulation {
+
+Simulation::Simulation(flock::Flock& flock, const double rate) : flock_{flock}, rate_{rate}, running_{true} {
+  Frame& first = frames_.back();
+  first.boids = flock_.getBoidArrays();
+  first.predators = flock_.getPredatorArrays();
+  first.step = 0;
+  frames_.publish();
+
+  thread_ = std::thread(&Simulation::run, this);
+}
+
+Simulation::~Simulation() {
+  running_.store(false, std::memory_order_relaxed);
+  thread_.join();
+}
+
+void Simulation::run() {
+  using clock = std::chrono::steady_clock;
+  const auto period =
+      std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(rate_ > 0. ? 1. / rate_ : 0.));
+
+  size_t step{0};
+  auto next = clock::now();
+  while (running_.load(std::memory_order_relaxed)) {
+    flock_.evolve();
+    ++step;
+
+    // the slot of the producer holds an old frame: assigning to it reuses its storage
+    Frame& frame = frames_.back();
+    frame.boids = flock_.getBoidArrays();
+    frame.predators = flock_.getPredatorArrays();
+    frame.step = step;
+    frames_.publish();
+
+    if (rate_ > 0.) {
+      next += period;
+      const auto now = clock::now();
+      if (next < now) {
+        // too slow for the rate: do not try to catch up on the steps that were missed
+        next = now;
+      }
+      std::this_thread::sleep_until(next);
+    }
+  }
+}
+
+bool Simulation::update() { return frames_.update(); }
+
+const Frame& Simulation::frame() const { return frames_.front(); }
+}  // namespace simulation
@@ -0,0 +1,117 @@
+#include "../include/snapshot.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../include/storage.hpp"
+
+namespace snapshot {
+
+static_assert(std::is_trivially_copyable_v<Header>, "Header must be written byte by byte");
+static_assert(sizeof(Header) % alignof(double) == 0, "the arrays following Header must be aligned");
+
+namespace {
+
+void writeArray(std::ofstream& out, const std::vector<double>& values) {
+  out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(double)));
+}
+}  // namespace
+
+void write(const std::string& path, Header header, const storage::BirdArrays& boids,
+           const storage::BirdArrays& predators) {
+  std::copy(std::begin(magic), std::end(magic), header.magic);
+  header.version = version;
+  header.n_boids = boids.size();
+  header.n_predators = predators.size();
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Error: cannot open " + path + " for writing.");
+  }
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  for (const storage::BirdArrays* birds : {&boids, &predators}) {
+    writeArray(out, birds->x);
+    writeArray(out, birds->y);
+    writeArray(out, birds->vx);
+    writeArray(out, birds->vy);
+  }
+
+  if (!out.flush()) {
+    throw std::runtime_error("Error: failed to write " + path + ".");
+  }
+}
+
+MappedSnapshot::MappedSnapshot(const std::string& path) : data_{nullptr}, size_{0} {
+  const int fd{::open(path.c_str(), O_RDONLY)};
+  if (fd < 0) {
+    throw std::runtime_error("Error: cannot open " + path + ".");
+  }
+
+  // the magic and the version are read first: the files of other versions may be shorter than Header
+  constexpr size_t prefix{offsetof(Header, field_of_view)};
+  struct stat info {};
+  if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < prefix) {
+    ::close(fd);
+    throw std::runtime_error("Error: " + path + " is not a snapshot.");
+  }
+  size_ = static_cast<size_t>(info.st_size);
+
+  void* const data{::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0)};
+  // the mapping keeps the file alive on its own
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("Error: cannot map " + path + ".");
+  }
+  data_ = data;
+
+  std::uint32_t file_version{0};
+  std::memcpy(&file_version, static_cast<const char*>(data_) + offsetof(Header, version), sizeof(file_version));
+  const bool snapshot{std::equal(std::begin(magic), std::end(magic), static_cast<const char*>(data_))};
+  if (snapshot && file_version != version) {
+    ::munmap(data_, size_);
+    throw std::runtime_error("Error: " + path + " is a snapshot of version " + std::to_string(file_version) +
+                             ", only version " + std::to_string(version) + " can be loaded.");
+  }
+
+  const bool valid{snapshot && size_ >= sizeof(Header) && header().n_boids <= size_ &&
+                   header().n_predators <= size_ &&
+                   size_ == sizeof(Header) + 4 * (header().n_boids + header().n_predators) * sizeof(double)};
+  if (!valid) {
+    ::munmap(data_, size_);
+    throw std::runtime_error("Error: " + path + " is not a snapshot of version " + std::to_string(version) + ".");
+  }
+}
+
+MappedSnapshot::~MappedSnapshot() { ::munmap(data_, size_); }
+
+const Header& MappedSnapshot::header() const { return *static_cast<const Header*>(data_); }
+
+const double* MappedSnapshot::array(const size_t k) const {
+  return reinterpret_cast<const double*>(static_cast<const char*>(data_) + sizeof(Header)) + k;
+}
+
+std::array<const double*, 4> MappedSnapshot::boids() const {
+  const auto n = static_cast<size_t>(header().n_boids);
+  return {array(0), array(n), array(2 * n), array(3 * n)};
+}
+
+std::array<const double*, 4> MappedSnapshot::predators() const {
+  const auto n = static_cast<size_t>(header().n_boids);
+  const auto m = static_cast<size_t>(header().n_predators);
+  return {array(4 * n), array(4 * n + m), array(4 * n + 2 * m), array(4 * n + 3 * m)};
+}
+}  // namespace snapshot
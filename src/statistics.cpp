@@ -1,8 +1,186 @@
 #include "../include/statistics.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../include/pool.hpp"
+#include "../include/rng.hpp"
+#include "../include/storage.hpp"
+#include "../include/torus.hpp"
+
 namespace statistics {
 
-Statistics::Statistics() : mean_dist{0.}, dev_dist{0.}, mean_speed{0.}, dev_speed{0.} {}
+Statistics::Statistics() : mean_dist{0.}, dev_dist{0.}, mean_speed{0.}, dev_speed{0.}, mean_dist_error{0.} {}
 Statistics::Statistics(const double m_dist, const double d_dist, const double m_speed, const double d_speed)
-    : mean_dist{m_dist}, dev_dist{d_dist}, mean_speed{m_speed}, dev_speed{d_speed} {}
-}  // namespace statistics
\ No newline at end of file
+    : mean_dist{m_dist}, dev_dist{d_dist}, mean_speed{m_speed}, dev_speed{d_speed}, mean_dist_error{0.} {}
+
+Options::Options() : mode{Mode::Exact}, error_bound{1.}, max_pairs{1'000'000}, seed{0}, period_x{0.}, period_y{0.} {}
+Options::Options(const Mode m, const double bound, const size_t pairs, const std::uint64_t s)
+    : mode{m}, error_bound{bound}, max_pairs{pairs}, seed{s}, period_x{0.}, period_y{0.} {}
+
+namespace {
+
+/// @brief Is the number of blocks the exact sums are split into; fixed, so that the order of the additions does not
+/// depend on the number of threads.
+constexpr size_t n_blocks{256};
+
+/// @brief Is the number of couples drawn between two checks of the standard error.
+constexpr size_t batch{1024};
+
+/// @brief Sums, over the blocks of a range, a pair of quantities computed block by block.
+/// @param n Is the size of the range.
+/// @param pool Is the pool running the blocks, or nullptr.
+/// @param sum Evaluates the sums over the sub-range [begin, end).
+/// @return The sums over the whole range, added block after block.
+template <typename Sum>
+std::array<double, 2> reduce(const size_t n, pool::ThreadPool* pool, Sum&& sum) {
+  const size_t blocks{std::min(n, n_blocks)};
+  std::vector<std::array<double, 2>> partial(blocks, {0., 0.});
+
+  const auto task = [&](const size_t begin, const size_t end, size_t) {
+    for (size_t b = begin; b < end; ++b) {
+      partial[b] = sum(b * n / blocks, (b + 1) * n / blocks);
+    }
+  };
+  if (pool != nullptr) {
+    pool->parallelFor(blocks, task);
+  } else {
+    task(0, blocks, 0);
+  }
+
+  std::array<double, 2> total{0., 0.};
+  for (const std::array<double, 2>& p : partial) {
+    total[0] += p[0];
+    total[1] += p[1];
+  }
+  return total;
+}
+
+/// @brief Evaluates the sum of the distances and of the squared distances of the couples (i, j) with i in
+/// [begin, end) and j > i.
+template <typename T>
+std::array<double, 2> sumDistances(const storage::BasicBirdArrays<T>& birds, const size_t begin, const size_t end,
+                                   const Options& options) {
+  const size_t n{birds.size()};
+  const T* x{birds.x.data()};
+  const T* y{birds.y.data()};
+
+  double sum{0.};
+  double sum2{0.};
+  const bool wraps{options.period_x > 0. || options.period_y > 0.};
+  for (size_t i = begin; i < end; ++i) {
+    const double xi{x[i]};
+    const double yi{y[i]};
+    // the test is hoisted out of the inner loop, which stays free of branches in a world without wrap-around
+    if (wraps) {
+      for (size_t j = i + 1; j < n; ++j) {
+        const double dx{torus::image(static_cast<double>(x[j]) - xi, options.period_x)};
+        const double dy{torus::image(static_cast<double>(y[j]) - yi, options.period_y)};
+        const double distance2{dx * dx + dy * dy};
+        sum += std::sqrt(distance2);
+        sum2 += distance2;
+      }
+      continue;
+    }
+    for (size_t j = i + 1; j < n; ++j) {
+      const double dx{static_cast<double>(x[j]) - xi};
+      const double dy{static_cast<double>(y[j]) - yi};
+      const double distance2{dx * dx + dy * dy};
+      sum += std::sqrt(distance2);
+      sum2 += distance2;
+    }
+  }
+  return {sum, sum2};
+}
+
+/// @brief Estimates the mean distance and the mean squared distance by drawing couples of distinct birds.
+/// @return The estimates and the standard error of the first one.
+template <typename T>
+std::array<double, 3> sampleDistances(const storage::BasicBirdArrays<T>& birds, const Options& options) {
+  const size_t n{birds.size()};
+  rng::Xoshiro256 engine(options.seed);
+
+  double sum{0.};
+  double sum2{0.};
+  size_t k{0};
+  double error{0.};
+  const size_t budget{std::max<size_t>(options.max_pairs, 2)};
+  while (k < budget) {
+    const size_t draws{std::min(batch, budget - k)};
+    for (size_t d = 0; d < draws; ++d) {
+      const auto i = static_cast<size_t>(engine.below(n));
+      auto j = static_cast<size_t>(engine.below(n - 1));
+      j += j >= i ? 1 : 0;  // uniform over the birds other than i
+
+      const double dx{torus::image(static_cast<double>(birds.x[j]) - birds.x[i], options.period_x)};
+      const double dy{torus::image(static_cast<double>(birds.y[j]) - birds.y[i], options.period_y)};
+      const double distance2{dx * dx + dy * dy};
+      sum += std::sqrt(distance2);
+      sum2 += distance2;
+    }
+    k += draws;
+
+    const double mean{sum / static_cast<double>(k)};
+    const double variance{std::max(0., sum2 / static_cast<double>(k) - mean * mean)};
+    error = std::sqrt(variance / static_cast<double>(k - 1));
+    if (error <= options.error_bound) {
+      break;
+    }
+  }
+
+  return {sum / static_cast<double>(k), sum2 / static_cast<double>(k), error};
+}
+}  // namespace
+
+template <typename T>
+Statistics evaluate(const storage::BasicBirdArrays<T>& birds, const Options& options, pool::ThreadPool* pool) {
+  const size_t n{birds.size()};
+  assert(n > 0 && "Flock must contain at least one element");
+
+  Statistics stats;
+
+  if (n > 1) {
+    double mean_dist2{0.};
+    if (options.mode == Mode::Exact) {
+      const std::array<double, 2> sums{reduce(n, pool, [&birds, &options](const size_t begin, const size_t end) {
+        return sumDistances(birds, begin, end, options);
+      })};
+      const double denominator{static_cast<double>(n) * static_cast<double>(n - 1) / 2.};
+
+      stats.mean_dist = sums[0] / denominator;
+      mean_dist2 = sums[1] / denominator;
+    } else {
+      const std::array<double, 3> estimate{sampleDistances(birds, options)};
+
+      stats.mean_dist = estimate[0];
+      mean_dist2 = estimate[1];
+      stats.mean_dist_error = estimate[2];
+    }
+    stats.dev_dist = std::sqrt(std::max(0., mean_dist2 - stats.mean_dist * stats.mean_dist));
+  }
+
+  const std::array<double, 2> speeds{reduce(n, pool, [&birds](const size_t begin, const size_t end) {
+    double sum{0.};
+    double sum2{0.};
+    for (size_t i = begin; i < end; ++i) {
+      const double vx{birds.vx[i]};
+      const double vy{birds.vy[i]};
+      const double speed2{vx * vx + vy * vy};
+      sum += std::sqrt(speed2);
+      sum2 += speed2;
+    }
+    return std::array<double, 2>{sum, sum2};
+  })};
+  stats.mean_speed = speeds[0] / static_cast<double>(n);
+  stats.dev_speed = std::sqrt(std::max(0., speeds[1] / static_cast<double>(n) - stats.mean_speed * stats.mean_speed));
+
+  return stats;
+}
+
+template Statistics evaluate(const storage::BasicBirdArrays<float>&, const Options&, pool::ThreadPool*);
+template Statistics evaluate(const storage::BasicBirdArrays<double>&, const Options&, pool::ThreadPool*);
+}  // namespace statistics
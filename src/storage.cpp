@@ -0,0 +1,47 @@
+#include "../include/storage.hpp"
+
+#include <cassert>
+
+#include "../include/point.hpp"
+
+namespace storage {
+
+template <typename T>
+size_t BasicBirdArrays<T>::size() const {
+  assert(y.size() == x.size() && vx.size() == x.size() && vy.size() == x.size());
+  return x.size();
+}
+
+template <typename T>
+void BasicBirdArrays<T>::resize(const size_t n) {
+  x.resize(n);
+  y.resize(n);
+  vx.resize(n);
+  vy.resize(n);
+}
+
+template <typename T>
+point::BasicPoint<T> BasicBirdArrays<T>::position(const size_t i) const { return {x[i], y[i]}; }
+template <typename T>
+point::BasicPoint<T> BasicBirdArrays<T>::velocity(const size_t i) const { return {vx[i], vy[i]}; }
+
+template <typename T>
+void BasicBirdArrays<T>::set(const size_t i, const point::BasicPoint<T>& position,
+                             const point::BasicPoint<T>& velocity) {
+  x[i] = position.getX();
+  y[i] = position.getY();
+  vx[i] = velocity.getX();
+  vy[i] = velocity.getY();
+}
+
+template <typename T>
+void BasicBirdArrays<T>::push_back(const point::BasicPoint<T>& position, const point::BasicPoint<T>& velocity) {
+  x.push_back(position.getX());
+  y.push_back(position.getY());
+  vx.push_back(velocity.getX());
+  vy.push_back(velocity.getY());
+}
+
+template struct BasicBirdArrays<float>;
+template struct BasicBirdArrays<double>;
+}  // namespace storage
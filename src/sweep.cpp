@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../include/config.hpp"
+#include "../include/flock.hpp"
+#include "../include/pool.hpp"
+#include "../include/statistics.hpp"
+#include "../include/tasks.hpp"
+
+namespace {
+
+/// @brief Collects the options of a sweep.
+struct Options {
+  ///@brief Are the settings shared with Boids, see config::set(); threads is the number of flocks run at once.
+  config::Config settings;
+  std::vector<double> separation{0.1};
+  std::vector<double> alignment{0.1};
+  std::vector<double> cohesion{0.004};
+  size_t repeats{1};
+  size_t steps{1000};
+  std::string output;
+  statistics::Options stats;
+};
+
+void printUsage(std::ostream& out) {
+  out << "Usage: Boids.sweep --output FILE [options]\n"
+      << "  --separation LIST  separation coefficients, as 'x,y,z' or 'first:last:count' (default 0.1)\n"
+      << "  --alignment LIST   alignment coefficients, as above (default 0.1)\n"
+      << "  --cohesion LIST    cohesion coefficients, as above (default 0.004)\n"
+      << "  --repeats R        runs of each configuration, from the seeds S, S + 1, ... (default 1)\n"
+      << "  --steps K          number of steps of each run (default 1000)\n"
+      << "  --error E          target standard error of the sampled mean distance, in pixels (default 1)\n"
+      << "  --output FILE      write one row per run to FILE; the runs already in FILE are skipped, so that an\n"
+      << "                     interrupted sweep resumes where it stopped, if FILE was written with the same\n"
+      << "                     settings\n"
+      << "Settings shared with Boids, 1000 boids, 0 predators, seed 1 and exact statistics unless given; --threads\n"
+      << "is the number of flocks run at once, each on one thread:\n";
+  config::printKeys(out);
+}
+
+Options parseOptions(const int argc, char* argv[]) {
+  Options options;
+  for (int k = 1; k < argc; ++k) {
+    const std::string flag{argv[k]};
+    if (flag == "--help" || flag == "-h") {
+      printUsage(std::cout);
+      std::exit(EXIT_SUCCESS);
+    }
+    if (k + 1 == argc) {
+      throw std::domain_error("Error: missing value for option " + flag + ".");
+    }
+    const std::string value{argv[++k]};
+
+    if (flag == "--separation") {
+      options.separation = tasks::toValues(flag, value);
+    } else if (flag == "--alignment") {
+      options.alignment = tasks::toValues(flag, value);
+    } else if (flag == "--cohesion") {
+      options.cohesion = tasks::toValues(flag, value);
+    } else if (flag == "--repeats") {
+      options.repeats = config::toSize(flag, value);
+    } else if (flag == "--steps") {
+      options.steps = config::toSize(flag, value);
+    } else if (flag == "--error") {
+      options.stats.error_bound = config::toDouble(flag, value);
+    } else if (flag == "--output") {
+      options.output = value;
+    } else if (flag == "--config") {
+      config::loadFile(options.settings, value);
+    } else if (flag.compare(0, 2, "--") == 0) {
+      config::set(options.settings, flag.substr(2), value);
+    } else {
+      throw std::domain_error("Error: unknown option " + flag + ".");
+    }
+  }
+  options.stats.mode = options.settings.stats_mode.value_or(statistics::Mode::Exact);
+
+  if (options.output.empty()) {
+    throw std::domain_error("Error: the output file is required, to resume the sweep if it is interrupted.");
+  }
+  if (options.repeats == 0) {
+    throw std::domain_error("Error: the number of repeats must be strictly positive.");
+  }
+  if (!(options.stats.error_bound > 0.)) {
+    throw std::domain_error("Error: the statistics error bound must be strictly positive.");
+  }
+  return options;
+}
+
+/// @brief Runs the flock of a configuration and formats its row.
+std::string run(const tasks::Task& task, const Options& options) {
+  const config::Config& settings = options.settings;
+  const auto start = std::chrono::steady_clock::now();
+
+  flock::Flock flock(settings.n_boids.value_or(1000), settings.n_predators.value_or(0));
+  flock.setFlightParams(task.s, task.a, task.c);
+  flock.setParameters(settings.parameters);
+  flock.setFieldOfView(settings.field_of_view);
+  flock.setSkin(settings.skin);
+  flock.setReorder(settings.reorder_every);
+  flock.generateBirds(task.seed, settings.distribution);
+  for (size_t step = 0; step < options.steps; ++step) {
+    flock.evolve();
+  }
+  const statistics::Statistics stats{flock.statistics(options.stats)};
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::ostringstream row;
+  row.precision(10);
+  row << tasks::describe(task) << ',' << stats.mean_dist << ',' << stats.dev_dist << ',' << stats.mean_speed << ','
+      << stats.dev_speed << ',' << stats.mean_dist_error << ',' << elapsed.count() << '\n';
+  return row.str();
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  std::vector<tasks::Task> grid;
+  std::string settings;
+  std::vector<bool> done;
+  try {
+    options = parseOptions(argc, argv);
+    grid = tasks::makeTasks(options.separation, options.alignment, options.cohesion, options.repeats,
+                            options.settings.seed.value_or(1));
+    settings = tasks::describe(options.settings, options.steps, options.stats);
+
+    // every configuration is checked before any is run, so that a sweep does not stop halfway on a bad value
+    flock::Flock probe(1, 0);
+    probe.setParameters(options.settings.parameters);
+    for (const tasks::Task& task : grid) {
+      probe.setFlightParams(task.s, task.a, task.c);
+    }
+
+    done = tasks::readDone(options.output, settings, grid);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n\n";
+    printUsage(std::cerr);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<tasks::Task> pending;
+  std::copy_if(grid.begin(), grid.end(), std::back_inserter(pending),
+               [&done](const tasks::Task& task) { return !done[task.index]; });
+
+  const bool is_new{!std::filesystem::exists(options.output) || std::filesystem::file_size(options.output) == 0};
+  std::ofstream out(options.output, std::ios::app);
+  if (!out) {
+    std::cerr << "Error: cannot open " << options.output << " for writing.\n";
+    return EXIT_FAILURE;
+  }
+  if (is_new) {
+    out << settings << '\n' << tasks::columns << '\n' << std::flush;
+  }
+
+  std::cerr << grid.size() - pending.size() << " of " << grid.size() << " runs already done, " << pending.size()
+            << " to go\n";
+
+  // each worker runs one flock at a time, on its own thread: memory is bounded by the number of workers, and each
+  // row is flushed as soon as its run ends, so that an interruption loses the runs in progress only
+  const auto start = std::chrono::steady_clock::now();
+  pool::ThreadPool workers(std::max<size_t>(1, options.settings.threads));
+  std::mutex output_mutex;
+  size_t finished{0};
+  workers.parallelFor(pending.size(), [&](const size_t begin, const size_t end, size_t) {
+    for (size_t k = begin; k < end; ++k) {
+      const std::string row{run(pending[k], options)};
+
+      const std::lock_guard<std::mutex> lock(output_mutex);
+      out << row << std::flush;
+      ++finished;
+      std::cerr << '\r' << finished << " / " << pending.size() << std::flush;
+    }
+  });
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cerr << '\n'
+            << pending.size() << " runs on " << workers.size() << " threads in " << elapsed.count() << " s\n";
+  if (!out) {
+    std::cerr << "Error: failed to write " << options.output << ".\n";
+    return EXIT_FAILURE;
+  }
+}
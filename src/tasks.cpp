@@ -0,0 +1,161 @@
+#include "../include/tasks.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../include/config.hpp"
+#include "../include/flock.hpp"
+#include "../include/statistics.hpp"
+
+namespace tasks {
+
+namespace {
+
+const char* name(const flock::Distribution distribution) {
+  switch (distribution) {
+    case flock::Distribution::Clustered:
+      return "clustered";
+    case flock::Distribution::Ring:
+      return "ring";
+    case flock::Distribution::Gaussian:
+      return "gaussian";
+    case flock::Distribution::Uniform:
+      break;
+  }
+  return "uniform";
+}
+}  // namespace
+
+std::vector<double> toValues(const std::string& key, const std::string& value) {
+  std::vector<std::string> fields;
+  const char separator{value.find(':') != std::string::npos ? ':' : ','};
+  std::istringstream in(value);
+  for (std::string field; std::getline(in, field, separator);) {
+    fields.push_back(field);
+  }
+
+  std::vector<double> values;
+  if (separator == ':') {
+    if (fields.size() != 3) {
+      throw std::domain_error("Error: '" + value + "' is not of the form first:last:count.");
+    }
+    const double first{config::toDouble(key, fields[0])};
+    const double last{config::toDouble(key, fields[1])};
+    const size_t count{config::toSize(key, fields[2])};
+    for (size_t k = 0; k < count; ++k) {
+      values.push_back(count == 1 ? first
+                                  : first + (last - first) * static_cast<double>(k) / static_cast<double>(count - 1));
+    }
+  } else {
+    for (const std::string& field : fields) {
+      values.push_back(config::toDouble(key, field));
+    }
+  }
+  if (values.empty()) {
+    throw std::domain_error("Error: '" + value + "' is an empty list.");
+  }
+  return values;
+}
+
+std::vector<Task> makeTasks(const std::vector<double>& separation, const std::vector<double>& alignment,
+                            const std::vector<double>& cohesion, const size_t repeats, const std::uint64_t first_seed) {
+  std::vector<Task> tasks;
+  for (const double s : separation) {
+    for (const double a : alignment) {
+      for (const double c : cohesion) {
+        for (size_t repeat = 0; repeat < repeats; ++repeat) {
+          tasks.push_back({tasks.size(), s, a, c, repeat, first_seed + repeat});
+        }
+      }
+    }
+  }
+  return tasks;
+}
+
+std::string describe(const Task& task) {
+  std::ostringstream out;
+  out.precision(10);
+  out << task.index << ',' << task.s << ',' << task.a << ',' << task.c << ',' << task.repeat << ',' << task.seed;
+  return out.str();
+}
+
+std::string describe(const config::Config& settings, const size_t steps, const statistics::Options& stats) {
+  const flock::Parameters& params = settings.parameters;
+  std::ostringstream out;
+  // 17 digits write every double exactly, so that equal settings give equal lines
+  out.precision(17);
+  out << "# steps=" << steps << " boids=" << settings.n_boids.value_or(1000)
+      << " predators=" << settings.n_predators.value_or(0) << " distance=" << params.d
+      << " boid_separation=" << params.b_ds << " predator_separation=" << params.p_ds
+      << " boid_sight_angle=" << params.b_sight_angle << " predator_sight_angle=" << params.p_sight_angle
+      << " margin=" << params.margin << " turn_factor=" << params.turn_factor
+      << " boid_max_speed=" << params.b_max_speed << " predator_max_speed=" << params.p_max_speed
+      << " boid_min_speed=" << params.b_min_speed << " predator_min_speed=" << params.p_min_speed
+      << " dt=" << params.dt << " width=" << params.width << " height=" << params.height
+      << " boundary=" << (params.boundary == flock::Boundary::Torus ? "torus" : "walls")
+      << " field_of_view=" << (settings.field_of_view == flock::FieldOfView::Cone ? "cone" : "angle")
+      << " distribution=" << name(settings.distribution) << " skin=" << settings.skin
+      << " reorder_every=" << settings.reorder_every
+      << " stats=" << (stats.mode == statistics::Mode::Sampled ? "sampled" : "exact")
+      << " error=" << stats.error_bound;
+  return out.str();
+}
+
+std::vector<bool> readDone(const std::string& path, const std::string& settings, const std::vector<Task>& tasks) {
+  std::vector<bool> done(tasks.size(), false);
+  if (!std::filesystem::exists(path)) {
+    return done;
+  }
+
+  std::string text;
+  {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream content;
+    content << in.rdbuf();
+    text = content.str();
+  }
+  const size_t complete{text.rfind('\n') == std::string::npos ? 0 : text.rfind('\n') + 1};
+  if (complete < text.size()) {
+    std::filesystem::resize_file(path, complete);
+  }
+
+  std::istringstream in(text.substr(0, complete));
+  std::string first;
+  std::string second;
+  if (!std::getline(in, first) || !std::getline(in, second)) {
+    // the two lines are written together: a file lacking them was cut before any row was written
+    if (!first.empty() && first.compare(0, 1, "#") != 0) {
+      throw std::runtime_error("Error: " + path + " is not the output of a sweep.");
+    }
+    std::filesystem::resize_file(path, 0);
+    return done;
+  }
+  if (first.compare(0, 1, "#") != 0 || second != columns) {
+    throw std::runtime_error("Error: " + path + " is not the output of a sweep.");
+  }
+  if (first != settings) {
+    throw std::runtime_error("Error: " + path + " was written by a sweep with other settings:\n  " + first +
+                             "\ninstead of\n  " + settings);
+  }
+
+  std::string line;
+  while (std::getline(in, line)) {
+    const size_t digits{line.find_first_not_of("0123456789")};
+    // more digits than any index of the grid can have would overflow std::stoull
+    const size_t index{digits == 0 || digits > 18 ? tasks.size()
+                                                  : static_cast<size_t>(std::stoull(line.substr(0, digits)))};
+    const std::string prefix{index < tasks.size() ? describe(tasks[index]) + ',' : std::string()};
+    if (prefix.empty() || line.compare(0, prefix.size(), prefix) != 0) {
+      throw std::runtime_error("Error: " + path + " was written by a sweep over another grid.");
+    }
+    done[index] = true;
+  }
+  return done;
+}
+}  // namespace tasks
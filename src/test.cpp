@@ -1,12 +1,37 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 #include "../doctest.h"
 #include "../include/bird.hpp"
+#include "../include/buffer.hpp"
+#include "../include/config.hpp"
 #include "../include/flock.hpp"
 #include "../include/graphic.hpp"
+#include "../include/grid.hpp"
+#include "../include/morton.hpp"
+#include "../include/overlay.hpp"
 #include "../include/point.hpp"
+#include "../include/pool.hpp"
+#include "../include/profiler.hpp"
+#include "../include/recorder.hpp"
+#include "../include/renderer.hpp"
+#include "../include/rng.hpp"
+#include "../include/simulation.hpp"
+#include "../include/snapshot.hpp"
+#include "../include/statistics.hpp"
+#include "../include/storage.hpp"
+#include "../include/tasks.hpp"
+#include "../include/torus.hpp"
 #include "../include/triangle.hpp"
 
 std::array<double, 3> distanceParams = flock::Flock::getDistancesParams();
@@ -278,6 +303,32 @@ TEST_CASE("Testing Boid class") {
     CHECK(b1.repel(r, near_b1).getY() == doctest::Approx(rep1_y));
   }
 
+  SUBCASE("Testing the bird record") {
+    // no vtable: a boid is its position and velocity only, and is copied as plain memory
+    CHECK(!std::is_polymorphic_v<bird::Bird>);
+    CHECK(std::is_trivially_copyable_v<bird::Boid>);
+    CHECK(sizeof(bird::Boid) == 2 * sizeof(point::Point));
+    CHECK(sizeof(bird::BasicBoid<float>) == 16);
+
+    const std::shared_ptr<bird::Bird> bird0{std::make_shared<bird::Boid>(b1)};
+    CHECK(bird0->getPosition() == b1.getPosition());
+    CHECK(bird0->getVelocity() == b1.getVelocity());
+  }
+
+  SUBCASE("Testing rules on storage::BirdArrays") {
+    storage::BirdArrays arrays;
+    arrays.push_back(b1.getPosition(), b1.getVelocity());
+    for (const std::shared_ptr<bird::Bird>& boid : near_b1) {
+      arrays.push_back(boid->getPosition(), boid->getVelocity());
+    }
+    const std::vector<size_t> near{1, 2, 3, 4};
+
+    CHECK(b1.separation(s, b_ds, near, arrays) == b1.separation(s, b_ds, near_b1));
+    CHECK(b1.alignment(a, near, arrays) == b1.alignment(a, near_b1));
+    CHECK(b1.cohesion(c, near, arrays) == b1.cohesion(c, near_b1));
+    CHECK(b1.repel(r, near, arrays) == b1.repel(r, near_b1));
+  }
+
   SUBCASE("Testing friction method") {
     b1.friction(bMaxSpeed, v1);
     b2.friction(bMaxSpeed, v2);
@@ -418,6 +469,12 @@ TEST_CASE("Testing Predator class") {
 
     CHECK(p1.chase(ch, near_p1).getX() == doctest::Approx(chase1_x));
     CHECK(p1.chase(ch, near_p1).getY() == doctest::Approx(chase1_y));
+
+    storage::BirdArrays arrays;
+    for (const std::shared_ptr<bird::Bird>& predator : near_p1) {
+      arrays.push_back(predator->getPosition(), predator->getVelocity());
+    }
+    CHECK(p1.chase(ch, {0, 1, 2}, arrays) == p1.chase(ch, near_p1));
   }
 
   SUBCASE("Testing friction method") {
@@ -592,6 +649,749 @@ TEST_CASE("Testing functions in namespace triangles") {
                                      static_cast<float>(triangles::relative_position[5].x * std::sin(theta2) +
                                                         triangles::relative_position[5].y * std::cos(theta2))));
   }
+  SUBCASE("Testing triangles::rotateTriangles() and triangles::updateTriangles()") {
+    storage::BirdArrays birds;
+    for (int k = 0; k < 7; ++k) {
+      // an odd number of birds, so that the vectorized loops leave a remainder, and one bird at rest
+      birds.push_back(point::Point(100. + 31.7 * k, 500. - 17.3 * k),
+                      k == 3 ? point::Point(0., 0.) : point::Point(std::cos(1.1 * k) * 9., std::sin(2.3 * k) * 7.));
+    }
+
+    // the first three birds are used as predators as well
+    sf::VertexArray batched(sf::Triangles, 3 * (birds.size() + 3));
+    sf::VertexArray single(sf::Triangles, 3 * (birds.size() + 3));
+    triangles::rotateTriangles(birds, true, birds.size(), batched, 0, birds.size());
+    triangles::rotateTriangles(birds, false, birds.size(), batched, 0, 3);
+    for (size_t i = 0; i < birds.size(); ++i) {
+      triangles::rotateTriangle(birds.position(i), single, birds.velocity(i).angle(), i, true, birds.size());
+    }
+    for (size_t i = 0; i < 3; ++i) {
+      triangles::rotateTriangle(birds.position(i), single, birds.velocity(i).angle(), i, false, birds.size());
+    }
+
+    for (size_t k = 0; k < batched.getVertexCount(); ++k) {
+      CHECK(batched[k].position.x == doctest::Approx(single[k].position.x));
+      CHECK(batched[k].position.y == doctest::Approx(single[k].position.y));
+    }
+
+    // a range of one bird goes through the scalar loop only, whose vertices the vector lanes reproduce exactly
+    sf::VertexArray scalar(sf::Triangles, 3 * (birds.size() + 3));
+    for (size_t i = 0; i < birds.size(); ++i) {
+      triangles::rotateTriangles(birds, true, birds.size(), scalar, i, i + 1);
+    }
+    for (size_t i = 0; i < 3; ++i) {
+      triangles::rotateTriangles(birds, false, birds.size(), scalar, i, i + 1);
+    }
+    for (size_t k = 0; k < batched.getVertexCount(); ++k) {
+      CHECK(batched[k].position == scalar[k].position);
+    }
+
+    triangles::createTriangles(flock1, triangles);
+    triangles::updateTriangles(flock1, triangles);
+    triangles::rotateTriangle(p1->getPosition(), single, p1->getVelocity().angle(), 0, false, 2);
+    CHECK(triangles[6].position.x == doctest::Approx(single[6].position.x));
+    CHECK(triangles[7].position.y == doctest::Approx(single[7].position.y));
+    CHECK(triangles[6].color == sf::Color::Red);
+  }
+}
+
+//======================================================================================================================
+//===TESTING FUNCTIONS IN NAMESPACE RENDERER============================================================================
+//======================================================================================================================
+
+TEST_CASE("Testing functions in namespace renderer") {
+  SUBCASE("Testing renderer::packBirds()") {
+    std::vector<sf::Vertex> points;
+    renderer::packBirds(flock1.getBoidArrays(), flock1.getPredatorArrays(), points);
+
+    REQUIRE(points.size() == flock1.getFlockSize());
+    CHECK(points[0].position == pos1().position);
+    CHECK(points[0].color == sf::Color::Blue);
+    CHECK(points[2].position == pos3().position);
+    CHECK(points[2].color == sf::Color::Red);
+
+    // texCoords carry the sine and the cosine of the angle rotateTriangle() is given
+    for (size_t k = 0; k < points.size(); ++k) {
+      const point::Point velocity =
+          k < flock1.getBoidsNum() ? flock1.getBoidArrays().velocity(k)
+                                   : flock1.getPredatorArrays().velocity(k - flock1.getBoidsNum());
+      CHECK(points[k].texCoords.x == doctest::Approx(std::sin(velocity.angle())).epsilon(1e-5));
+      CHECK(points[k].texCoords.y == doctest::Approx(std::cos(velocity.angle())).epsilon(1e-5));
+    }
+  }
+
+  SUBCASE("Testing BirdRenderer class on the CPU path") {
+    renderer::BirdRenderer birds(flock1, false);
+    CHECK(birds.getPath() == renderer::Path::Cpu);
+
+    sf::VertexArray triangles(sf::Triangles, 3 * flock1.getFlockSize());
+    triangles::createTriangles(flock1, triangles);
+    triangles::updateTriangles(flock1, triangles);
+
+    REQUIRE(birds.getTriangles().getVertexCount() == triangles.getVertexCount());
+    for (size_t k = 0; k < triangles.getVertexCount(); ++k) {
+      CHECK(birds.getTriangles()[k].position == triangles[k].position);
+      CHECK(birds.getTriangles()[k].color == triangles[k].color);
+    }
+  }
+
+  SUBCASE("Testing BirdRenderer class on a drawn frame") {
+    // SFML aborts when it cannot open a display, so without one there is no context to draw with
+    if (std::getenv("DISPLAY") == nullptr) {
+      MESSAGE("no display: the drawing of the birds is not tested");
+      return;
+    }
+    sf::RenderTexture texture;
+    if (!texture.create(200, 100)) {
+      MESSAGE("no OpenGL context: the drawing of the birds is not tested");
+      return;
+    }
+
+    // a boid heading right and a predator heading down-left, the second drawn with the larger shape
+    std::vector<std::shared_ptr<bird::Boid>> drawn_boids{
+        std::make_shared<bird::Boid>(point::Point(50., 50.), point::Point(10., 0.))};
+    std::vector<std::shared_ptr<bird::Predator>> drawn_predators{
+        std::make_shared<bird::Predator>(point::Point(150., 50.), point::Point(-5., 5.))};
+    const flock::Flock drawn(drawn_boids, drawn_predators, 12., 8., 7., 5.);
+
+    const auto draw = [&texture](const renderer::BirdRenderer& birds) {
+      texture.clear(sf::Color::Black);
+      texture.draw(birds);
+      texture.display();
+      return texture.getTexture().copyToImage();
+    };
+    const renderer::BirdRenderer cpu(drawn, false);
+    const sf::Image expected{draw(cpu)};
+    size_t blue{0};
+    size_t red{0};
+    for (unsigned y = 0; y < 100; ++y) {
+      for (unsigned x = 0; x < 200; ++x) {
+        blue += expected.getPixel(x, y) == sf::Color::Blue;
+        red += expected.getPixel(x, y) == sf::Color::Red;
+      }
+    }
+    CHECK(expected.getPixel(50, 50) == sf::Color::Blue);
+    CHECK(expected.getPixel(150, 50) == sf::Color::Red);
+    // the areas of the triangles are 52.5 and 118 pixels
+    CHECK(static_cast<double>(blue) == doctest::Approx(52.5).epsilon(0.15));
+    CHECK(static_cast<double>(red) == doctest::Approx(118.).epsilon(0.15));
+
+    const renderer::BirdRenderer gpu(drawn, true);
+    if (gpu.getPath() != renderer::Path::Gpu) {
+      MESSAGE("no geometry shaders: the GPU path is not tested");
+      return;
+    }
+    // the shader rotates the same triangles as the CPU, up to the rasterization of their edges
+    const sf::Image image{draw(gpu)};
+    size_t different{0};
+    for (unsigned y = 0; y < 100; ++y) {
+      for (unsigned x = 0; x < 200; ++x) {
+        different += !(image.getPixel(x, y) == expected.getPixel(x, y));
+      }
+    }
+    CHECK(image.getPixel(50, 50) == sf::Color::Blue);
+    CHECK(image.getPixel(150, 50) == sf::Color::Red);
+    CHECK(different <= 6);
+  }
+}
+
+//======================================================================================================================
+//===TESTING FUNCTIONS IN NAMESPACE CONFIG==============================================================================
+//======================================================================================================================
+
+TEST_CASE("Testing functions in namespace config") {
+  SUBCASE("Testing the defaults") {
+    const config::Config settings;
+    CHECK_FALSE(settings.n_boids.has_value());
+    CHECK_FALSE(settings.hasFlightParams());
+    CHECK_FALSE(settings.seed.has_value());
+    CHECK(settings.parameters.d == flock::Flock::getDistancesParams()[0]);
+    CHECK(settings.parameters.margin == flock::Flock::getMargin());
+    CHECK(settings.parameters.width == graphic_par::window_width);
+    CHECK(settings.parameters.boundary == flock::Boundary::Walls);
+    CHECK(settings.steps_per_second == 60.);
+    CHECK(settings.skin == 0.);
+    CHECK(settings.reorder_every == 0);
+    CHECK(settings.field_of_view == flock::FieldOfView::Angle);
+  }
+
+  SUBCASE("Testing toSize() and toDouble()") {
+    CHECK(config::toSize("--steps", "250") == 250);
+    // a seed takes any value of std::uint64_t
+    CHECK(config::toSize("--seed", "18446744073709551615") == 18446744073709551615u);
+    CHECK(config::toSize("--seed", "9223372036854775808") == 9223372036854775808u);
+    CHECK(config::toDouble("--error", "0.5") == 0.5);
+    CHECK(config::toDouble("--error", "-2e1") == -20.);
+
+    CHECK_THROWS_WITH_AS(config::toSize("--steps", "ten"), "Error: --steps must be a non-negative integer, not 'ten'.",
+                         std::domain_error);
+    CHECK_THROWS_AS(config::toSize("--steps", "-1"), std::domain_error);
+    CHECK_THROWS_AS(config::toSize("--steps", " -0"), std::domain_error);
+    CHECK_THROWS_AS(config::toSize("--seed", "18446744073709551616"), std::domain_error);
+    CHECK_THROWS_AS(config::toSize("--steps", "12x"), std::domain_error);
+    CHECK_THROWS_AS(config::toSize("--steps", "99999999999999999999"), std::domain_error);
+    CHECK_THROWS_AS(config::toSize("--steps", ""), std::domain_error);
+    CHECK_THROWS_WITH_AS(config::toDouble("--error", "nan"), "Error: --error must be a number, not 'nan'.",
+                         std::domain_error);
+    CHECK_THROWS_AS(config::toDouble("--error", "inf"), std::domain_error);
+    CHECK_THROWS_AS(config::toDouble("--error", "1e999"), std::domain_error);
+    CHECK_THROWS_AS(config::toDouble("--error", "0.5.1"), std::domain_error);
+  }
+
+  SUBCASE("Testing set()") {
+    config::Config settings;
+    config::set(settings, "boids", "250");
+    config::set(settings, "cohesion", "0.01");
+    config::set(settings, "boid-sight-angle", "90");
+    config::set(settings, "turn_factor", "3.5");
+    config::set(settings, "gpu", "false");
+    config::set(settings, "stats", "sampled");
+    config::set(settings, "skin", "15");
+    config::set(settings, "reorder-every", "20");
+    config::set(settings, "boundary", "torus");
+    config::set(settings, "field-of-view", "cone");
+    CHECK(settings.n_boids == 250);
+    CHECK(settings.hasFlightParams());
+    CHECK(settings.c == 0.01);
+    CHECK(settings.parameters.b_sight_angle == doctest::Approx(M_PI / 2.));
+    CHECK(settings.parameters.turn_factor == 3.5);
+    CHECK_FALSE(settings.prefer_gpu);
+    CHECK(settings.stats_mode == statistics::Mode::Sampled);
+    CHECK(settings.skin == 15.);
+    CHECK(settings.reorder_every == 20);
+    CHECK(settings.parameters.boundary == flock::Boundary::Torus);
+    CHECK(settings.field_of_view == flock::FieldOfView::Cone);
+
+    CHECK_THROWS_AS(config::set(settings, "boids", "0"), std::domain_error);
+    CHECK_THROWS_AS(config::set(settings, "field_of_view", "ahead"), std::domain_error);
+    CHECK_THROWS_AS(config::set(settings, "skin", "-1"), std::domain_error);
+    CHECK_THROWS_AS(config::set(settings, "reorder_every", "-1"), std::domain_error);
+    CHECK_THROWS_AS(config::set(settings, "boundary", "mirror"), std::domain_error);
+    CHECK_THROWS_AS(config::set(settings, "boids", "-3"), std::domain_error);
+    CHECK_THROWS_AS(config::set(settings, "margin", "wide"), std::domain_error);
+    CHECK_THROWS_AS(config::set(settings, "gpu", "maybe"), std::domain_error);
+    CHECK_THROWS_AS(config::set(settings, "gravity", "9.8"), std::domain_error);
+  }
+
+  SUBCASE("Testing load()") {
+    config::Config settings;
+    std::istringstream file{"# a scene\n\n  predators = 4   # a few\nmargin=80\ndt = 0.35\ndistribution = ring\n"};
+    config::load(settings, file);
+    CHECK(settings.n_predators == 4);
+    CHECK(settings.parameters.margin == 80.);
+    CHECK(settings.parameters.dt == 0.35);
+    CHECK(settings.distribution == flock::Distribution::Ring);
+
+    std::istringstream bad_line{"boids = 10\nwidth 1000\n"};
+    CHECK_THROWS_WITH_AS(config::load(settings, bad_line), "Error: line 2 is not of the form key = value.",
+                         std::domain_error);
+    std::istringstream bad_value{"boids = ten\n"};
+    CHECK_THROWS_WITH_AS(config::load(settings, bad_value),
+                         "Error: line 1: boids must be a non-negative integer, not 'ten'.", std::domain_error);
+  }
+
+  SUBCASE("Testing parseArguments()") {
+    const std::string path{(std::filesystem::temp_directory_path() / "boids_config_test.cfg").string()};
+    {
+      std::ofstream file(path);
+      file << "boids = 300\nseparation = 0.2\n";
+    }
+
+    // later settings override earlier ones, those of the file included
+    config::Config settings;
+    const std::array<const char*, 7> argv{"Boids", "--boids", "100", "--config", path.c_str(), "--separation", "0.3"};
+    config::parseArguments(settings, static_cast<int>(argv.size()), argv.data());
+    CHECK(settings.n_boids == 300);
+    CHECK(settings.s == 0.3);
+
+    const std::array<const char*, 2> missing{"Boids", "--boids"};
+    CHECK_THROWS_AS(config::parseArguments(settings, 2, missing.data()), std::domain_error);
+    const std::array<const char*, 3> positional{"Boids", "boids", "3"};
+    CHECK_THROWS_AS(config::parseArguments(settings, 3, positional.data()), std::domain_error);
+    const std::array<const char*, 3> no_file{"Boids", "--config", "/nonexistent/boids.cfg"};
+    CHECK_THROWS_AS(config::parseArguments(settings, 3, no_file.data()), std::runtime_error);
+
+    std::filesystem::remove(path);
+  }
+
+  SUBCASE("Testing Flock::setParameters()") {
+    flock::Flock flock0(200, 2);
+    flock0.generateBirds(3);
+    flock::Flock flock2{flock0};
+
+    // a time step twice as long moves the birds twice as far in a step
+    flock::Parameters params;
+    params.dt = 2. * params.dt;
+    flock2.setParameters(params);
+    CHECK(flock2.getParameters().dt == params.dt);
+    flock0.evolve();
+    flock2.evolve();
+    const storage::BirdArrays& before = flock0.getBoidArrays();
+    const storage::BirdArrays& after = flock2.getBoidArrays();
+    CHECK(after.vx == before.vx);
+    const double moved0{before.x[5] - before.vx[5] * flock::Parameters().dt};
+    const double moved2{after.x[5] - after.vx[5] * params.dt};
+    CHECK(moved2 == doctest::Approx(moved0));
+
+    // a neighbourhood smaller than any distance leaves every bird alone
+    flock::Parameters blind;
+    blind.d = 1e-3;
+    blind.b_ds = 1e-3;
+    blind.p_ds = 1e-3;
+    flock2.setParameters(blind);
+    bool alone{true};
+    for (size_t i = 0; i < 200; ++i) {
+      alone = alone && flock2.findNearBoids(i, true).empty();
+    }
+    CHECK(alone);
+
+    // invalid parameters are rejected and leave the flock unchanged
+    flock::Parameters wrong;
+    wrong.b_ds = 2. * wrong.d;
+    CHECK_THROWS_AS(flock2.setParameters(wrong), std::domain_error);
+    wrong = flock::Parameters();
+    wrong.b_min_speed = 2. * wrong.b_max_speed;
+    CHECK_THROWS_AS(flock2.setParameters(wrong), std::domain_error);
+    wrong = flock::Parameters();
+    wrong.p_sight_angle = 4.;
+    CHECK_THROWS_AS(flock2.setParameters(wrong), std::domain_error);
+    wrong = flock::Parameters();
+    wrong.height = 150.;
+    CHECK_THROWS_AS(flock2.setParameters(wrong), std::domain_error);
+    CHECK(flock2.getParameters().d == 1e-3);
+  }
+
+  SUBCASE("Testing Bird::border() in a world of another size") {
+    const bird::Boid boid(point::Point(1150., 500.), point::Point(1., 1.));
+    // inside the window, but near the right and bottom edges of a smaller world
+    CHECK(boid.border(100., 2.5) == point::Point(1., 1.));
+    CHECK(boid.border(100., 2.5, 1200., 550.) == point::Point(-1.5, -1.5));
+    CHECK(boid.border(100., 2.5, graphic_par::window_width, graphic_par::window_height) == boid.border(100., 2.5));
+  }
+}
+
+//======================================================================================================================
+//===TESTING FUNCTIONS IN NAMESPACE RNG=================================================================================
+//======================================================================================================================
+
+TEST_CASE("Testing functions in namespace tasks") {
+  SUBCASE("Testing toValues()") {
+    CHECK(tasks::toValues("--separation", "0.1") == std::vector<double>{0.1});
+    CHECK(tasks::toValues("--separation", "0.1,0.2,0.5") == std::vector<double>{0.1, 0.2, 0.5});
+    CHECK(tasks::toValues("--separation", "0:1:5") == std::vector<double>{0., 0.25, 0.5, 0.75, 1.});
+    CHECK(tasks::toValues("--separation", "0.3:1:1") == std::vector<double>{0.3});
+
+    CHECK_THROWS_WITH_AS(tasks::toValues("--separation", "0.1,x"), "Error: --separation must be a number, not 'x'.",
+                         std::domain_error);
+    CHECK_THROWS_AS(tasks::toValues("--separation", "0.1,nan"), std::domain_error);
+    CHECK_THROWS_AS(tasks::toValues("--separation", "0:1"), std::domain_error);
+    CHECK_THROWS_AS(tasks::toValues("--separation", "0:1:-2"), std::domain_error);
+    CHECK_THROWS_AS(tasks::toValues("--separation", "0:1:0"), std::domain_error);
+    CHECK_THROWS_AS(tasks::toValues("--separation", ""), std::domain_error);
+  }
+
+  SUBCASE("Testing makeTasks() and describe()") {
+    const std::vector<tasks::Task> grid{tasks::makeTasks({0.1, 0.2}, {0.3}, {0.01, 0.02}, 2, 7)};
+    REQUIRE(grid.size() == 8);
+    for (size_t k = 0; k < grid.size(); ++k) {
+      CHECK(grid[k].index == k);
+    }
+    CHECK(grid[3].s == 0.1);
+    CHECK(grid[3].c == 0.02);
+    CHECK(grid[3].repeat == 1);
+    CHECK(grid[3].seed == 8);
+    CHECK(grid[4].s == 0.2);
+    CHECK(tasks::describe(grid[3]) == "3,0.1,0.3,0.02,1,8");
+
+    // every setting changing the rows changes the settings line
+    config::Config settings;
+    const statistics::Options stats;
+    const std::string line{tasks::describe(settings, 1000, stats)};
+    CHECK(line.compare(0, 13, "# steps=1000 ") == 0);
+    CHECK(line == tasks::describe(settings, 1000, stats));
+    CHECK(line != tasks::describe(settings, 999, stats));
+    config::set(settings, "boids", "1000");
+    CHECK(line == tasks::describe(settings, 1000, stats));
+    config::set(settings, "predators", "3");
+    CHECK(line != tasks::describe(settings, 1000, stats));
+    settings = config::Config();
+    settings.parameters.turn_factor += 1e-12;
+    CHECK(line != tasks::describe(settings, 1000, stats));
+    settings = config::Config();
+    config::set(settings, "boundary", "torus");
+    CHECK(line != tasks::describe(settings, 1000, stats));
+    settings = config::Config();
+    config::set(settings, "field_of_view", "cone");
+    CHECK(line != tasks::describe(settings, 1000, stats));
+    settings = config::Config();
+    config::set(settings, "distribution", "ring");
+    CHECK(line != tasks::describe(settings, 1000, stats));
+    settings = config::Config();
+    const statistics::Options sampled{statistics::Mode::Sampled, 1., 1000, 1};
+    CHECK(line != tasks::describe(settings, 1000, sampled));
+  }
+
+  SUBCASE("Testing readDone()") {
+    const std::string path{(std::filesystem::temp_directory_path() / "boids_sweep_test.csv").string()};
+    const std::vector<tasks::Task> grid{tasks::makeTasks({0.1, 0.2}, {0.3}, {0.01}, 2, 1)};
+    const std::string settings{tasks::describe(config::Config(), 1000, statistics::Options())};
+    const auto write = [&path](const std::string& text) {
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      file << text;
+    };
+    const std::string head{settings + '\n' + tasks::columns + '\n'};
+    const std::string row0{tasks::describe(grid[0]) + ",1,2,3,4,5,6\n"};
+    const std::string row2{tasks::describe(grid[2]) + ",1,2,3,4,5,6\n"};
+
+    std::filesystem::remove(path);
+    CHECK(tasks::readDone(path, settings, grid) == std::vector<bool>(4, false));
+
+    // a row cut by an interruption is removed
+    write(head + row2 + row0 + "1,0.1,0.3");
+    CHECK(tasks::readDone(path, settings, grid) == std::vector<bool>{true, false, true, false});
+    CHECK(std::filesystem::file_size(path) == head.size() + row2.size() + row0.size());
+
+    // a file cut within its first lines is emptied
+    write(settings.substr(0, 20));
+    CHECK(tasks::readDone(path, settings, grid) == std::vector<bool>(4, false));
+    CHECK(std::filesystem::file_size(path) == 0);
+
+    // other settings, another grid and other files are refused, and left unchanged
+    write(tasks::describe(config::Config(), 500, statistics::Options()) + '\n' + tasks::columns + '\n' + row0);
+    CHECK_THROWS_AS(tasks::readDone(path, settings, grid), std::runtime_error);
+    write(head + "0,0.5,0.3,0.01,0,1,1,2,3,4,5,6\n");
+    CHECK_THROWS_WITH_AS(tasks::readDone(path, settings, grid),
+                         ("Error: " + path + " was written by a sweep over another grid.").c_str(), std::runtime_error);
+    write(head + "99999999999999999999999,0.1\n");
+    CHECK_THROWS_AS(tasks::readDone(path, settings, grid), std::runtime_error);
+    write(std::string(tasks::columns) + '\n' + row0);
+    CHECK_THROWS_AS(tasks::readDone(path, settings, grid), std::runtime_error);
+    write("x,y\n");
+    CHECK_THROWS_AS(tasks::readDone(path, settings, grid), std::runtime_error);
+    CHECK(std::filesystem::file_size(path) == 4);
+
+    std::filesystem::remove(path);
+  }
+}
+
+TEST_CASE("Testing functions in namespace rng") {
+  SUBCASE("Testing the reference outputs") {
+    // the outputs are fixed by the algorithms alone: they are the same on every platform
+    std::uint64_t state{0};
+    CHECK(rng::splitmix64(state) == 0xe220a8397b1dcdafu);
+
+    rng::Xoshiro256 engine(0);
+    CHECK(engine() == 11091344671253066420u);
+    CHECK(engine() == 13793997310169335082u);
+    CHECK(engine() == 1900383378846508768u);
+
+    rng::Xoshiro256 stream(42, 0);
+    CHECK(stream.uniform() == 0.10114251884320236);
+  }
+
+  SUBCASE("Testing the draws") {
+    rng::Xoshiro256 engine(7);
+    std::array<int, 6> counts{};
+    bool in_range{true};
+    for (int k = 0; k < 60000; ++k) {
+      const double u{engine.uniform(-2., 3.)};
+      in_range = in_range && u >= -2. && u < 3.;
+      ++counts[static_cast<size_t>(engine.below(6))];
+    }
+    CHECK(in_range);
+    for (const int count : counts) {
+      CHECK(std::abs(count - 10000) < 500);
+    }
+    CHECK(engine.below(1) == 0);
+  }
+
+  SUBCASE("Testing the streams") {
+    rng::Xoshiro256 first(3, 0);
+    rng::Xoshiro256 again(3, 0);
+    rng::Xoshiro256 second(3, 1);
+    rng::Xoshiro256 other_seed(4, 0);
+    const std::uint64_t value{first()};
+    CHECK(again() == value);
+    CHECK(second() != value);
+    CHECK(other_seed() != value);
+  }
+
+  SUBCASE("Testing Flock::generateBirds() with a seed") {
+    flock::Flock seeded0(5000, 10);
+    flock::Flock seeded1(5000, 10);
+    flock::Flock smaller(4200, 3);
+    seeded0.generateBirds(11);
+    seeded1.generateBirds(11);
+    smaller.generateBirds(11);
+
+    CHECK(seeded0.getBoidArrays().x == seeded1.getBoidArrays().x);
+    CHECK(seeded0.getBoidArrays().vy == seeded1.getBoidArrays().vy);
+    CHECK(seeded0.getPredatorArrays().vx == seeded1.getPredatorArrays().vx);
+
+    // each chunk of birds has its own stream: the birds of a smaller flock are the first of a larger one
+    CHECK(smaller.getBoidArrays().x[4199] == seeded0.getBoidArrays().x[4199]);
+    CHECK(smaller.getBoidArrays().vx[4100] == seeded0.getBoidArrays().vx[4100]);
+    CHECK(smaller.getPredatorArrays().y[2] == seeded0.getPredatorArrays().y[2]);
+
+    seeded1.generateBirds(12);
+    CHECK(seeded0.getBoidArrays().x != seeded1.getBoidArrays().x);
+
+    bool in_area{true};
+    for (size_t i = 0; i < 5000; ++i) {
+      const storage::BirdArrays& birds = seeded0.getBoidArrays();
+      in_area = in_area && birds.x[i] >= graphic_par::stats_width && birds.x[i] < graphic_par::window_width &&
+                birds.y[i] >= 0. && birds.y[i] < graphic_par::window_height &&
+                std::abs(birds.vx[i]) <= graphic_par::max_vel_x && std::abs(birds.vy[i]) <= graphic_par::max_vel_y;
+    }
+    CHECK(in_area);
+  }
+
+  SUBCASE("Testing Flock::generateBirds() with a distribution") {
+    const double cx{(graphic_par::stats_width + graphic_par::window_width) / 2.};
+    const double cy{graphic_par::window_height / 2.};
+
+    for (const flock::Distribution distribution : {flock::Distribution::Uniform, flock::Distribution::Clustered,
+                                                   flock::Distribution::Ring, flock::Distribution::Gaussian}) {
+      // the chunks are generated in parallel, yet the flock does not depend on the number of threads
+      flock::Flock serial(20000, 50);
+      flock::Flock parallel(20000, 50);
+      parallel.setThreads(4);
+      serial.generateBirds(5, distribution);
+      parallel.generateBirds(5, distribution);
+      CHECK(serial.getBoidArrays().x == parallel.getBoidArrays().x);
+      CHECK(serial.getBoidArrays().y == parallel.getBoidArrays().y);
+      CHECK(serial.getPredatorArrays().vy == parallel.getPredatorArrays().vy);
+
+      const storage::BirdArrays& birds = serial.getBoidArrays();
+      bool in_area{true};
+      double mean_x{0.};
+      double mean_y{0.};
+      double min_radius{graphic_par::window_width};
+      double max_radius{0.};
+      for (size_t i = 0; i < birds.size(); ++i) {
+        in_area = in_area && birds.x[i] >= graphic_par::stats_width && birds.x[i] <= graphic_par::window_width &&
+                  birds.y[i] >= 0. && birds.y[i] <= graphic_par::window_height;
+        mean_x += birds.x[i] / static_cast<double>(birds.size());
+        mean_y += birds.y[i] / static_cast<double>(birds.size());
+        const double radius{std::hypot(birds.x[i] - cx, birds.y[i] - cy)};
+        min_radius = std::min(min_radius, radius);
+        max_radius = std::max(max_radius, radius);
+      }
+      CHECK(in_area);
+
+      if (distribution == flock::Distribution::Ring) {
+        CHECK(min_radius >= 0.35 * graphic_par::window_height - 1e-9);
+        CHECK(max_radius <= 0.45 * graphic_par::window_height + 1e-9);
+      }
+      if (distribution == flock::Distribution::Gaussian || distribution == flock::Distribution::Ring) {
+        CHECK(mean_x == doctest::Approx(cx).epsilon(0.01));
+        CHECK(mean_y == doctest::Approx(cy).epsilon(0.01));
+      }
+      if (distribution == flock::Distribution::Clustered) {
+        // at most 8 clusters of radius ~40: most of the cells of a 100 pixel grid are empty
+        std::vector<int> cells(19 * 9, 0);
+        for (size_t i = 0; i < birds.size(); ++i) {
+          cells[static_cast<size_t>(std::min(birds.x[i] / 100., 18.)) * 9 +
+                static_cast<size_t>(std::min(birds.y[i] / 100., 8.))] = 1;
+        }
+        CHECK(std::count(cells.begin(), cells.end(), 1) < 60);
+      }
+    }
+  }
+}
+
+//======================================================================================================================
+//===TESTING GRID CLASS=================================================================================================
+//======================================================================================================================
+
+TEST_CASE("Testing Grid class") {
+  grid::Grid grid(d);
+
+  std::vector<point::Point> positions;
+  for (int k = 0; k < 400; ++k) {
+    // deterministic scatter over a region much larger than a cell, with a few far outliers
+    const double x = std::fmod(k * 37.3, 1200.) + (k % 97 == 0 ? 1.e5 : 0.);
+    const double y = std::fmod(k * 53.9, 700.) - (k % 89 == 0 ? 1.e5 : 0.);
+    positions.emplace_back(x, y);
+  }
+  std::vector<double> xs;
+  std::vector<double> ys;
+  for (const point::Point& p : positions) {
+    xs.push_back(p.getX());
+    ys.push_back(p.getY());
+  }
+  grid.build(xs, ys);
+
+  SUBCASE("Testing build method") { CHECK(grid.size() == positions.size()); }
+
+  SUBCASE("Testing forEachCandidate method") {
+    const std::vector<point::Point> queries{positions[0], positions[97], point::Point(600., 350.),
+                                            point::Point(-500., 2000.)};
+    for (const point::Point& q : queries) {
+      std::vector<size_t> candidates;
+      grid.forEachCandidate(q, [&candidates](const size_t j) { candidates.push_back(j); });
+      std::sort(candidates.begin(), candidates.end());
+
+      CHECK(std::adjacent_find(candidates.begin(), candidates.end()) == candidates.end());
+      for (size_t j = 0; j < positions.size(); ++j) {
+        if (q.distance(positions[j]) < d) {
+          CHECK(std::binary_search(candidates.begin(), candidates.end(), j));
+        }
+      }
+    }
+
+    grid.build({}, {});
+    size_t visited{0};
+    grid.forEachCandidate(point::Point(0., 0.), [&visited](size_t) { ++visited; });
+    CHECK(visited == 0);
+  }
+
+  SUBCASE("Testing buildPeriodic method") {
+    // a torus of 1200 x 700 pixels from (0, 0): the distance between the closest images of two points
+    const auto distance = [](const point::Point& a, const point::Point& b) {
+      const double dx = std::abs(a.getX() - b.getX());
+      const double dy = std::abs(a.getY() - b.getY());
+      return std::hypot(std::min(dx, 1200. - dx), std::min(dy, 700. - dy));
+    };
+    std::vector<double> inside_x;
+    std::vector<double> inside_y;
+    std::vector<point::Point> inside;
+    for (size_t j = 0; j < positions.size(); ++j) {
+      if (std::abs(xs[j]) < 1.e4 && std::abs(ys[j]) < 1.e4) {
+        inside_x.push_back(xs[j]);
+        inside_y.push_back(ys[j]);
+        inside.push_back(positions[j]);
+      }
+    }
+    grid.buildPeriodic(inside_x, inside_y, 0., 0., 1200., 700.);
+    CHECK(grid.size() == inside.size());
+
+    // the corners are next to each other, and a point outside the world is searched around its image
+    const std::vector<point::Point> queries{point::Point(5., 5.), point::Point(1195., 695.), point::Point(600., 2.),
+                                            point::Point(-30., 350.)};
+    for (const point::Point& q : queries) {
+      std::vector<size_t> candidates;
+      grid.forEachCandidate(q, [&candidates](const size_t j) { candidates.push_back(j); });
+      std::sort(candidates.begin(), candidates.end());
+
+      CHECK(std::adjacent_find(candidates.begin(), candidates.end()) == candidates.end());
+      bool exhaustive{true};
+      for (size_t j = 0; j < inside.size(); ++j) {
+        if (distance(q, inside[j]) < d) {
+          exhaustive = exhaustive && std::binary_search(candidates.begin(), candidates.end(), j);
+        }
+      }
+      CHECK(exhaustive);
+    }
+
+    // with fewer than three cells a side, each cell is visited once
+    grid::Grid coarse(d);
+    coarse.buildPeriodic(inside_x, inside_y, 0., 0., 1.5 * d, 2.5 * d);
+    std::vector<size_t> all;
+    coarse.forEachCandidate(point::Point(10., 10.), [&all](const size_t j) { all.push_back(j); });
+    CHECK(all.size() == inside.size());
+  }
+}
+
+//======================================================================================================================
+//===TESTING FUNCTIONS IN NAMESPACE MORTON==============================================================================
+//======================================================================================================================
+
+TEST_CASE("Testing functions in namespace morton") {
+  SUBCASE("Testing encode()") {
+    CHECK(morton::encode(0, 0) == 0);
+    CHECK(morton::encode(1, 0) == 1);
+    CHECK(morton::encode(0, 1) == 2);
+    CHECK(morton::encode(3, 3) == 15);
+    CHECK(morton::encode(4, 0) == 16);
+    CHECK(morton::encode(0xffff, 0) == 0x55555555u);
+    CHECK(morton::encode(0xffff, 0xffff) == 0xffffffffu);
+  }
+
+  SUBCASE("Testing order()") {
+    // the corners of a square, then its centre twice: the centre comes before the three quadrants of larger codes
+    const std::vector<double> x{10., 0., 10., 0., 5., 5.};
+    const std::vector<double> y{10., 0., 0., 10., 5., 5.};
+    std::vector<size_t> permutation;
+    morton::order(x, y, permutation);
+    CHECK(permutation == std::vector<size_t>{1, 4, 5, 2, 3, 0});
+
+    // any bounding box, however elongated
+    std::vector<float> xs;
+    std::vector<float> ys;
+    rng::Xoshiro256 generator(3);
+    for (int k = 0; k < 1000; ++k) {
+      xs.push_back(static_cast<float>(generator.uniform(-1e3, 1e5)));
+      ys.push_back(static_cast<float>(generator.uniform(0., 50.)));
+    }
+    morton::order(xs, ys, permutation);
+    std::vector<size_t> sorted{permutation};
+    std::sort(sorted.begin(), sorted.end());
+    bool is_permutation{true};
+    for (size_t k = 0; k < sorted.size(); ++k) {
+      is_permutation = is_permutation && sorted[k] == k;
+    }
+    CHECK(is_permutation);
+
+    morton::order(std::vector<float>{}, std::vector<float>{}, permutation);
+    CHECK(permutation.empty());
+    morton::order(std::vector<float>{2.f, 2.f, 2.f}, std::vector<float>{1.f, 1.f, 1.f}, permutation);
+    CHECK(permutation == std::vector<size_t>{0, 1, 2});
+  }
+}
+
+//======================================================================================================================
+//===TESTING BIRDARRAYS STRUCT==========================================================================================
+//======================================================================================================================
+
+TEST_CASE("Testing BirdArrays struct") {
+  storage::BirdArrays arrays;
+
+  SUBCASE("Testing push_back and getters") {
+    arrays.push_back(pos1, vel1);
+    arrays.push_back(pos2, vel2);
+
+    CHECK(arrays.size() == 2);
+    CHECK(arrays.position(0) == pos1);
+    CHECK(arrays.velocity(0) == vel1);
+    CHECK(arrays.position(1) == pos2);
+    CHECK(arrays.velocity(1) == vel2);
+  }
+
+  SUBCASE("Testing resize and set") {
+    arrays.resize(3);
+    arrays.set(2, pos3, vel3);
+
+    CHECK(arrays.size() == 3);
+    CHECK(arrays.position(0) == point::Point(0., 0.));
+    CHECK(arrays.position(2) == pos3);
+    CHECK(arrays.velocity(2) == vel3);
+  }
+}
+
+//======================================================================================================================
+//===TESTING THREADPOOL CLASS===========================================================================================
+//======================================================================================================================
+
+TEST_CASE("Testing ThreadPool class") {
+  pool::ThreadPool pool(4);
+
+  CHECK(pool.size() == 4);
+
+  SUBCASE("Testing parallelFor method") {
+    for (const size_t n : {size_t{0}, size_t{1}, size_t{7}, size_t{1000}}) {
+      std::vector<int> visits(n, 0);
+      std::vector<size_t> workers(n, pool.size());
+      pool.parallelFor(n, [&visits, &workers](const size_t begin, const size_t end, const size_t worker) {
+        for (size_t i = begin; i < end; ++i) {
+          ++visits[i];
+          workers[i] = worker;
+        }
+      });
+      CHECK(std::all_of(visits.begin(), visits.end(), [](const int v) { return v == 1; }));
+      CHECK(std::all_of(workers.begin(), workers.end(), [&pool](const size_t w) { return w < pool.size(); }));
+    }
+  }
 }
 
 //======================================================================================================================
@@ -607,6 +1407,9 @@ TEST_CASE("Testing Flock class") {
 
     CHECK(!flock0.getBoidFlock().empty());
     CHECK(!flock0.getPredatorFlock().empty());
+    CHECK(flock0.getBoidArrays().size() == 2);
+    CHECK(flock0.getPredatorArrays().size() == 2);
+    CHECK(flock0.getBoidFlock()[1]->getPosition() == flock0.getBoidArrays().position(1));
   }
 
   SUBCASE("Testing getters") {
@@ -674,6 +1477,74 @@ TEST_CASE("Testing Flock class") {
 
     CHECK(nearBoids2.size() == 1);
     CHECK(nearBoids2[0] == b1);
+
+    std::vector<size_t> near;
+    near.reserve(8);
+    const size_t* data = near.data();
+
+    flock1.findNearBoids(0, true, near);
+    CHECK(near == std::vector<size_t>{1});
+    flock1.findNearBoids(0, false, near);
+    CHECK(near == std::vector<size_t>{0});
+    CHECK(near.data() == data);
+  }
+
+  SUBCASE("Testing field of view") {
+    CHECK(flock1.getFieldOfView() == flock::FieldOfView::Angle);
+
+    // the former angular test and the cone agree on the configurations above
+    flock1.setFieldOfView(flock::FieldOfView::Cone);
+    CHECK(flock1.getFieldOfView() == flock::FieldOfView::Cone);
+
+    CHECK(flock1.findNearBoids(0, true).size() == 1);
+    CHECK(flock1.findNearBoids(0, true)[0] == b2);
+    CHECK(flock1.findNearBoids(0, false).size() == 1);
+    CHECK(flock1.findNearPredators(0, true).size() == 2);
+    CHECK(flock1.findNearPredators(0, false).size() == 1);
+    CHECK(flock1.findNearPredators(0, false)[0] == p2);
+
+    flock1.setFieldOfView(flock::FieldOfView::Angle);
+
+    // a boid heading up, with one boid directly ahead and one directly behind: the angular test sees the one
+    // behind only, the cone the one ahead only
+    std::vector<std::shared_ptr<bird::Boid>> line{
+        std::make_shared<bird::Boid>(point::Point(1000., 400.), point::Point(0., -10.)),
+        std::make_shared<bird::Boid>(point::Point(1000., 400. - d / 2), point::Point(0., -10.)),
+        std::make_shared<bird::Boid>(point::Point(1000., 400. + d / 2), point::Point(0., -10.))};
+    flock::Flock facing(line, {}, bMaxSpeed, pMaxSpeed, bMinSpeed, pMinSpeed);
+    std::vector<size_t> seen;
+    facing.findNearBoids(0, true, seen);
+    CHECK(seen == std::vector<size_t>{2});
+    facing.setFieldOfView(flock::FieldOfView::Cone);
+    facing.findNearBoids(0, true, seen);
+    CHECK(seen == std::vector<size_t>{1});
+
+    // the cone accepts a bird iff the angle between the velocity and the offset is below the sight angle
+    const point::Point centre(1000., 400.);
+    const point::Point heading(3., 4.);
+    std::vector<std::shared_ptr<bird::Boid>> ring{std::make_shared<bird::Boid>(centre, heading)};
+    for (int k = 0; k < 36; ++k) {
+      const double phi{(k * 10. + 5.) * M_PI / 180.};
+      const double rho{(k % 3 == 0) ? 1.2 * d : 0.6 * d};
+      ring.emplace_back(std::make_shared<bird::Boid>(centre + rho * point::Point(std::cos(phi), std::sin(phi)), heading));
+    }
+    flock::Flock flock0(ring, {}, bMaxSpeed, pMaxSpeed, bMinSpeed, pMinSpeed);
+    flock0.setFieldOfView(flock::FieldOfView::Cone);
+
+    std::vector<size_t> expected;
+    for (size_t j = 1; j < ring.size(); ++j) {
+      const point::Point offset = ring[j]->getPosition() - centre;
+      const double cos_angle = (offset.getX() * heading.getX() + offset.getY() * heading.getY()) /
+                               (offset.module() * heading.module());
+      if (offset.module() < d && std::acos(cos_angle) < 2. / 3 * M_PI) {
+        expected.push_back(j);
+      }
+    }
+    std::vector<size_t> near;
+    flock0.findNearBoids(0, true, near);
+
+    CHECK(!expected.empty());
+    CHECK(near == expected);
   }
 
   SUBCASE("Testing findNearPredators method") {
@@ -690,6 +1561,12 @@ TEST_CASE("Testing Flock class") {
     CHECK(nearPredators2.size() == 1);
     CHECK(nearPredators2[0] == p2);
 
+    std::vector<size_t> near{7, 7, 7};
+    flock1.findNearPredators(0, true, near);
+    CHECK(near == std::vector<size_t>{0, 1});
+    flock1.findNearPredators(0, false, near);
+    CHECK(near == std::vector<size_t>{1});
+
     flock::Flock flock2(2, 0);
     std::vector<std::shared_ptr<bird::Bird>> f2;
     f2.emplace_back(b1);
@@ -754,6 +1631,266 @@ TEST_CASE("Testing Flock class") {
     CHECK(update_predator[0].getY() == doctest::Approx(p_predator.getY()));
     CHECK(update_predator[1].getX() == doctest::Approx(v_predator.getX()));
     CHECK(update_predator[1].getY() == doctest::Approx(v_predator.getY()));
+
+    flock::Neighbours near;
+    CHECK(flock1.updateBird(triangles, 0, true, near) == update_boid);
+    CHECK(flock1.updateBird(triangles, 0, false, near) == update_predator);
+
+    // only the composed kernel lists the neighbours into the scratch storage
+    flock1.setKernel(flock::Kernel::Composed);
+    const std::array<point::Point, 2> composed = flock1.updateBird(triangles, 0, false, near);
+    CHECK(composed[1].getX() == doctest::Approx(update_predator[1].getX()));
+    CHECK(near.boids.size() == nearBoids2.size());
+    flock1.setKernel(flock::Kernel::Fused);
+  }
+
+  SUBCASE("Testing the fused kernel") {
+    CHECK(flock1.getKernel() == flock::Kernel::Fused);
+
+    flock::Flock fused(400, 6);
+    fused.generateBirds(11, flock::Distribution::Clustered);
+    flock::Flock composed(400, 6);
+    composed.generateBirds(11, flock::Distribution::Clustered);
+    composed.setKernel(flock::Kernel::Composed);
+    CHECK(composed.getKernel() == flock::Kernel::Composed);
+
+    // the clusters give every boid many neighbours, in and out of the separation distance
+    sf::VertexArray triangles0(sf::Triangles, 3 * fused.getFlockSize());
+    flock::Neighbours near;
+    size_t crowded{0};
+    for (size_t i = 0; i < fused.getBoidsNum(); ++i) {
+      const std::array<point::Point, 2> a = fused.updateBird(triangles0, i, true);
+      const std::array<point::Point, 2> b = composed.updateBird(triangles0, i, true, near);
+      CHECK(a[1].getX() == doctest::Approx(b[1].getX()));
+      CHECK(a[1].getY() == doctest::Approx(b[1].getY()));
+      CHECK(a[0].getX() == doctest::Approx(b[0].getX()));
+      if (near.boids.size() > 10) {
+        ++crowded;
+      }
+    }
+    CHECK(crowded > 100);
+    for (size_t i = 0; i < fused.getPredatorsNum(); ++i) {
+      const std::array<point::Point, 2> a = fused.updateBird(triangles0, i, false);
+      const std::array<point::Point, 2> b = composed.updateBird(triangles0, i, false, near);
+      CHECK(a[1].getX() == doctest::Approx(b[1].getX()));
+      CHECK(a[1].getY() == doctest::Approx(b[1].getY()));
+    }
+
+    for (int step = 0; step < 10; ++step) {
+      fused.evolve();
+      composed.evolve();
+    }
+    for (size_t i = 0; i < fused.getBoidsNum(); ++i) {
+      CHECK(fused.getBoidArrays().vx[i] == doctest::Approx(composed.getBoidArrays().vx[i]));
+      CHECK(fused.getBoidArrays().y[i] == doctest::Approx(composed.getBoidArrays().y[i]));
+    }
+  }
+
+  SUBCASE("Testing candidate lists") {
+    flock::Flock searched(400, 6);
+    searched.generateBirds(11, flock::Distribution::Clustered);
+    flock::Flock listed(400, 6);
+    listed.generateBirds(11, flock::Distribution::Clustered);
+
+    CHECK(listed.getSkin() == 0.);
+    CHECK_THROWS_AS(listed.setSkin(-1.), std::domain_error);
+    listed.setSkin(20.);
+    CHECK(listed.getSkin() == 20.);
+    CHECK(listed.getListBuilds() == 1);
+
+    // the lists hold the same neighbours as the grid, in the same order, so the composed kernel gives the same flock
+    searched.setKernel(flock::Kernel::Composed);
+    listed.setKernel(flock::Kernel::Composed);
+    std::vector<size_t> expected;
+    std::vector<size_t> near;
+    for (int step = 0; step < 30; ++step) {
+      for (size_t i = 0; i < listed.getBoidsNum(); i += 7) {
+        searched.findNearBoids(i, true, expected);
+        listed.findNearBoids(i, true, near);
+        CHECK(near == expected);
+        searched.findNearPredators(i, true, expected);
+        listed.findNearPredators(i, true, near);
+        CHECK(near == expected);
+      }
+      for (size_t i = 0; i < listed.getPredatorsNum(); ++i) {
+        searched.findNearBoids(i, false, expected);
+        listed.findNearBoids(i, false, near);
+        CHECK(near == expected);
+      }
+      searched.evolve();
+      listed.evolve();
+    }
+    CHECK(listed.getBoidArrays().x == searched.getBoidArrays().x);
+    CHECK(listed.getPredatorArrays().vy == searched.getPredatorArrays().vy);
+
+    // the lists are kept for a few steps, and rebuilt as the birds move
+    CHECK(listed.getListBuilds() > 5);
+    CHECK(listed.getListBuilds() < 25);
+
+    listed.setKernel(flock::Kernel::Fused);
+    searched.setKernel(flock::Kernel::Fused);
+    sf::VertexArray triangles0(sf::Triangles, 3 * listed.getFlockSize());
+    for (size_t i = 0; i < listed.getBoidsNum(); ++i) {
+      const std::array<point::Point, 2> a = listed.updateBird(triangles0, i, true);
+      const std::array<point::Point, 2> b = searched.updateBird(triangles0, i, true);
+      CHECK(a[1].getX() == doctest::Approx(b[1].getX()));
+      CHECK(a[1].getY() == doctest::Approx(b[1].getY()));
+    }
+  }
+
+  SUBCASE("Testing reordered birds") {
+    flock::Flock plain(400, 6);
+    plain.generateBirds(5, flock::Distribution::Clustered);
+    flock::Flock sorted{plain};
+
+    CHECK(sorted.getReorder() == 0);
+    sorted.setReorder(3);
+    CHECK(sorted.getReorder() == 3);
+    for (int step = 0; step < 7; ++step) {
+      plain.evolve();
+      sorted.evolve();
+    }
+
+    // the ids are a permutation, and each bird keeps its id: the flocks differ only by the order of the sums
+    const std::vector<size_t>& ids = sorted.getBoidIds();
+    REQUIRE(ids.size() == 400);
+    std::vector<size_t> numbers{ids};
+    std::sort(numbers.begin(), numbers.end());
+    bool is_permutation{true};
+    bool same{true};
+    for (size_t k = 0; k < ids.size(); ++k) {
+      is_permutation = is_permutation && numbers[k] == k;
+      same = same && sorted.getBoidArrays().x[k] == doctest::Approx(plain.getBoidArrays().x[ids[k]]) &&
+             sorted.getBoidArrays().vy[k] == doctest::Approx(plain.getBoidArrays().vy[ids[k]]);
+    }
+    CHECK(is_permutation);
+    CHECK_FALSE(std::is_sorted(ids.begin(), ids.end()));
+    CHECK(same);
+    const size_t predator{sorted.getPredatorIds()[2]};
+    CHECK(sorted.getPredatorArrays().y[2] == doctest::Approx(plain.getPredatorArrays().y[predator]));
+
+    // the birds are saved in the order of their ids
+    const std::string path{(std::filesystem::temp_directory_path() / "boids_reorder_test.bin").string()};
+    sorted.save(path);
+    flock::Flock loaded(1, 0);
+    loaded.load(path);
+    std::filesystem::remove(path);
+    CHECK(loaded.getBoidIds()[17] == 17);
+    CHECK(loaded.getBoidArrays().x[ids[9]] == sorted.getBoidArrays().x[9]);
+    CHECK(loaded.getPredatorArrays().vx[predator] == sorted.getPredatorArrays().vx[2]);
+  }
+
+  SUBCASE("Testing a toroidal world") {
+    flock::Parameters params;
+    params.boundary = flock::Boundary::Torus;
+    const double left{graphic_par::stats_width};
+    const double right{params.width};
+
+    // two boids on either side of the left and right edges, flying away from each other, and a predator at the
+    // bottom edge
+    std::vector<std::shared_ptr<bird::Boid>> edge_boids{
+        std::make_shared<bird::Boid>(point::Point(left + 1., 300.), point::Point(-10., 0.)),
+        std::make_shared<bird::Boid>(point::Point(right - 1., 300.), point::Point(10., 0.)),
+        std::make_shared<bird::Boid>(point::Point(left + 400., 300.), point::Point(0., 10.))};
+    std::vector<std::shared_ptr<bird::Predator>> edge_predators{
+        std::make_shared<bird::Predator>(point::Point(left + 400., params.height - 2.), point::Point(0., 8.))};
+    flock::Flock torus(edge_boids, edge_predators, 12., 8., 7., 5.);
+
+    std::vector<size_t> near;
+    torus.findNearBoids(1, true, near);
+    CHECK(near.empty());
+    torus.setParameters(params);
+    CHECK(torus.getParameters().boundary == flock::Boundary::Torus);
+    torus.findNearBoids(1, true, near);
+    CHECK(near == std::vector<size_t>{0});
+    torus.findNearBoids(0, true, near);
+    CHECK(near == std::vector<size_t>{1});
+
+    // the birds leave through one edge and come back through the opposite one, without the border rule
+    torus.evolve();
+    const storage::BirdArrays& b_arrays = torus.getBoidArrays();
+    CHECK(b_arrays.x[0] > right - 10.);
+    CHECK(b_arrays.x[1] < left + 10.);
+    CHECK(b_arrays.vx[1] > 0.);
+    CHECK(torus.getPredatorArrays().y[0] < 10.);
+
+    flock::Parameters small{params};
+    small.margin = 50.;
+    small.width = left + 120.;
+    CHECK_THROWS_AS(torus.setParameters(small), std::domain_error);
+    small.boundary = flock::Boundary::Walls;
+    CHECK_NOTHROW(torus.setParameters(small));
+
+    // the two kernels agree through the edges, and the candidate lists find the same neighbours as the grid
+    flock::Flock fused(600, 6);
+    fused.generateBirds(13);
+    fused.setParameters(params);
+    flock::Flock composed{fused};
+    composed.setKernel(flock::Kernel::Composed);
+    flock::Flock listed{composed};
+    listed.setSkin(20.);
+
+    size_t across{0};
+    for (size_t i = 0; i < fused.getBoidsNum(); ++i) {
+      fused.findNearBoids(i, true, near);
+      for (const size_t j : near) {
+        if (std::abs(fused.getBoidArrays().x[j] - fused.getBoidArrays().x[i]) > d ||
+            std::abs(fused.getBoidArrays().y[j] - fused.getBoidArrays().y[i]) > d) {
+          ++across;
+        }
+      }
+    }
+    CHECK(across > 0);
+
+    sf::VertexArray triangles0(sf::Triangles, 3 * fused.getFlockSize());
+    flock::Neighbours scratch;
+    bool agree{true};
+    for (size_t i = 0; i < fused.getBoidsNum(); ++i) {
+      const std::array<point::Point, 2> a = fused.updateBird(triangles0, i, true);
+      const std::array<point::Point, 2> b = composed.updateBird(triangles0, i, true, scratch);
+      agree = agree && a[1].getX() == doctest::Approx(b[1].getX()) && a[1].getY() == doctest::Approx(b[1].getY());
+    }
+    for (size_t i = 0; i < fused.getPredatorsNum(); ++i) {
+      const std::array<point::Point, 2> a = fused.updateBird(triangles0, i, false);
+      const std::array<point::Point, 2> b = composed.updateBird(triangles0, i, false, scratch);
+      agree = agree && a[1].getX() == doctest::Approx(b[1].getX()) && a[1].getY() == doctest::Approx(b[1].getY());
+    }
+    CHECK(agree);
+
+    std::vector<size_t> expected;
+    bool same{true};
+    for (int step = 0; step < 20; ++step) {
+      for (size_t i = 0; i < listed.getBoidsNum(); i += 5) {
+        composed.findNearBoids(i, true, expected);
+        listed.findNearBoids(i, true, near);
+        same = same && near == expected;
+        composed.findNearPredators(i, true, expected);
+        listed.findNearPredators(i, true, near);
+        same = same && near == expected;
+      }
+      composed.evolve();
+      listed.evolve();
+    }
+    CHECK(same);
+    CHECK(listed.getBoidArrays().x == composed.getBoidArrays().x);
+    CHECK(listed.getListBuilds() < 20);
+
+    bool inside{true};
+    for (size_t i = 0; i < composed.getBoidsNum(); ++i) {
+      inside = inside && composed.getBoidArrays().x[i] >= left && composed.getBoidArrays().x[i] <= right &&
+               composed.getBoidArrays().y[i] >= 0. && composed.getBoidArrays().y[i] <= params.height;
+    }
+    CHECK(inside);
+
+    // the distances between the closest images are shorter
+    CHECK(composed.getPeriods() == std::array<double, 2>{right - left, params.height});
+    CHECK(flock1.getPeriods() == std::array<double, 2>{0., 0.});
+    statistics::Options options;
+    options.period_x = composed.getPeriods()[0];
+    options.period_y = composed.getPeriods()[1];
+    const statistics::Statistics stats = composed.statistics();
+    CHECK(stats.mean_dist == statistics::evaluate(composed.getBoidArrays(), options, nullptr).mean_dist);
+    CHECK(stats.mean_dist < statistics::evaluate(composed.getBoidArrays(), statistics::Options(), nullptr).mean_dist);
   }
 
   SUBCASE("Testing evolve method") {
@@ -782,6 +1919,262 @@ TEST_CASE("Testing Flock class") {
     CHECK(triangles[8].color == sf::Color::Red);
   }
 
+  SUBCASE("Testing evolve method in parallel") {
+    std::vector<std::shared_ptr<bird::Boid>> boids0;
+    std::vector<std::shared_ptr<bird::Predator>> predators0;
+
+    flock::Flock flock0(200, 5);
+    flock0.generateBirds();
+    for (const std::shared_ptr<bird::Boid>& boid : flock0.getBoidFlock()) {
+      boids0.emplace_back(std::make_shared<bird::Boid>(*boid));
+    }
+    for (const std::shared_ptr<bird::Predator>& predator : flock0.getPredatorFlock()) {
+      predators0.emplace_back(std::make_shared<bird::Predator>(*predator));
+    }
+
+    flock::Flock serial(boids0, predators0, bMaxSpeed, pMaxSpeed, bMinSpeed, pMinSpeed);
+    flock::Flock parallel(boids0, predators0, bMaxSpeed, pMaxSpeed, bMinSpeed, pMinSpeed);
+    parallel.setThreads(4);
+
+    CHECK(serial.getThreads() == 1);
+    CHECK(parallel.getThreads() == 4);
+
+    sf::VertexArray serial_triangles(sf::Triangles, 3 * serial.getFlockSize());
+    sf::VertexArray parallel_triangles(sf::Triangles, 3 * parallel.getFlockSize());
+
+    for (int step = 0; step < 10; ++step) {
+      serial.evolve(serial_triangles);
+      parallel.evolve(parallel_triangles);
+    }
+
+    CHECK(serial.getBoidArrays().x == parallel.getBoidArrays().x);
+    CHECK(serial.getBoidArrays().vy == parallel.getBoidArrays().vy);
+    CHECK(serial.getPredatorArrays().y == parallel.getPredatorArrays().y);
+    CHECK(serial.getPredatorArrays().vx == parallel.getPredatorArrays().vx);
+    for (size_t k = 0; k < serial_triangles.getVertexCount(); ++k) {
+      CHECK(serial_triangles[k].position == parallel_triangles[k].position);
+    }
+
+    sf::VertexArray updated(sf::Triangles, 3 * serial.getFlockSize());
+    triangles::updateTriangles(serial, updated);
+    for (size_t k = 0; k < updated.getVertexCount(); ++k) {
+      CHECK(updated[k].position == serial_triangles[k].position);
+    }
+  }
+
+  SUBCASE("Testing evolve method without triangles") {
+    flock::Flock flock0(100, 3);
+    flock0.generateBirds();
+    std::vector<std::shared_ptr<bird::Boid>> boids0;
+    std::vector<std::shared_ptr<bird::Predator>> predators0;
+    for (const std::shared_ptr<bird::Boid>& boid : flock0.getBoidFlock()) {
+      boids0.emplace_back(std::make_shared<bird::Boid>(*boid));
+    }
+    for (const std::shared_ptr<bird::Predator>& predator : flock0.getPredatorFlock()) {
+      predators0.emplace_back(std::make_shared<bird::Predator>(*predator));
+    }
+    flock::Flock graphic(boids0, predators0, bMaxSpeed, pMaxSpeed, bMinSpeed, pMinSpeed);
+    flock::Flock headless(boids0, predators0, bMaxSpeed, pMaxSpeed, bMinSpeed, pMinSpeed);
+    sf::VertexArray triangles0(sf::Triangles, 3 * graphic.getFlockSize());
+
+    for (int step = 0; step < 5; ++step) {
+      graphic.evolve(triangles0);
+      headless.evolve();
+    }
+    CHECK(graphic.getBoidArrays().x == headless.getBoidArrays().x);
+    CHECK(graphic.getPredatorArrays().vy == headless.getPredatorArrays().vy);
+  }
+
+  SUBCASE("Testing setFlightParams method without streams") {
+    flock::Flock flock0(2, 0);
+    flock0.setFlightParams(0.2, 0.3, 0.01);
+    const std::array<double, 5> params = flock0.getFlightParams();
+
+    CHECK(params[0] == 0.2);
+    CHECK(params[1] == 0.3);
+    CHECK(params[2] == 0.01);
+    CHECK(params[3] == doctest::Approx(1.2));
+    CHECK(params[4] == doctest::Approx(0.02));
+    CHECK_THROWS_AS(flock0.setFlightParams(1.5, 0.3, 0.01), std::domain_error);
+  }
+
+  SUBCASE("Testing save and load methods") {
+    const std::string path{(std::filesystem::temp_directory_path() / "boids_snapshot_test.bin").string()};
+
+    flock::Flock flock0(300, 4);
+    flock0.generateBirds();
+    std::vector<std::shared_ptr<bird::Boid>> boids0;
+    std::vector<std::shared_ptr<bird::Predator>> predators0;
+    for (const std::shared_ptr<bird::Boid>& boid : flock0.getBoidFlock()) {
+      boids0.emplace_back(std::make_shared<bird::Boid>(*boid));
+    }
+    for (const std::shared_ptr<bird::Predator>& predator : flock0.getPredatorFlock()) {
+      predators0.emplace_back(std::make_shared<bird::Predator>(*predator));
+    }
+    flock::Flock saved(boids0, predators0, 10., 6., 5., 3.);
+    saved.setFlightParams(0.3, 0.2, 0.01);
+    saved.setFieldOfView(flock::FieldOfView::Angle);
+    saved.save(path);
+
+    flock::Flock loaded(1, 0);
+    loaded.load(path);
+
+    CHECK(loaded.getBoidsNum() == 300);
+    CHECK(loaded.getPredatorsNum() == 4);
+    CHECK(loaded.getFlightParams() == saved.getFlightParams());
+    CHECK(loaded.getFieldOfView() == flock::FieldOfView::Angle);
+    CHECK(loaded.getBoidArrays().x == saved.getBoidArrays().x);
+    CHECK(loaded.getBoidArrays().vy == saved.getBoidArrays().vy);
+    CHECK(loaded.getPredatorArrays().y == saved.getPredatorArrays().y);
+    CHECK(loaded.getPredatorArrays().vx == saved.getPredatorArrays().vx);
+    CHECK(loaded.getBoidFlock()[7]->getPosition() == saved.getBoidFlock()[7]->getPosition());
+
+    // the speed limits are restored as well: the two flocks keep evolving identically
+    for (int step = 0; step < 5; ++step) {
+      saved.evolve();
+      loaded.evolve();
+    }
+    CHECK(loaded.getBoidArrays().x == saved.getBoidArrays().x);
+    CHECK(loaded.getPredatorArrays().vy == saved.getPredatorArrays().vy);
+
+    {
+      snapshot::MappedSnapshot file(path);
+      CHECK(file.header().version == snapshot::version);
+      CHECK(file.header().n_boids == 300);
+      CHECK(file.boids()[0][0] == boids0[0]->getPosition().getX());
+      CHECK(file.predators()[3][3] == predators0[3]->getVelocity().getY());
+    }
+
+    // a truncated file, and a file of another version, are rejected and leave the flock unchanged
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    CHECK_THROWS_AS(loaded.load(path), std::runtime_error);
+    CHECK(loaded.getBoidsNum() == 300);
+
+    saved.save(path);
+    {
+      std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+      const std::uint32_t other{snapshot::version + 1};
+      file.seekp(8);
+      file.write(reinterpret_cast<const char*>(&other), sizeof(other));
+    }
+    CHECK_THROWS_AS(loaded.load(path), std::runtime_error);
+    CHECK_THROWS_AS(loaded.load(path + ".missing"), std::runtime_error);
+
+    // corrupted speed limits and flight parameters are rejected as well, NaN included
+    const auto corrupt = [&path, &saved](const std::size_t offset, const double value) {
+      saved.save(path);
+      std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+      file.seekp(static_cast<std::streamoff>(offset));
+      file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    const flock::Parameters before{loaded.getParameters()};
+    for (const std::size_t offset :
+         {offsetof(snapshot::Header, b_max_speed), offsetof(snapshot::Header, p_min_speed)}) {
+      for (const double value : {-5., 0., std::nan(""), HUGE_VAL}) {
+        corrupt(offset, value);
+        CHECK_THROWS_AS(loaded.load(path), std::runtime_error);
+      }
+    }
+    corrupt(offsetof(snapshot::Header, b_min_speed), 20.);
+    CHECK_THROWS_AS(loaded.load(path), std::runtime_error);
+    for (const std::size_t offset :
+         {offsetof(snapshot::Header, s), offsetof(snapshot::Header, a), offsetof(snapshot::Header, c)}) {
+      corrupt(offset, std::nan(""));
+      CHECK_THROWS_AS(loaded.load(path), std::runtime_error);
+    }
+    CHECK(loaded.getBoidsNum() == 300);
+    CHECK(loaded.getFlightParams() == saved.getFlightParams());
+    CHECK(loaded.getParameters().b_max_speed == before.b_max_speed);
+    CHECK(loaded.getParameters().b_min_speed == before.b_min_speed);
+    CHECK(loaded.getParameters().p_min_speed == before.p_min_speed);
+    CHECK(loaded.getBoidArrays().x == saved.getBoidArrays().x);
+
+    // so are positions and velocities that are not finite, and birds at rest
+    const std::size_t arrays{sizeof(snapshot::Header)};
+    const std::size_t predator_vy{arrays + (4 * 300 + 3 * 4 + 2) * sizeof(double)};
+    for (const std::size_t offset : {arrays, arrays + (300 + 7) * sizeof(double), predator_vy}) {
+      for (const double value : {std::nan(""), HUGE_VAL, -HUGE_VAL}) {
+        corrupt(offset, value);
+        CHECK_THROWS_AS(loaded.load(path), std::runtime_error);
+      }
+    }
+    corrupt(arrays + 2 * 300 * sizeof(double), 0.);
+    {
+      std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+      const double zero{0.};
+      file.seekp(static_cast<std::streamoff>(arrays + 3 * 300 * sizeof(double)));
+      file.write(reinterpret_cast<const char*>(&zero), sizeof(zero));
+    }
+    CHECK_THROWS_AS(loaded.load(path), std::runtime_error);
+    // a value that is finite in double precision but not in single precision is rejected by a single precision flock
+    corrupt(arrays, 1e300);
+    flock::BasicFlock<float> single(1, 0);
+    CHECK_THROWS_AS(single.load(path), std::runtime_error);
+    CHECK(single.getBoidsNum() == 1);
+    CHECK(loaded.getBoidsNum() == 300);
+    CHECK(loaded.getBoidArrays().x == saved.getBoidArrays().x);
+    CHECK(loaded.getPredatorArrays().vy == saved.getPredatorArrays().vy);
+
+    // so is a world that is not valid with the other parameters of the flock
+    corrupt(offsetof(snapshot::Header, height), 100.);
+    CHECK_THROWS_AS(loaded.load(path), std::runtime_error);
+    corrupt(offsetof(snapshot::Header, width), std::nan(""));
+    CHECK_THROWS_AS(loaded.load(path), std::runtime_error);
+    CHECK(loaded.getParameters().height == before.height);
+    CHECK(loaded.getParameters().width == before.width);
+
+    // a version 1 file records neither the boundary nor the size of the world, and is rejected
+    saved.save(path);
+    {
+      std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+      const std::uint32_t first{1};
+      file.seekp(offsetof(snapshot::Header, version));
+      file.write(reinterpret_cast<const char*>(&first), sizeof(first));
+    }
+    CHECK_THROWS_AS(loaded.load(path), std::runtime_error);
+
+    // the boundary and the size of a toroidal world are restored, the birds staying where they were saved
+    flock::Parameters params;
+    params.boundary = flock::Boundary::Torus;
+    params.width = 0.8 * params.width;
+    params.height = 0.8 * params.height;
+    flock::Flock torus(200, 3);
+    torus.setParameters(params);
+    torus.generateBirds(5);
+    for (int step = 0; step < 20; ++step) {
+      torus.evolve();
+    }
+    torus.save(path);
+
+    flock::Flock walls(1, 0);
+    walls.load(path);
+    CHECK(walls.getParameters().boundary == flock::Boundary::Torus);
+    CHECK(walls.getParameters().width == params.width);
+    CHECK(walls.getParameters().height == params.height);
+    CHECK(walls.getPeriods() == torus.getPeriods());
+    CHECK(walls.getBoidArrays().x == torus.getBoidArrays().x);
+    CHECK(walls.getBoidArrays().y == torus.getBoidArrays().y);
+    CHECK(walls.getPredatorArrays().vx == torus.getPredatorArrays().vx);
+    for (int step = 0; step < 5; ++step) {
+      torus.evolve();
+      walls.evolve();
+    }
+    CHECK(walls.getBoidArrays().x == torus.getBoidArrays().x);
+    CHECK(walls.getPredatorArrays().y == torus.getPredatorArrays().y);
+
+    // a bird outside of its toroidal world is rejected instead of being wrapped into it
+    {
+      std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+      const double outside{params.width + 10.};
+      file.seekp(sizeof(snapshot::Header));
+      file.write(reinterpret_cast<const char*>(&outside), sizeof(outside));
+    }
+    CHECK_THROWS_AS(loaded.load(path), std::runtime_error);
+    CHECK(loaded.getParameters().boundary == flock::Boundary::Walls);
+
+    std::filesystem::remove(path);
+  }
+
   SUBCASE("Testing statistics method") {
     statistics::Statistics stats = flock1.statistics();
 
@@ -819,5 +2212,473 @@ TEST_CASE("Testing Statistics struct") {
     CHECK(stats1.dev_dist == 3.);
     CHECK(stats1.mean_speed == 2.);
     CHECK(stats1.dev_speed == 0.5);
+    CHECK(stats0.mean_dist_error == 0.);
+    CHECK(stats1.mean_dist_error == 0.);
+  }
+
+  SUBCASE("Testing statistics::evaluate()") {
+    storage::BirdArrays birds;
+    unsigned int seed{12345};
+    const auto next = [&seed] {
+      seed = seed * 1103515245u + 12345u;
+      return static_cast<double>(seed >> 8 & 0xffff) / 65536.;
+    };
+    for (size_t i = 0; i < 1500; ++i) {
+      birds.push_back(point::Point(next() * 1000., next() * 600.), point::Point(next() * 4. - 2., next() * 4. - 2.));
+    }
+
+    double mean_dist{0.};
+    double mean_dist2{0.};
+    for (size_t i = 0; i < birds.size(); ++i) {
+      for (size_t j = i + 1; j < birds.size(); ++j) {
+        const double distance{birds.position(i).distance(birds.position(j))};
+        mean_dist += distance;
+        mean_dist2 += distance * distance;
+      }
+    }
+    const double pairs{1500. * 1499. / 2.};
+    mean_dist /= pairs;
+    mean_dist2 /= pairs;
+
+    const statistics::Statistics exact = statistics::evaluate(birds, statistics::Options(), nullptr);
+    CHECK(exact.mean_dist == doctest::Approx(mean_dist));
+    CHECK(exact.dev_dist == doctest::Approx(std::sqrt(mean_dist2 - mean_dist * mean_dist)));
+    CHECK(exact.mean_dist_error == 0.);
+
+    pool::ThreadPool pool(4);
+    const statistics::Statistics parallel = statistics::evaluate(birds, statistics::Options(), &pool);
+    CHECK(parallel.mean_dist == exact.mean_dist);
+    CHECK(parallel.dev_dist == exact.dev_dist);
+    CHECK(parallel.mean_speed == exact.mean_speed);
+    CHECK(parallel.dev_speed == exact.dev_speed);
+
+    const statistics::Options options(statistics::Mode::Sampled, 2., 1'000'000, 7);
+    const statistics::Statistics sampled = statistics::evaluate(birds, options, &pool);
+    CHECK(sampled.mean_dist_error > 0.);
+    CHECK(sampled.mean_dist_error <= 2.);
+    CHECK(std::abs(sampled.mean_dist - exact.mean_dist) < 5. * sampled.mean_dist_error);
+    CHECK(sampled.dev_dist == doctest::Approx(exact.dev_dist).epsilon(0.05));
+    CHECK(sampled.mean_speed == exact.mean_speed);
+    CHECK(statistics::evaluate(birds, options, nullptr).mean_dist == sampled.mean_dist);
+
+    // the budget of couples stops the sampling before the bound is reached
+    const statistics::Statistics capped =
+        statistics::evaluate(birds, statistics::Options(statistics::Mode::Sampled, 1e-3, 100, 7), nullptr);
+    CHECK(capped.mean_dist_error > 1e-3);
+
+    // in a toroidal world the distances are those between the closest images
+    storage::BirdArrays couple;
+    couple.push_back(point::Point(1., 10.), point::Point(3., 4.));
+    couple.push_back(point::Point(99., 40.), point::Point(3., 4.));
+    statistics::Options wrapped;
+    wrapped.period_x = 100.;
+    wrapped.period_y = 50.;
+    const double plain{statistics::evaluate(couple, statistics::Options(), nullptr).mean_dist};
+    CHECK(plain == doctest::Approx(std::hypot(98., 30.)));
+    CHECK(statistics::evaluate(couple, wrapped, nullptr).mean_dist == doctest::Approx(std::hypot(2., 20.)));
+    wrapped.mode = statistics::Mode::Sampled;
+    CHECK(statistics::evaluate(couple, wrapped, nullptr).mean_dist == doctest::Approx(std::hypot(2., 20.)));
+
+    // the differences within one period are reduced to half a period at most, and left alone without wrap-around
+    CHECK(torus::image(98., 100.) == -2.);
+    CHECK(torus::image(-98., 100.) == 2.);
+    CHECK(torus::image(50., 100.) == 50.);
+    CHECK(torus::image(-30., 100.) == -30.);
+    CHECK(torus::image(98., 0.) == 98.);
+    CHECK(torus::image(49.5f, 50.f) == -0.5f);
+
+    storage::BirdArrays single;
+    single.push_back(point::Point(1., 2.), point::Point(3., 4.));
+    const statistics::Statistics one = statistics::evaluate(single, options, nullptr);
+    CHECK(one.mean_dist == 0.);
+    CHECK(one.mean_speed == 5.);
+  }
+}
+
+//======================================================================================================================
+//===TESTING SINGLE AND DOUBLE PRECISION================================================================================
+//======================================================================================================================
+
+TEST_CASE("Testing single and double precision") {
+  CHECK(sizeof(point::BasicPoint<float>) == 2 * sizeof(float));
+  CHECK(sizeof(point::BasicPoint<double>) == 2 * sizeof(double));
+
+  flock::BasicFlock<double> reference(300, 3);
+  flock::BasicFlock<float> single(300, 3);
+  reference.generateBirds(7);
+  single.generateBirds(7);
+  // the angular field of view jumps at the branch cut of atan2, where a rounding difference changes the neighbours;
+  // the cone makes the two precisions comparable over more steps
+  reference.setFieldOfView(flock::FieldOfView::Cone);
+  single.setFieldOfView(flock::FieldOfView::Cone);
+
+  SUBCASE("Testing the generated birds") {
+    // the same draws, rounded to float
+    const storage::BirdArrays& b_double = reference.getBoidArrays();
+    const storage::BasicBirdArrays<float>& b_float = single.getBoidArrays();
+    REQUIRE(b_float.size() == b_double.size());
+    for (size_t i = 0; i < b_double.size(); ++i) {
+      CHECK(b_float.x[i] == static_cast<float>(b_double.x[i]));
+      CHECK(b_float.vy[i] == static_cast<float>(b_double.vy[i]));
+    }
+
+    const statistics::Statistics stats_double{reference.statistics()};
+    const statistics::Statistics stats_float{single.statistics()};
+    CHECK(stats_float.mean_dist == doctest::Approx(stats_double.mean_dist).epsilon(1e-6));
+    CHECK(stats_float.dev_dist == doctest::Approx(stats_double.dev_dist).epsilon(1e-6));
+    CHECK(stats_float.mean_speed == doctest::Approx(stats_double.mean_speed).epsilon(1e-6));
+    CHECK(stats_float.dev_speed == doctest::Approx(stats_double.dev_speed).epsilon(1e-6));
+  }
+
+  SUBCASE("Testing the statistics after evolve()") {
+    // the trajectories part ways with time, as any rounding difference does in a flock, but the statistics stay close
+    for (size_t step = 0; step < 100; ++step) {
+      reference.evolve();
+      single.evolve();
+    }
+
+    const statistics::Statistics stats_double{reference.statistics()};
+    const statistics::Statistics stats_float{single.statistics()};
+    CHECK(stats_float.mean_dist == doctest::Approx(stats_double.mean_dist).epsilon(0.02));
+    CHECK(stats_float.dev_dist == doctest::Approx(stats_double.dev_dist).epsilon(0.02));
+    CHECK(stats_float.mean_speed == doctest::Approx(stats_double.mean_speed).epsilon(0.02));
+  }
+
+  SUBCASE("Testing save() and load()") {
+    // snapshots hold doubles whatever the precision of the flock
+    const std::string path{(std::filesystem::temp_directory_path() / "boids_precision.snap").string()};
+    single.save(path);
+    flock::Flock loaded(1, 0);
+    loaded.load(path);
+    std::filesystem::remove(path);
+
+    REQUIRE(loaded.getBoidsNum() == 300);
+    for (size_t i = 0; i < 300; ++i) {
+      CHECK(loaded.getBoidArrays().x[i] == static_cast<double>(single.getBoidArrays().x[i]));
+      CHECK(loaded.getBoidArrays().vx[i] == static_cast<double>(single.getBoidArrays().vx[i]));
+    }
+  }
+}
+
+//======================================================================================================================
+//===TESTING PROFILER CLASS=============================================================================================
+//======================================================================================================================
+
+TEST_CASE("Testing Profiler class") {
+  profiler::Profiler profiler(100);
+
+  SUBCASE("Testing record() and summary()") {
+    const profiler::Summary empty = profiler.summary(profiler::Phase::Draw);
+    CHECK(empty.count == 0);
+    CHECK(empty.p99 == 0.);
+
+    for (int k = 1; k <= 100; ++k) {
+      profiler.record(profiler::Phase::Draw, k);
+    }
+    const profiler::Summary draw = profiler.summary(profiler::Phase::Draw);
+    CHECK(draw.count == 100);
+    CHECK(draw.mean == doctest::Approx(50.5));
+    CHECK(draw.max == 100.);
+    CHECK(draw.p50 == 50.);
+    CHECK(draw.p95 == 95.);
+    CHECK(draw.p99 == 99.);
+
+    // the percentiles refer to the last 100 samples only, count, mean and max to all of them
+    for (int k = 1; k <= 100; ++k) {
+      profiler.record(profiler::Phase::Draw, 1.);
+    }
+    const profiler::Summary rolled = profiler.summary(profiler::Phase::Draw);
+    CHECK(rolled.count == 200);
+    CHECK(rolled.mean == doctest::Approx(25.75));
+    CHECK(rolled.max == 100.);
+    CHECK(rolled.p99 == 1.);
+  }
+
+  SUBCASE("Testing report() and dump()") {
+    profiler.record(profiler::Phase::Events, 0.5);
+
+    CHECK(profiler.report() == "Frame phases (ms)   p50 / p95 / p99\nevents: 0.50 / 0.50 / 0.50");
+
+    std::ostringstream out;
+    profiler.dump(out);
+    CHECK(out.str().rfind("phase,count,mean_ms,max_ms,p50_ms,p95_ms,p99_ms\nevents,1,0.5,0.5,0.5,0.5,0.5\n", 0) == 0);
+  }
+
+  SUBCASE("Testing ScopedTimer class") {
+    { const profiler::ScopedTimer timer(nullptr, profiler::Phase::Overlay); }
+    { const profiler::ScopedTimer timer(&profiler, profiler::Phase::Overlay); }
+
+    CHECK(profiler.summary(profiler::Phase::Overlay).count == 1);
+    CHECK(profiler.summary(profiler::Phase::Overlay).max >= 0.);
+  }
+
+  SUBCASE("Testing Flock::setProfiler()") {
+    flock::Flock flock(50, 2);
+    flock.generateBirds();
+    flock.setProfiler(&profiler);
+
+    flock.evolve();
+    flock.evolve();
+    static_cast<void>(flock.statistics());
+
+    CHECK(profiler.summary(profiler::Phase::Evolve).count == 2);
+    CHECK(profiler.summary(profiler::Phase::Rules).count == 2);
+    CHECK(profiler.summary(profiler::Phase::Index).count == 2);
+    CHECK(profiler.summary(profiler::Phase::Statistics).count == 1);
+
+    flock.setProfiler(nullptr);
+    flock.evolve();
+    CHECK(profiler.summary(profiler::Phase::Evolve).count == 2);
+  }
+}
+
+//======================================================================================================================
+//===TESTING TRIPLEBUFFER AND SIMULATION CLASSES========================================================================
+//======================================================================================================================
+
+TEST_CASE("Testing TripleBuffer class") {
+  SUBCASE("Testing publish() and update()") {
+    buffer::TripleBuffer<int> frames;
+    CHECK_FALSE(frames.update());
+
+    frames.back() = 1;
+    frames.publish();
+    frames.back() = 2;
+    frames.publish();
+    CHECK(frames.update());
+    CHECK(frames.front() == 2);
+    CHECK_FALSE(frames.update());
+    CHECK(frames.front() == 2);
+
+    frames.back() = 3;
+    frames.publish();
+    CHECK(frames.update());
+    CHECK(frames.front() == 3);
+  }
+
+  SUBCASE("Testing a producer and a consumer on different threads") {
+    // each frame holds the same value twice: a torn frame would hold two different values
+    buffer::TripleBuffer<std::array<int, 2>> frames;
+    constexpr int last{100000};
+
+    std::thread producer([&frames] {
+      for (int k = 1; k <= last; ++k) {
+        frames.back() = {k, k};
+        frames.publish();
+      }
+    });
+
+    int previous{0};
+    bool consistent{true};
+    while (previous < last) {
+      if (frames.update()) {
+        consistent = consistent && frames.front()[0] == frames.front()[1] && frames.front()[0] > previous;
+        previous = frames.front()[0];
+      }
+    }
+    producer.join();
+
+    CHECK(consistent);
+    CHECK(previous == last);
+  }
+}
+
+TEST_CASE("Testing Simulation class") {
+  std::vector<std::shared_ptr<bird::Boid>> boids0;
+  std::vector<std::shared_ptr<bird::Predator>> predators0;
+  flock::Flock flock0(60, 2);
+  flock0.generateBirds();
+  for (const std::shared_ptr<bird::Boid>& boid : flock0.getBoidFlock()) {
+    boids0.emplace_back(std::make_shared<bird::Boid>(*boid));
+  }
+  for (const std::shared_ptr<bird::Predator>& predator : flock0.getPredatorFlock()) {
+    predators0.emplace_back(std::make_shared<bird::Predator>(*predator));
+  }
+
+  flock::Flock simulated(boids0, predators0, bMaxSpeed, pMaxSpeed, bMinSpeed, pMinSpeed);
+  flock::Flock reference(boids0, predators0, bMaxSpeed, pMaxSpeed, bMinSpeed, pMinSpeed);
+
+  simulation::Frame frame;
+  {
+    // with no rate limit, a few steps may already have been published: the latest one is taken
+    simulation::Simulation simulation(simulated, 0.);
+    REQUIRE(simulation.update());
+    CHECK(simulation.frame().boids.size() == 60);
+    CHECK(simulation.frame().predators.size() == 2);
+
+    while (simulation.frame().step < 5) {
+      simulation.update();
+    }
+    frame = simulation.frame();
+  }
+
+  // every published frame is a complete state of the flock
+  for (size_t step = 0; step < frame.step; ++step) {
+    reference.evolve();
+  }
+  CHECK(frame.boids.x == reference.getBoidArrays().x);
+  CHECK(frame.boids.vy == reference.getBoidArrays().vy);
+  CHECK(frame.predators.y == reference.getPredatorArrays().y);
+  CHECK(frame.predators.vx == reference.getPredatorArrays().vx);
+}
+
+//======================================================================================================================
+//===TESTING RECORDER AND READER CLASSES================================================================================
+//======================================================================================================================
+
+TEST_CASE("Testing Recorder and Reader classes") {
+  SUBCASE("Testing toHalf() and fromHalf()") {
+    CHECK(recorder::toHalf(0.f) == 0x0000);
+    CHECK(recorder::toHalf(1.f) == 0x3c00);
+    CHECK(recorder::toHalf(-2.f) == 0xc000);
+    CHECK(recorder::toHalf(65504.f) == 0x7bff);
+    CHECK(recorder::toHalf(1e6f) == 0x7c00);
+    CHECK(recorder::toHalf(std::ldexp(1.f, -24)) == 0x0001);
+    // halfway between 2048 and 2050: rounded to the even mantissa
+    CHECK(recorder::toHalf(2049.f) == recorder::toHalf(2048.f));
+    CHECK(recorder::toHalf(2051.f) == recorder::toHalf(2052.f));
+
+    // every finite half precision value survives the round trip
+    bool exact{true};
+    for (std::uint32_t bits = 0; bits < 0x10000u; ++bits) {
+      const auto half = static_cast<std::uint16_t>(bits);
+      if ((half & 0x7c00u) != 0x7c00u) {
+        exact = exact && recorder::toHalf(recorder::fromHalf(half)) == half;
+      }
+    }
+    CHECK(exact);
+    CHECK(recorder::fromHalf(0x3555) == doctest::Approx(1. / 3.).epsilon(1e-3));
+  }
+
+  const std::string path{(std::filesystem::temp_directory_path() / "boids_trajectory_test.bin").string()};
+  flock::Flock reference(50, 3);
+  reference.generateBirds();
+  flock::Flock recorded{reference};
+
+  SUBCASE("Testing a recording in single precision") {
+    recorder::Options options;
+    options.every = 2;
+    // several chunks, the last one partly used
+    options.chunk_frames = 2;
+    const storage::BirdArrays initial{recorded.getBoidArrays()};
+    {
+      recorder::Recorder recording(path, 50, 3, options);
+      recording.record(0, recorded.getBoidArrays(), recorded.getPredatorArrays());
+      for (size_t step = 1; step <= 9; ++step) {
+        recorded.evolve();
+        recording.record(step, recorded.getBoidArrays(), recorded.getPredatorArrays());
+      }
+    }
+
+    recorder::Reader trajectory(path);
+    REQUIRE(trajectory.frames() == 5);
+    CHECK(trajectory.header().every == 2);
+    CHECK(std::filesystem::file_size(path) == sizeof(recorder::Header) + 5 * trajectory.header().frame_bytes);
+
+    // frames are read in any order
+    storage::BirdArrays read_boids;
+    storage::BirdArrays read_predators;
+    for (size_t step = 1; step <= 6; ++step) {
+      reference.evolve();
+    }
+    CHECK(trajectory.step(3) == 6);
+    trajectory.frame(3, read_boids, read_predators);
+    REQUIRE(read_boids.size() == 50);
+    REQUIRE(read_predators.size() == 3);
+    CHECK(read_boids.x[7] == doctest::Approx(reference.getBoidArrays().x[7]).epsilon(1e-6));
+    CHECK(read_boids.vy[49] == doctest::Approx(reference.getBoidArrays().vy[49]).epsilon(1e-6));
+    CHECK(read_predators.y[2] == doctest::Approx(reference.getPredatorArrays().y[2]).epsilon(1e-6));
+
+    trajectory.frame(0, read_boids, read_predators);
+    CHECK(trajectory.step(0) == 0);
+    CHECK(read_boids.vx[0] == doctest::Approx(initial.vx[0]).epsilon(1e-6));
+    CHECK_THROWS_AS(trajectory.frame(5, read_boids, read_predators), std::out_of_range);
+  }
+
+  SUBCASE("Testing a recording in 16 bit integers") {
+    recorder::Options options;
+    options.encoding = recorder::Encoding::Int16;
+    {
+      recorder::Recorder recording(path, 50, 3, options);
+      recording.record(0, recorded.getBoidArrays(), recorded.getPredatorArrays());
+      CHECK_THROWS_AS(recording.record(1, recorded.getBoidArrays(), storage::BirdArrays{}), std::domain_error);
+    }
+
+    recorder::Reader trajectory(path);
+    REQUIRE(trajectory.frames() == 1);
+    CHECK(trajectory.header().frame_bytes == 8 + 4 * 53 * 2);
+
+    storage::BirdArrays read_boids;
+    storage::BirdArrays read_predators;
+    trajectory.frame(0, read_boids, read_predators);
+    // half a level of quantisation
+    const double position_step{(options.max_position - options.min_position) / 65535. / 2.};
+    const double speed_step{options.max_speed / 32767. / 2.};
+    bool within{true};
+    for (size_t i = 0; i < 50; ++i) {
+      within = within && std::abs(read_boids.x[i] - recorded.getBoidArrays().x[i]) <= position_step + 1e-9 &&
+               std::abs(read_boids.vy[i] - recorded.getBoidArrays().vy[i]) <= speed_step + 1e-9;
+    }
+    CHECK(within);
+  }
+
+  SUBCASE("Testing a recording of reordered birds") {
+    recorded.setReorder(1);
+    recorded.evolve();
+    reference.evolve();
+    {
+      recorder::Recorder recording(path, 50, 3, recorder::Options{});
+      recording.record(1, recorded.getBoidArrays(), recorded.getPredatorArrays(), recorded.getBoidIds(),
+                       recorded.getPredatorIds());
+      CHECK_THROWS_AS(recording.record(2, recorded.getBoidArrays(), recorded.getPredatorArrays(),
+                                       std::vector<size_t>{}, recorded.getPredatorIds()),
+                      std::domain_error);
+    }
+
+    recorder::Reader trajectory(path);
+    REQUIRE(trajectory.frames() == 1);
+    storage::BirdArrays read_boids;
+    storage::BirdArrays read_predators;
+    trajectory.frame(0, read_boids, read_predators);
+    bool in_order{true};
+    for (size_t i = 0; i < 50; ++i) {
+      in_order = in_order && read_boids.x[i] == doctest::Approx(reference.getBoidArrays().x[i]).epsilon(1e-6);
+    }
+    CHECK(in_order);
+    CHECK(read_predators.vy[1] == doctest::Approx(reference.getPredatorArrays().vy[1]).epsilon(1e-6));
+  }
+
+  SUBCASE("Testing invalid recordings") {
+    recorder::Options options;
+    options.every = 0;
+    CHECK_THROWS_AS(recorder::Recorder(path, 50, 3, options), std::domain_error);
+    CHECK_THROWS_AS(recorder::Reader{path + ".missing"}, std::runtime_error);
+
+    {
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      file << "not a trajectory, but long enough to hold a header of eighty bytes......................";
+    }
+    CHECK_THROWS_AS(recorder::Reader{path}, std::runtime_error);
+  }
+
+  std::filesystem::remove(path);
+}
+
+//======================================================================================================================
+//===TESTING FUNCTIONS IN NAMESPACE OVERLAY=============================================================================
+//======================================================================================================================
+
+TEST_CASE("Testing functions in namespace overlay") {
+  SUBCASE("Testing overlay::formatStatistics()") {
+    const statistics::Statistics stats(312.4, 101.6, 9.876, 1.234);
+
+    CHECK(overlay::formatStatistics(stats) ==
+          "Mean distance: 312\nDistance standard deviation: 102\n\nMean speed: 9.88\nSpeed standard deviation: 1.23");
+
+    statistics::Statistics sampled(312.4, 101.6, 9.876, 1.234);
+    sampled.mean_dist_error = 0.84;
+    CHECK(overlay::formatStatistics(sampled) ==
+          "Mean distance: 312 +/- 0.8\nDistance standard deviation: 102\n\nMean speed: 9.88\nSpeed standard deviation: "
+          "1.23");
   }
 }
@@ -2,15 +2,24 @@
 
 #include <cassert>
 #include <cmath>
+#include <type_traits>
 
 #include "../include/flock.hpp"
 #include "../include/graphic.hpp"
+#include "../include/storage.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace triangles {
-void createTriangles(const flock::Flock& flock, sf::VertexArray& triangles) {
+template <typename T>
+void createTriangles(const flock::BasicFlock<T>& flock, sf::VertexArray& triangles) {
   for (size_t i = 0; i < flock.getBoidsNum(); ++i) {
     const size_t j = 3 * i;
-    sf::Vertex vertex{flock.getBoidFlock()[i]->getPosition()()};
+    sf::Vertex vertex{flock.getBoidArrays().position(i)()};
 
     // upper vertex (centered)
     triangles[j].position = vertex.position + sf::Vector2f(0, -height / 2);
@@ -27,7 +36,7 @@ void createTriangles(const flock::Flock& flock, sf::VertexArray& triangles) {
 
   if (flock.getPredatorsNum() > 0) {
     for (size_t i = 0; i < flock.getPredatorsNum(); ++i) {
-      sf::Vertex vertex{flock.getPredatorFlock()[i]->getPosition()()};
+      sf::Vertex vertex{flock.getPredatorArrays().position(i)()};
 
       const size_t j = 3 * (i + flock.getBoidsNum());
       // upper vertex (centered)
@@ -46,8 +55,9 @@ void createTriangles(const flock::Flock& flock, sf::VertexArray& triangles) {
   assert(triangles.getVertexCount() == flock.getFlockSize() * 3);
 }
 
-void rotateTriangle(const point::Point& target_position, sf::VertexArray& triangles, const double theta, const size_t i,
-                    const bool is_boid, const size_t nBoids) {
+template <typename T>
+void rotateTriangle(const point::BasicPoint<T>& target_position, sf::VertexArray& triangles, const double theta,
+                    const size_t i, const bool is_boid, const size_t nBoids) {
   const sf::Vertex vertex{target_position()};
 
   const size_t j = is_boid ? 3 * i : 3 * (i + nBoids);
@@ -61,4 +71,147 @@ void rotateTriangle(const point::Point& target_position, sf::VertexArray& triang
                                                           relative_position[index].y * std::cos(theta)));
   }
 }
+
+namespace {
+
+/// @brief Evaluates the vertices of the triangle of a bird, rotated by the angle of its velocity.
+/// @details The angle is theta = atan2(vy, vx) + pi / 2, so that sin(theta) = vx / |v| and cos(theta) = -vy / |v|;
+/// a bird at rest points upwards, as with theta = pi / 2.
+/// @param relative Points to the three relative positions of the vertices of the triangle.
+/// @param vertices Points to the three vertices of the triangle.
+void placeTriangle(const double x, const double y, const double vx, const double vy, const sf::Vector2f* relative,
+                   sf::Vertex* vertices) {
+  double sin_t{1.};
+  double cos_t{0.};
+  const double module2{vx * vx + vy * vy};
+  if (module2 != 0.) {
+    const double inverse{1. / std::sqrt(module2)};
+    sin_t = vx * inverse;
+    cos_t = -vy * inverse;
+  }
+
+  const sf::Vector2f position(static_cast<float>(x), static_cast<float>(y));
+  for (size_t k = 0; k < 3; ++k) {
+    vertices[k].position =
+        position + sf::Vector2f(static_cast<float>(relative[k].x * cos_t - relative[k].y * sin_t),
+                                static_cast<float>(relative[k].x * sin_t + relative[k].y * cos_t));
+  }
+}
+}  // namespace
+
+template <typename T>
+void rotateTriangles(const storage::BasicBirdArrays<T>& birds, const bool is_boid, const size_t nBoids,
+                     sf::VertexArray& triangles, const size_t begin, const size_t end) {
+  assert(end <= birds.size());
+  if (begin >= end) {
+    return;
+  }
+  assert(triangles.getVertexCount() >= 3 * ((is_boid ? 0 : nBoids) + end));
+
+  const sf::Vector2f* const relative{relative_position.data() + (is_boid ? 0 : 3)};
+  sf::Vertex* const vertices{&triangles[3 * (is_boid ? 0 : nBoids)]};
+  const T* const x{birds.x.data()};
+  const T* const y{birds.y.data()};
+  const T* const vx{birds.vx.data()};
+  const T* const vy{birds.vy.data()};
+
+  size_t i{begin};
+
+  // the vector paths load doubles; birds in single precision go through placeTriangle() only
+  if constexpr (std::is_same_v<T, double>) {
+#if defined(__AVX__)
+    // four birds at a time: the same operations as placeTriangle(), lane by lane, so the results are identical
+    constexpr size_t lanes{4};
+    alignas(16) float px[lanes];
+    alignas(16) float py[lanes];
+    for (; i + lanes <= end; i += lanes) {
+      const __m256d vx4{_mm256_loadu_pd(vx + i)};
+      const __m256d vy4{_mm256_loadu_pd(vy + i)};
+      const __m256d module2{_mm256_add_pd(_mm256_mul_pd(vx4, vx4), _mm256_mul_pd(vy4, vy4))};
+      if (_mm256_movemask_pd(_mm256_cmp_pd(module2, _mm256_setzero_pd(), _CMP_EQ_OQ)) != 0) {
+        for (size_t l = i; l < i + lanes; ++l) {
+          placeTriangle(x[l], y[l], vx[l], vy[l], relative, vertices + 3 * l);
+        }
+        continue;
+      }
+
+      const __m256d inverse{_mm256_div_pd(_mm256_set1_pd(1.), _mm256_sqrt_pd(module2))};
+      const __m256d sin_t{_mm256_mul_pd(vx4, inverse)};
+      const __m256d cos_t{_mm256_mul_pd(_mm256_xor_pd(vy4, _mm256_set1_pd(-0.)), inverse)};
+      const __m128 x4{_mm256_cvtpd_ps(_mm256_loadu_pd(x + i))};
+      const __m128 y4{_mm256_cvtpd_ps(_mm256_loadu_pd(y + i))};
+
+      for (size_t k = 0; k < 3; ++k) {
+        const __m256d rx{_mm256_set1_pd(relative[k].x)};
+        const __m256d ry{_mm256_set1_pd(relative[k].y)};
+        const __m256d ox{_mm256_sub_pd(_mm256_mul_pd(rx, cos_t), _mm256_mul_pd(ry, sin_t))};
+        const __m256d oy{_mm256_add_pd(_mm256_mul_pd(rx, sin_t), _mm256_mul_pd(ry, cos_t))};
+        _mm_store_ps(px, _mm_add_ps(x4, _mm256_cvtpd_ps(ox)));
+        _mm_store_ps(py, _mm_add_ps(y4, _mm256_cvtpd_ps(oy)));
+
+        for (size_t l = 0; l < lanes; ++l) {
+          vertices[3 * (i + l) + k].position = sf::Vector2f(px[l], py[l]);
+        }
+      }
+    }
+#elif defined(__SSE2__)
+    // two birds at a time: the same operations as placeTriangle(), lane by lane, so the results are identical
+    constexpr size_t lanes{2};
+    alignas(16) float px[4];
+    alignas(16) float py[4];
+    for (; i + lanes <= end; i += lanes) {
+      const __m128d vx2{_mm_loadu_pd(vx + i)};
+      const __m128d vy2{_mm_loadu_pd(vy + i)};
+      const __m128d module2{_mm_add_pd(_mm_mul_pd(vx2, vx2), _mm_mul_pd(vy2, vy2))};
+      if (_mm_movemask_pd(_mm_cmpeq_pd(module2, _mm_setzero_pd())) != 0) {
+        for (size_t l = i; l < i + lanes; ++l) {
+          placeTriangle(x[l], y[l], vx[l], vy[l], relative, vertices + 3 * l);
+        }
+        continue;
+      }
+
+      const __m128d inverse{_mm_div_pd(_mm_set1_pd(1.), _mm_sqrt_pd(module2))};
+      const __m128d sin_t{_mm_mul_pd(vx2, inverse)};
+      const __m128d cos_t{_mm_mul_pd(_mm_xor_pd(vy2, _mm_set1_pd(-0.)), inverse)};
+      const __m128 x2{_mm_cvtpd_ps(_mm_loadu_pd(x + i))};
+      const __m128 y2{_mm_cvtpd_ps(_mm_loadu_pd(y + i))};
+
+      for (size_t k = 0; k < 3; ++k) {
+        const __m128d rx{_mm_set1_pd(relative[k].x)};
+        const __m128d ry{_mm_set1_pd(relative[k].y)};
+        const __m128d ox{_mm_sub_pd(_mm_mul_pd(rx, cos_t), _mm_mul_pd(ry, sin_t))};
+        const __m128d oy{_mm_add_pd(_mm_mul_pd(rx, sin_t), _mm_mul_pd(ry, cos_t))};
+        _mm_store_ps(px, _mm_add_ps(x2, _mm_cvtpd_ps(ox)));
+        _mm_store_ps(py, _mm_add_ps(y2, _mm_cvtpd_ps(oy)));
+
+        for (size_t l = 0; l < lanes; ++l) {
+          vertices[3 * (i + l) + k].position = sf::Vector2f(px[l], py[l]);
+        }
+      }
+    }
+#endif
+  }
+
+  for (; i < end; ++i) {
+    placeTriangle(x[i], y[i], vx[i], vy[i], relative, vertices + 3 * i);
+  }
+}
+
+template <typename T>
+void updateTriangles(const flock::BasicFlock<T>& flock, sf::VertexArray& triangles) {
+  assert(triangles.getVertexCount() == flock.getFlockSize() * 3);
+
+  rotateTriangles(flock.getBoidArrays(), true, flock.getBoidsNum(), triangles, 0, flock.getBoidsNum());
+  rotateTriangles(flock.getPredatorArrays(), false, flock.getBoidsNum(), triangles, 0, flock.getPredatorsNum());
+}
+
+template void createTriangles(const flock::BasicFlock<float>&, sf::VertexArray&);
+template void createTriangles(const flock::BasicFlock<double>&, sf::VertexArray&);
+template void rotateTriangle(const point::BasicPoint<float>&, sf::VertexArray&, double, size_t, bool, size_t);
+template void rotateTriangle(const point::BasicPoint<double>&, sf::VertexArray&, double, size_t, bool, size_t);
+template void rotateTriangles(const storage::BasicBirdArrays<float>&, bool, size_t, sf::VertexArray&, size_t, size_t);
+template void rotateTriangles(const storage::BasicBirdArrays<double>&, bool, size_t, sf::VertexArray&, size_t,
+                              size_t);
+template void updateTriangles(const flock::BasicFlock<float>&, sf::VertexArray&);
+template void updateTriangles(const flock::BasicFlock<double>&, sf::VertexArray&);
 }  // namespace triangles